@@ -41,6 +41,7 @@
 - (IBAction)showDebuggerWindow:(id)sender;
 - (IBAction)showBreakpointWindow:(id)sender;
 - (IBAction)showPreferences:(id)sender;
+- (IBAction)showMetricsWindow:(id)sender;
 
 - (IBAction)openHelpPage:(id)sender;
 
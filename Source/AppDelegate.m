@@ -19,12 +19,14 @@
 #import <Sparkle/Sparkle.h>
 
 #import "FileAccessController.h"
+#import "MetricsController.h"
 #import "PreferenceNames.h"
 
 static NSString* const kAppcastUnstable = @"appcast-unstable.xml";
 
 @implementation AppDelegate {
   PreferencesController* _prefsController;
+  MetricsController* _metricsController;
 }
 
 @synthesize debugger;
@@ -42,13 +44,13 @@ static NSString* const kAppcastUnstable = @"appcast-unstable.xml";
       kPrefPort                     : @9000,
       kPrefInspectorWindowVisible   : @YES,
       kPrefPathReplacements         : [NSMutableArray array],
-      kPrefPhpPath                  : @"/usr/bin/php",
 #if USE_APP_SANDBOX
       kPrefFileAccessBookmarks      : [NSMutableDictionary dictionary],
 #endif
       kPrefBreakOnFirstLine         : @YES,
       kPrefDebuggerAttached         : @YES,
       kPrefSelectedDebuggerSegment  : @1,
+      kPrefLogCaptureLevel          : @(kLogCaptureFull),
     };
     [[NSUserDefaults standardUserDefaults] registerDefaults:defaults];
   }
@@ -70,6 +72,11 @@ static NSString* const kAppcastUnstable = @"appcast-unstable.xml";
 {
   [[SUUpdater sharedUpdater] setDelegate:self];
 
+  self.debugger.connection.logger = loggingController_;
+  self.debugger.connection.recordingDirectory =
+      [[[NSUserDefaults standardUserDefaults] stringForKey:kPrefSessionRecordingDirectory]
+          stringByExpandingTildeInPath];
+
 #if USE_APP_SANDBOX
   [FileAccessController maybeShowFileAccessDialog];
 
@@ -109,6 +116,17 @@ static NSString* const kAppcastUnstable = @"appcast-unstable.xml";
   [self.prefsController showPreferencesWindow];
 }
 
+/**
+ * Shows the transaction timings window, which collects metrics while it is
+ * open. Lazily loads the MetricsController.
+ */
+- (IBAction)showMetricsWindow:(id)sender
+{
+  if (!_metricsController)
+    _metricsController = [[MetricsController alloc] initWithBackEnd:self.debugger.connection];
+  [_metricsController showWindow:sender];
+}
+
 /**
  * Opens the URL to the help page
  */
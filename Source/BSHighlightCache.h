@@ -0,0 +1,36 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Cocoa/Cocoa.h>
+
+// BSHighlightCache remembers the highlighted text of the most recently shown
+// files, so switching back to one does not highlight it again. Entries are
+// keyed by path and only match if the source has not changed.
+@interface BSHighlightCache : NSObject
+
+// The maximum number of files to remember.
+@property(readonly, nonatomic) NSUInteger capacity;
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+// Returns the highlighted text for |source| at |path|, or nil.
+- (NSAttributedString*)textForSource:(NSString*)source atPath:(NSString*)path;
+
+// Stores the highlighted |text| of |source| at |path|, evicting the least
+// recently used file if the cache is full.
+- (void)setText:(NSAttributedString*)text forSource:(NSString*)source atPath:(NSString*)path;
+
+@end
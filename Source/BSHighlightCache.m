@@ -0,0 +1,82 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "BSHighlightCache.h"
+
+@interface BSHighlightCacheEntry : NSObject
+@property(copy, nonatomic) NSString* path;
+// The highlighted source, whose string is the source it was made from.
+@property(copy, nonatomic) NSAttributedString* text;
+@end
+
+@implementation BSHighlightCacheEntry
+@end
+
+@implementation BSHighlightCache {
+  // The cached files, least recently used first.
+  NSMutableArray<BSHighlightCacheEntry*>* _entries;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+  if ((self = [super init])) {
+    _capacity = capacity;
+    _entries = [[NSMutableArray alloc] initWithCapacity:capacity];
+  }
+  return self;
+}
+
+- (NSAttributedString*)textForSource:(NSString*)source atPath:(NSString*)path {
+  NSUInteger index = [self indexOfPath:path];
+  if (index == NSNotFound)
+    return nil;
+
+  BSHighlightCacheEntry* entry = _entries[index];
+  if (![entry.text.string isEqualToString:source]) {
+    [_entries removeObjectAtIndex:index];
+    return nil;
+  }
+
+  [_entries removeObjectAtIndex:index];
+  [_entries addObject:entry];
+  return entry.text;
+}
+
+- (void)setText:(NSAttributedString*)text forSource:(NSString*)source atPath:(NSString*)path {
+  if (!path || !source)
+    return;
+
+  NSUInteger index = [self indexOfPath:path];
+  if (index != NSNotFound)
+    [_entries removeObjectAtIndex:index];
+
+  BSHighlightCacheEntry* entry = [[BSHighlightCacheEntry alloc] init];
+  entry.path = path;
+  entry.text = text;
+  [_entries addObject:entry];
+
+  while (_entries.count > _capacity)
+    [_entries removeObjectAtIndex:0];
+}
+
+// Private /////////////////////////////////////////////////////////////////////
+
+- (NSUInteger)indexOfPath:(NSString*)path {
+  return [_entries indexOfObjectPassingTest:^BOOL(BSHighlightCacheEntry* entry, NSUInteger i, BOOL* stop) {
+    return [entry.path isEqualToString:path];
+  }];
+}
+
+@end
@@ -0,0 +1,50 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Foundation/Foundation.h>
+
+// BSLineIndex maps line numbers to the character offsets at which they start,
+// so that lines can be located in constant time and characters can be mapped
+// to lines in logarithmic time. Line numbers are 1-based. If the string ends
+// with a line terminator, the empty line after it is counted.
+@interface BSLineIndex : NSObject
+
+// The number of lines in the string.
+@property(readonly, nonatomic) NSUInteger lineCount;
+
+// Builds the index for |string|.
+- (instancetype)initWithString:(NSString*)string;
+
+// Updates the index after the characters in |string| were edited, with the
+// same arguments that NSTextStorage reports for the edit. Only the lines that
+// touch the edit are rescanned.
+- (void)updateForEditedRange:(NSRange)editedRange
+              changeInLength:(NSInteger)delta
+                      string:(NSString*)string;
+
+// Returns the index of the first character of |line|, or NSNotFound if the
+// line is out of range.
+- (NSUInteger)characterIndexForLine:(NSUInteger)line;
+
+// Returns the range of |line|, including its terminator, or
+// {NSNotFound, 0} if the line is out of range.
+- (NSRange)rangeOfLine:(NSUInteger)line;
+
+// Returns the line that contains the character at |index|, or NSNotFound if
+// the string is empty. Indices past the end map to the last line.
+- (NSUInteger)lineForCharacterIndex:(NSUInteger)index;
+
+@end
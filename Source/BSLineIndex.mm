@@ -0,0 +1,198 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "BSLineIndex.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// The number of characters copied out of a string at a time, when its
+// characters are not directly accessible.
+const NSUInteger kScanBufferSize = 4096;
+
+// Eight UTF-16 code units, scanned at once.
+typedef uint16_t Unichar8 __attribute__((vector_size(16)));
+
+// Whether |c| ends a line, as -[NSString lineRangeForRange:] treats it.
+inline bool IsLineTerminator(unichar c) {
+  return c == '\n' || c == '\r' || c == 0x85 || c == 0x2028 || c == 0x2029;
+}
+
+// Appends to |starts| the index of each line that begins after a terminator in
+// |characters|, which holds |count| characters starting at |offset| in the
+// string. |following| is the character after them, or 0. Lines that begin past
+// |limit| are not appended.
+void AppendLineStarts(const unichar* characters,
+                      NSUInteger count,
+                      NSUInteger offset,
+                      unichar following,
+                      NSUInteger limit,
+                      std::vector<NSUInteger>* starts) {
+  NSUInteger i = 0;
+  while (i < count) {
+    // Skip eight characters at a time while none of them can end a line.
+    if (i + 8 <= count) {
+      Unichar8 v;
+      memcpy(&v, characters + i, sizeof(v));
+      auto match = (v == '\n') | (v == '\r') | (v == 0x85) | ((v & 0xFFFE) == 0x2028);
+      uint64_t halves[2];
+      memcpy(halves, &match, sizeof(halves));
+      if ((halves[0] | halves[1]) == 0) {
+        i += 8;
+        continue;
+      }
+    }
+
+    unichar c = characters[i++];
+    if (!IsLineTerminator(c))
+      continue;
+    if (c == '\r') {
+      unichar next = i < count ? characters[i] : following;
+      if (next == '\n')
+        ++i;
+    }
+    if (offset + i > limit)
+      return;
+    starts->push_back(offset + i);
+  }
+}
+
+// Appends to |starts| the index of each line that begins after a terminator in
+// |range| of |string|, up to |limit|.
+void ScanLineStarts(NSString* string,
+                    NSRange range,
+                    NSUInteger limit,
+                    std::vector<NSUInteger>* starts) {
+  const NSUInteger length = [string length];
+  const NSUInteger end = NSMaxRange(range);
+  unichar following = end < length ? [string characterAtIndex:end] : 0;
+
+  const unichar* characters = CFStringGetCharactersPtr((__bridge CFStringRef)string);
+  if (characters) {
+    AppendLineStarts(characters + range.location, range.length, range.location, following,
+                     limit, starts);
+    return;
+  }
+
+  unichar buffer[kScanBufferSize];
+  NSUInteger location = range.location;
+  while (location < end) {
+    NSUInteger count = std::min(kScanBufferSize, end - location);
+    [string getCharacters:buffer range:NSMakeRange(location, count)];
+    // Leave a trailing CR for the next buffer, so a CRLF is not split.
+    if (location + count < end && count > 1 && buffer[count - 1] == '\r')
+      --count;
+    unichar next = following;
+    if (location + count < end)
+      next = count < kScanBufferSize ? buffer[count] : 0;
+    AppendLineStarts(buffer, count, location, next, limit, starts);
+    location += count;
+  }
+}
+
+}  // namespace
+
+@implementation BSLineIndex {
+  // A vector (thus 0-based) map of line numbers (indices) to character indices
+  // in the string.
+  std::vector<NSUInteger> _lineStarts;
+
+  // The length of the string.
+  NSUInteger _length;
+}
+
+- (instancetype)initWithString:(NSString*)string
+{
+  if ((self = [super init])) {
+    _length = [string length];
+    if (_length) {
+      _lineStarts.push_back(0);
+      ScanLineStarts(string, NSMakeRange(0, _length), _length, &_lineStarts);
+    }
+  }
+  return self;
+}
+
+- (void)updateForEditedRange:(NSRange)editedRange
+              changeInLength:(NSInteger)delta
+                      string:(NSString*)string
+{
+  _length = [string length];
+  if (_length == 0) {
+    _lineStarts.clear();
+    return;
+  }
+
+  const NSUInteger editStart = editedRange.location;
+  const NSUInteger newEnd = NSMaxRange(editedRange);
+  const NSUInteger oldEnd = newEnd - delta;
+
+  // Rescan from the start of the line before the edit, since the edit can
+  // complete or split a CRLF that ends it.
+  const NSUInteger before = editStart == 0 ? 0 : editStart - 1;
+  auto first = std::upper_bound(_lineStarts.begin(), _lineStarts.end(), before);
+  const NSUInteger scanStart = first == _lineStarts.begin() ? 0 : *(first - 1);
+
+  // Lines that began within the edit are rescanned, and those after it move.
+  auto last = std::upper_bound(first, _lineStarts.end(), oldEnd);
+  for (auto it = last; it != _lineStarts.end(); ++it)
+    *it += delta;
+
+  std::vector<NSUInteger> starts;
+  if (_lineStarts.empty())
+    starts.push_back(0);
+  ScanLineStarts(string, NSMakeRange(scanStart, newEnd - scanStart), newEnd, &starts);
+
+  first = _lineStarts.erase(first, last);
+  _lineStarts.insert(first, starts.begin(), starts.end());
+}
+
+- (NSUInteger)lineCount
+{
+  return _lineStarts.size();
+}
+
+- (NSUInteger)characterIndexForLine:(NSUInteger)line
+{
+  if (line == 0 || line > _lineStarts.size())
+    return NSNotFound;
+  return _lineStarts[line - 1];
+}
+
+- (NSRange)rangeOfLine:(NSUInteger)line
+{
+  if (line == 0 || line > _lineStarts.size())
+    return NSMakeRange(NSNotFound, 0);
+  NSUInteger start = _lineStarts[line - 1];
+  NSUInteger end = line < _lineStarts.size() ? _lineStarts[line] : _length;
+  return NSMakeRange(start, end - start);
+}
+
+- (NSUInteger)lineForCharacterIndex:(NSUInteger)index
+{
+  if (_lineStarts.empty())
+    return NSNotFound;
+  // Find the first line that starts after |index|; the one before it contains
+  // the character.
+  auto next = std::upper_bound(_lineStarts.begin(), _lineStarts.end(), index);
+  return std::distance(_lineStarts.begin(), next);
+}
+
+@end
@@ -0,0 +1,44 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Cocoa/Cocoa.h>
+
+// BSLineNumberAtlas renders the digits 0-9 once, for a given font and backing
+// scale, into a single image. Line numbers are then drawn by copying digits
+// out of that image, rather than laying out a string for each number.
+@interface BSLineNumberAtlas : NSObject
+
+// The attributes with which the digits are rendered.
+@property(readonly, nonatomic) NSDictionary<NSString*, id>* attributes;
+
+// The backing scale factor of the rendered digits.
+@property(readonly, nonatomic) CGFloat scale;
+
+// The size of a single digit cell, in points.
+@property(readonly, nonatomic) NSSize digitSize;
+
+// Renders the digits with |attributes| at |scale|.
+- (instancetype)initWithAttributes:(NSDictionary<NSString*, id>*)attributes
+                             scale:(CGFloat)scale;
+
+// Returns the size that |number| occupies when drawn.
+- (NSSize)sizeOfNumber:(NSUInteger)number;
+
+// Draws |number| into the current graphics context, right-aligned and
+// vertically centered in |rect|.
+- (void)drawNumber:(NSUInteger)number inRect:(NSRect)rect;
+
+@end
@@ -0,0 +1,112 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "BSLineNumberAtlas.h"
+
+// The number of digits in |number|.
+static NSUInteger CountDigits(NSUInteger number) {
+  NSUInteger count = 1;
+  while (number >= 10) {
+    number /= 10;
+    ++count;
+  }
+  return count;
+}
+
+@implementation BSLineNumberAtlas {
+  // The digits 0-9, left to right, each in a |digitSize| cell.
+  NSImage* _image;
+}
+
+- (instancetype)initWithAttributes:(NSDictionary<NSString*, id>*)attributes
+                             scale:(CGFloat)scale {
+  if ((self = [super init])) {
+    _attributes = [attributes copy];
+    _scale = scale;
+
+    NSSize digitSize = NSZeroSize;
+    for (unichar digit = '0'; digit <= '9'; ++digit) {
+      NSSize size = [[NSString stringWithCharacters:&digit length:1] sizeWithAttributes:_attributes];
+      digitSize.width = MAX(digitSize.width, size.width);
+      digitSize.height = MAX(digitSize.height, size.height);
+    }
+    _digitSize = NSMakeSize(ceil(digitSize.width), ceil(digitSize.height));
+
+    [self renderDigits];
+  }
+  return self;
+}
+
+- (NSSize)sizeOfNumber:(NSUInteger)number {
+  return NSMakeSize(_digitSize.width * CountDigits(number), _digitSize.height);
+}
+
+- (void)drawNumber:(NSUInteger)number inRect:(NSRect)rect {
+  NSRect destRect = NSMakeRect(NSMaxX(rect) - _digitSize.width,
+                               NSMinY(rect) + (NSHeight(rect) - _digitSize.height) / 2.0,
+                               _digitSize.width,
+                               _digitSize.height);
+  // Draw the digits from least to most significant, moving left.
+  do {
+    NSRect fromRect = NSMakeRect((number % 10) * _digitSize.width, 0,
+                                 _digitSize.width, _digitSize.height);
+    [_image drawInRect:destRect
+              fromRect:fromRect
+             operation:NSCompositingOperationSourceOver
+              fraction:1.0
+        respectFlipped:YES
+                 hints:nil];
+    destRect.origin.x -= _digitSize.width;
+    number /= 10;
+  } while (number > 0);
+}
+
+// Private /////////////////////////////////////////////////////////////////////
+
+/**
+ * Draws each digit, centered in its cell, into a bitmap at the backing scale.
+ */
+- (void)renderDigits {
+  NSSize imageSize = NSMakeSize(_digitSize.width * 10, _digitSize.height);
+  NSBitmapImageRep* bitmap =
+      [[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL
+                                              pixelsWide:ceil(imageSize.width * _scale)
+                                              pixelsHigh:ceil(imageSize.height * _scale)
+                                           bitsPerSample:8
+                                         samplesPerPixel:4
+                                                hasAlpha:YES
+                                                isPlanar:NO
+                                          colorSpaceName:NSCalibratedRGBColorSpace
+                                             bytesPerRow:0
+                                            bitsPerPixel:0];
+  [bitmap setSize:imageSize];
+
+  [NSGraphicsContext saveGraphicsState];
+  [NSGraphicsContext setCurrentContext:[NSGraphicsContext graphicsContextWithBitmapImageRep:bitmap]];
+  for (unichar digit = '0'; digit <= '9'; ++digit) {
+    NSString* string = [NSString stringWithCharacters:&digit length:1];
+    NSSize size = [string sizeWithAttributes:_attributes];
+    NSPoint point = NSMakePoint((digit - '0') * _digitSize.width + (_digitSize.width - size.width) / 2.0,
+                                0);
+    [string drawAtPoint:point withAttributes:_attributes];
+  }
+  [NSGraphicsContext restoreGraphicsState];
+
+  _image = [[NSImage alloc] initWithSize:imageSize];
+  [_image addRepresentation:bitmap];
+}
+
+@end
@@ -20,11 +20,16 @@
 #include <vector>
 
 #import "Breakpoint.h"
+#import "BSLineIndex.h"
+#import "BSLineNumberAtlas.h"
 #import "BSSourceView.h"
 
 @interface BSLineNumberRulerView (Private)
-- (void)computeLineIndex;
-- (NSAttributedString*)attributedStringForLineNumber:(NSUInteger)line;
+- (void)textViewFrameDidChange:(NSNotification*)notif;
+- (void)invalidateLineOffsets;
+- (void)extendLineOffsetsToOffset:(CGFloat)offset;
+- (NSUInteger)lineNumberAtOffset:(CGFloat)offset;
+- (BSLineNumberAtlas*)atlas;
 - (NSDictionary*)fontAttributes;
 - (void)drawBreakpointInRect:(NSRect)rect;
 - (void)drawProgramCounterInRect:(NSRect)rect;
@@ -46,9 +51,22 @@ const CGFloat kRulerRightPadding = 2.5;
 @implementation BSLineNumberRulerView {
   BSSourceView* _sourceView;  // Weak, owns this.
 
-  // A vector (thus 0-based) map of line numbers (indices) to character indices
-  // in the text storage.
-  std::vector<NSUInteger> _lineIndex;
+  // A vector (thus 0-based) map of line numbers (indices) to the top of the
+  // line in the text container. This is filled in lazily, only as far down as
+  // has been drawn or hit-tested, so that only that part of the text is laid
+  // out. Once complete, the last element is the bottom of the last line, so
+  // the height of a line is always the distance to the next element.
+  std::vector<CGFloat> _lineOffsets;
+
+  // The glyph at which to continue filling in |_lineOffsets|, the bottom of
+  // the line fragments walked so far, and whether it covers every line.
+  NSUInteger _nextLineOffsetGlyph;
+  CGFloat _lineOffsetsBottom;
+  BOOL _lineOffsetsComplete;
+
+  // The pre-rendered digits used to draw line numbers, created lazily for the
+  // current backing scale.
+  BSLineNumberAtlas* _atlas;
 }
 
 - (instancetype)initWithSourceView:(BSSourceView*)sourceView
@@ -58,10 +76,20 @@ const CGFloat kRulerRightPadding = 2.5;
     _sourceView = sourceView;
     [self setClientView:[[_sourceView scrollView] documentView]];
     [self setRuleThickness:kDefaultWidth];
+
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(textViewFrameDidChange:)
+                                                 name:NSViewFrameDidChangeNotification
+                                               object:[_sourceView textView]];
   }
   return self;
 }
 
+- (void)dealloc
+{
+  [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
 - (void)awakeFromNib
 {
   [self setClientView:[[_sourceView scrollView] documentView]];
@@ -79,81 +107,66 @@ const CGFloat kRulerRightPadding = 2.5;
   [NSBezierPath strokeLineFromPoint:NSMakePoint(NSMaxX(rect), NSMinY(rect))
                             toPoint:NSMakePoint(NSMaxX(rect), NSMaxY(rect))];
 
-  // Get some common elements of the source view.
   NSTextView* textView = [_sourceView textView];
-  NSLayoutManager* layoutManager = [textView layoutManager];
-  NSTextContainer* textContainer = [textView textContainer];
   NSRect visibleRect = [[[self scrollView] contentView] bounds];
+  const CGFloat yOffset = [textView textContainerInset].height;
 
-  // Get the visible glyph range, as NSRulerView only draws in the visible rect.
-  NSRange visibleGlyphRange = [layoutManager glyphRangeForBoundingRect:visibleRect
-                                                       inTextContainer:textContainer];
-  NSRange characterRange = [layoutManager characterRangeForGlyphRange:visibleGlyphRange
-                                                     actualGlyphRange:NULL];
+  [self extendLineOffsetsToOffset:NSMaxY(visibleRect) - yOffset];
 
   // Load any markers. The superview takes care of filtering out for just the
   // curently displayed file.
   NSSet<NSNumber*>* markers = [_sourceView markers];
 
-  // Go through the lines.
-  const NSRange kNullRange = NSMakeRange(NSNotFound, 0);
-  const CGFloat yOffset = [textView textContainerInset].height;
+  BSLineNumberAtlas* atlas = [self atlas];
+  const CGFloat digitHeight = [atlas digitSize].height;
+
+  // Go through the visible lines, starting with the one at the top of the
+  // visible rect. Every line whose height is known has a following element.
+  const NSUInteger lineCount = _lineOffsets.size() - 1;
+  const CGFloat visibleTop = NSMinY(visibleRect) - yOffset;
+  NSUInteger firstLine = 1;
+  if (visibleTop > _lineOffsets.front()) {
+    firstLine = [self lineNumberAtOffset:visibleTop];
+    if (firstLine == NSNotFound)
+      return;
+  }
 
-  const size_t lineCount = _lineIndex.size();
-  std::vector<NSUInteger>::iterator element =
-      std::lower_bound(_lineIndex.begin(),
-                       _lineIndex.end(),
-                       characterRange.location);
-  for (NSUInteger line = std::distance(_lineIndex.begin(), element);
-       line < lineCount; ++line) {
-    NSUInteger firstCharacterIndex = _lineIndex[line];
+  for (NSUInteger lineNumber = firstLine; lineNumber <= lineCount; ++lineNumber) {
+    const CGFloat top = _lineOffsets[lineNumber - 1];
+    const CGFloat height = _lineOffsets[lineNumber] - top;
     // Stop after iterating past the end of the visible range.
-    if (firstCharacterIndex > NSMaxRange(characterRange))
+    if (yOffset + top > NSMaxY(visibleRect))
       break;
 
-    NSUInteger rectCount;
-    NSRectArray frameRects = [layoutManager rectArrayForCharacterRange:NSMakeRange(firstCharacterIndex, 0)
-                                          withinSelectedCharacterRange:kNullRange
-                                                       inTextContainer:textContainer
-                                                             rectCount:&rectCount];
-    if (frameRects) {
-      NSUInteger lineNumber = line + 1;
-      NSAttributedString* lineNumberString =
-          [self attributedStringForLineNumber:lineNumber];
-      NSSize stringSize = [lineNumberString size];
-
-      CGFloat yCoord = yOffset + NSMinY(frameRects[0]) - NSMinY(visibleRect);
-      NSRect drawRect = NSMakeRect(NSWidth(rect) - stringSize.width - kRulerRightPadding,
-                                   yCoord + (NSHeight(frameRects[0]) - stringSize.height) / 2.0,
-                                   NSWidth(rect) - kRulerRightPadding,
-                                   NSHeight(frameRects[0]));
-      [lineNumberString drawInRect:drawRect];
-
-      // Draw any markers. Adjust the drawRect to be the entire width of the
-      // ruler, rather than just the width of the string.
-      drawRect.origin.x = NSMinX(rect);
-
-      if ([markers containsObject:@(lineNumber)]) {
-        [self drawBreakpointInRect:drawRect];
-      }
-      if (_sourceView.markedLine == lineNumber) {
-        [self drawProgramCounterInRect:drawRect];
-      }
+    CGFloat yCoord = yOffset + top - NSMinY(visibleRect);
+    [atlas drawNumber:lineNumber
+               inRect:NSMakeRect(0, yCoord, NSWidth(rect) - kRulerRightPadding, height)];
+
+    // Draw any markers across the entire width of the ruler.
+    NSRect drawRect = NSMakeRect(NSMinX(rect),
+                                 yCoord + (height - digitHeight) / 2.0,
+                                 NSWidth(rect) - kRulerRightPadding,
+                                 height);
+
+    if ([markers containsObject:@(lineNumber)]) {
+      [self drawBreakpointInRect:drawRect];
+    }
+    if (_sourceView.markedLine == lineNumber) {
+      [self drawProgramCounterInRect:drawRect];
     }
   }
 }
 
 - (void)performLayout
 {
-  [self computeLineIndex];
+  [self invalidateLineOffsets];
 
   // Determine the width of the ruler based on the line count.
-  if (_lineIndex.empty()) {
+  NSUInteger lineCount = [[_sourceView lineIndex] lineCount];
+  if (lineCount == 0) {
     [self setRuleThickness:kDefaultWidth];
   } else {
-    NSUInteger lastElement = _lineIndex.back() + 1;
-    NSAttributedString* lastElementString = [self attributedStringForLineNumber:lastElement];
-    NSSize boundingSize = [lastElementString size];
+    NSSize boundingSize = [[self atlas] sizeOfNumber:lineCount];
     [self setRuleThickness:std::max(kDefaultWidth, boundingSize.width)];
   }
 
@@ -162,33 +175,20 @@ const CGFloat kRulerRightPadding = 2.5;
 
 - (NSUInteger)lineNumberAtPoint:(NSPoint)point
 {
-  // Get some common elements of the source view.
   NSTextView* textView = [_sourceView textView];
-  NSLayoutManager* layoutManager = [textView layoutManager];
-  NSTextContainer* textContainer = [textView textContainer];
   NSRect visibleRect = [[[self scrollView] contentView] bounds];
   point.y += NSMinY(visibleRect);  // Adjust for scroll offset.
+  point.y -= [textView textContainerInset].height;
 
-  const CGFloat kWidth = NSWidth([self bounds]);
-  const NSRange kNullRange = NSMakeRange(NSNotFound, 0);
-  const size_t lineCount = _lineIndex.size();
-  for (NSUInteger line = 0; line < lineCount; ++line) {
-    NSUInteger firstCharacterIndex = _lineIndex[line];
-
-    NSUInteger rectCount;
-    NSRectArray frameRects =
-        [layoutManager rectArrayForCharacterRange:NSMakeRange(firstCharacterIndex, 0)
-                     withinSelectedCharacterRange:kNullRange
-                                  inTextContainer:textContainer
-                                        rectCount:&rectCount];
-    for (NSUInteger i = 0; i < rectCount; ++i) {
-      frameRects[i].size.width = kWidth;
-      if (NSPointInRect(point, frameRects[i])) {
-        return line + 1;
-      }
-    }
-  }
-  return NSNotFound;
+  [self extendLineOffsetsToOffset:point.y];
+  return [self lineNumberAtOffset:point.y];
+}
+
+- (void)viewDidChangeBackingProperties
+{
+  [super viewDidChangeBackingProperties];
+  _atlas = nil;
+  [self setNeedsDisplay:YES];
 }
 
 - (void)mouseDown:(NSEvent*)theEvent
@@ -203,43 +203,98 @@ const CGFloat kRulerRightPadding = 2.5;
 // Private /////////////////////////////////////////////////////////////////////
 
 /**
- * Iterates over the text storage system and computes a map of line numbers to
- * first character index for a line's frame rectangle.
+ * The line offsets change whenever the text view is resized by layout.
+ * Highlighting only changes colors, which does not move any lines.
+ */
+- (void)textViewFrameDidChange:(NSNotification*)notif
+{
+  [self invalidateLineOffsets];
+}
+
+/**
+ * Discards the line offsets, which are filled in again as they are needed.
  */
-- (void)computeLineIndex
+- (void)invalidateLineOffsets
 {
-  _lineIndex.clear();
+  _lineOffsets.clear();
+  _nextLineOffsetGlyph = 0;
+  _lineOffsetsBottom = 0;
+  _lineOffsetsComplete = NO;
+}
+
+/**
+ * Continues walking the line fragments of the text view, recording the top of
+ * each line, until the top of a line below |offset| is known or every line has
+ * been recorded. Only the text down to |offset| is laid out, so that a large
+ * file does not need a full layout to draw its first screen.
+ */
+- (void)extendLineOffsetsToOffset:(CGFloat)offset
+{
+  if (_lineOffsetsComplete || (!_lineOffsets.empty() && _lineOffsets.back() > offset))
+    return;
 
-  NSString* text = [[_sourceView textView] string];
-  NSUInteger stringLength = [text length];
-  NSUInteger index = 0;
+  BSLineIndex* lineIndex = [_sourceView lineIndex];
+  NSLayoutManager* layoutManager = [[_sourceView textView] layoutManager];
+  const NSUInteger lineCount = [lineIndex lineCount];
+  if (_lineOffsets.empty())
+    _lineOffsets.reserve(lineCount + 1);
+
+  const NSUInteger glyphCount = [layoutManager numberOfGlyphs];
+  while (_nextLineOffsetGlyph < glyphCount) {
+    NSRange fragmentRange;
+    NSRect fragmentRect = [layoutManager lineFragmentRectForGlyphAtIndex:_nextLineOffsetGlyph
+                                                          effectiveRange:&fragmentRange];
+    // Only the first fragment of a line starts a new line.
+    NSUInteger characterIndex = [layoutManager characterIndexForGlyphAtIndex:_nextLineOffsetGlyph];
+    if (_lineOffsets.size() < lineCount &&
+        [lineIndex characterIndexForLine:_lineOffsets.size() + 1] <= characterIndex) {
+      _lineOffsets.push_back(NSMinY(fragmentRect));
+    }
+    _lineOffsetsBottom = NSMaxY(fragmentRect);
+    _nextLineOffsetGlyph = NSMaxRange(fragmentRange);
 
-  while (index < stringLength) {
-    _lineIndex.push_back(index);
-    index = NSMaxRange([text lineRangeForRange:NSMakeRange(index, 0)]);
+    // The line at |offset| is complete once the next line has started.
+    if (!_lineOffsets.empty() && _lineOffsets.back() > offset)
+      return;
   }
 
-  if (_lineIndex.empty())
-    return;
+  // The empty line after a trailing line terminator has no glyphs.
+  NSRect extraRect = [layoutManager extraLineFragmentRect];
+  if (_lineOffsets.size() < lineCount && !NSIsEmptyRect(extraRect)) {
+    _lineOffsets.push_back(NSMinY(extraRect));
+    _lineOffsetsBottom = NSMaxY(extraRect);
+  }
 
-  NSUInteger lineEnd, contentEnd;
-  [text getLineStart:NULL
-                 end:&lineEnd
-         contentsEnd:&contentEnd
-            forRange:NSMakeRange(_lineIndex.back(), 0)];
-  if (contentEnd < lineEnd)
-    _lineIndex.push_back(index);
+  // If layout does not match the index, give the remaining lines no height.
+  _lineOffsets.resize(lineCount, _lineOffsetsBottom);
+  _lineOffsets.push_back(_lineOffsetsBottom);
+  _lineOffsetsComplete = YES;
 }
 
 /**
- * Takes in a line number and returns a formatted attributed string, usable
- * for drawing.
+ * Returns the line number (1-based) at |offset| in the text container, or
+ * NSNotFound if there is no line there.
  */
-- (NSAttributedString*)attributedStringForLineNumber:(unsigned long)line
+- (NSUInteger)lineNumberAtOffset:(CGFloat)offset
 {
-  NSString* format = [NSString stringWithFormat:@"%lu", line];
-  return [[NSAttributedString alloc] initWithString:format
-                                         attributes:[self fontAttributes]];
+  if (_lineOffsets.size() < 2 || offset < _lineOffsets.front() || offset >= _lineOffsets.back())
+    return NSNotFound;
+  // The first line whose top is below |offset| follows the line at |offset|.
+  auto next = std::upper_bound(_lineOffsets.begin(), _lineOffsets.end(), offset);
+  return std::distance(_lineOffsets.begin(), next);
+}
+
+/**
+ * Returns the digit atlas for the current backing scale, rendering it if the
+ * scale has changed.
+ */
+- (BSLineNumberAtlas*)atlas
+{
+  CGFloat scale = [self window] ? [[self window] backingScaleFactor]
+                                : [[NSScreen mainScreen] backingScaleFactor];
+  if (!_atlas || [_atlas scale] != scale)
+    _atlas = [[BSLineNumberAtlas alloc] initWithAttributes:[self fontAttributes] scale:scale];
+  return _atlas;
 }
 
 /**
@@ -248,11 +303,15 @@ const CGFloat kRulerRightPadding = 2.5;
  */
 - (NSDictionary*)fontAttributes
 {
-  NSFont* font = [NSFont fontWithDescriptor:[[BSSourceView sourceFont] fontDescriptor] size:11.0];
-  return @{
-    NSFontAttributeName            : font,
-    NSForegroundColorAttributeName : [NSColor grayColor],
-  };
+  static NSDictionary* attributes = nil;
+  if (!attributes) {
+    NSFont* font = [NSFont fontWithDescriptor:[[BSSourceView sourceFont] fontDescriptor] size:11.0];
+    attributes = @{
+      NSFontAttributeName            : font,
+      NSForegroundColorAttributeName : [NSColor grayColor],
+    };
+  }
+  return attributes;
 }
 
 /**
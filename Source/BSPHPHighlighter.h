@@ -0,0 +1,63 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Cocoa/Cocoa.h>
+
+// The classes of PHP tokens, which correspond to the highlight.* settings of
+// the PHP CLI's --syntax-highlight mode.
+typedef NS_ENUM(uint8_t, BSPHPTokenType) {
+  kBSPHPTokenHTML = 0,  // Inline HTML outside of the PHP tags.
+  kBSPHPTokenDefault,   // Tags, identifiers, variables and numbers.
+  kBSPHPTokenKeyword,   // Keywords, operators and punctuation.
+  kBSPHPTokenString,
+  kBSPHPTokenComment,
+};
+
+// A range of characters that are all highlighted the same way.
+typedef struct {
+  NSRange range;
+  BSPHPTokenType type;
+} BSPHPHighlightRun;
+
+// BSPHPHighlighter tokenizes PHP source in a single pass and produces the runs
+// of characters to highlight. The runs cover the entire source, in order. It
+// is safe to create a highlighter on any thread.
+@interface BSPHPHighlighter : NSObject
+
+// The source that was tokenized.
+@property(readonly, nonatomic) NSString* source;
+
+// The number of highlight runs.
+@property(readonly, nonatomic) NSUInteger runCount;
+
+// Tokenizes |source|.
+- (instancetype)initWithSource:(NSString*)source;
+
+// Returns the run at |index|.
+- (BSPHPHighlightRun)runAtIndex:(NSUInteger)index;
+
+// Returns the index of the run that contains the character at |location|, or
+// |runCount| if the location is past the end of the source.
+- (NSUInteger)indexOfRunContainingLocation:(NSUInteger)location;
+
+// Colors the characters of the runs with indices in |runs| in |textStorage|,
+// which must contain |source|. Other attributes are not modified.
+- (void)applyRuns:(NSRange)runs toTextStorage:(NSTextStorage*)textStorage;
+
+// Returns the color for the given |type| of token.
++ (NSColor*)colorForTokenType:(BSPHPTokenType)type;
+
+@end
@@ -0,0 +1,365 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "BSPHPHighlighter.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// The reserved words of PHP, sorted for bsearch().
+static const char* const kKeywords[] = {
+  "abstract", "and", "array", "as", "break", "callable", "case", "catch", "class", "clone",
+  "const", "continue", "declare", "default", "die", "do", "echo", "else", "elseif", "empty",
+  "enddeclare", "endfor", "endforeach", "endif", "endswitch", "endwhile", "enum", "eval", "exit",
+  "extends", "final", "finally", "fn", "for", "foreach", "function", "global", "goto", "if",
+  "implements", "include", "include_once", "instanceof", "insteadof", "interface", "isset", "list",
+  "match", "namespace", "new", "or", "print", "private", "protected", "public", "readonly",
+  "require", "require_once", "return", "static", "switch", "throw", "trait", "try", "unset", "use",
+  "var", "while", "xor", "yield"
+};
+
+// The length of the longest keyword.
+static const NSUInteger kMaxKeywordLength = 12;
+
+// The state of a tokenization pass over the source.
+typedef struct {
+  const unichar* chars;
+  NSUInteger length;
+  NSUInteger pos;
+
+  BSPHPHighlightRun* runs;
+  NSUInteger runCount;
+  NSUInteger runCapacity;
+} Tokenizer;
+
+static int CompareKeyword(const void* key, const void* element) {
+  return strcmp((const char*)key, *(const char* const*)element);
+}
+
+static BOOL IsIdentifierStart(unichar c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c >= 0x80;
+}
+
+static BOOL IsDigit(unichar c) {
+  return c >= '0' && c <= '9';
+}
+
+static BOOL IsIdentifierCharacter(unichar c) {
+  return IsIdentifierStart(c) || IsDigit(c);
+}
+
+static BOOL IsWhitespace(unichar c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Returns the character at |pos|, or 0 if it is past the end.
+static unichar CharacterAt(const Tokenizer* t, NSUInteger pos) {
+  return pos < t->length ? t->chars[pos] : 0;
+}
+
+// Whether the characters at |pos| match the lowercase ASCII |string|, ignoring
+// case.
+static BOOL MatchesIgnoringCase(const Tokenizer* t, NSUInteger pos, const char* string) {
+  for (; *string; ++string, ++pos) {
+    unichar c = CharacterAt(t, pos);
+    if (c >= 'A' && c <= 'Z')
+      c += 'a' - 'A';
+    if (c != (unichar)*string)
+      return NO;
+  }
+  return YES;
+}
+
+static BOOL IsKeyword(const Tokenizer* t, NSUInteger start, NSUInteger end) {
+  if (end - start > kMaxKeywordLength)
+    return NO;
+
+  char word[kMaxKeywordLength + 1];
+  for (NSUInteger i = start; i < end; ++i) {
+    unichar c = t->chars[i];
+    if (c >= 0x80)
+      return NO;
+    word[i - start] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+  }
+  word[end - start] = '\0';
+
+  return bsearch(word, kKeywords, sizeof(kKeywords) / sizeof(kKeywords[0]), sizeof(kKeywords[0]),
+                 &CompareKeyword) != NULL;
+}
+
+// Adds the characters in [start, end) to the runs, extending the last run if
+// it has the same |type|.
+static void Emit(Tokenizer* t, NSUInteger start, NSUInteger end, BSPHPTokenType type) {
+  if (end <= start)
+    return;
+
+  if (t->runCount) {
+    BSPHPHighlightRun* last = &t->runs[t->runCount - 1];
+    if (last->type == type && NSMaxRange(last->range) == start) {
+      last->range.length += end - start;
+      return;
+    }
+  }
+
+  if (t->runCount == t->runCapacity) {
+    t->runCapacity = MAX(64, t->runCapacity * 2);
+    t->runs = realloc(t->runs, t->runCapacity * sizeof(BSPHPHighlightRun));
+  }
+  t->runs[t->runCount++] = (BSPHPHighlightRun){ NSMakeRange(start, end - start), type };
+}
+
+// Whitespace is not colored, so it joins whichever run precedes it.
+static void EmitWhitespace(Tokenizer* t, NSUInteger start, NSUInteger end) {
+  BSPHPTokenType type = t->runCount ? t->runs[t->runCount - 1].type : kBSPHPTokenDefault;
+  Emit(t, start, end, type);
+}
+
+// Scans a "..." or `...` string, in which variables are interpolated.
+static void ScanInterpolatedString(Tokenizer* t, unichar quote) {
+  NSUInteger segment = t->pos++;
+  while (t->pos < t->length) {
+    unichar c = t->chars[t->pos];
+    if (c == '\\') {
+      t->pos = MIN(t->pos + 2, t->length);
+    } else if (c == quote) {
+      ++t->pos;
+      break;
+    } else if (c == '$' && IsIdentifierStart(CharacterAt(t, t->pos + 1))) {
+      Emit(t, segment, t->pos, kBSPHPTokenString);
+      NSUInteger variable = t->pos++;
+      while (IsIdentifierCharacter(CharacterAt(t, t->pos)))
+        ++t->pos;
+      Emit(t, variable, t->pos, kBSPHPTokenDefault);
+      segment = t->pos;
+    } else {
+      ++t->pos;
+    }
+  }
+  Emit(t, segment, t->pos, kBSPHPTokenString);
+}
+
+// Scans a <<<ID heredoc or <<<'ID' nowdoc. Returns NO if the "<<<" does not
+// start one.
+static BOOL ScanHeredoc(Tokenizer* t) {
+  NSUInteger start = t->pos;
+  NSUInteger pos = start + 3;
+  while (CharacterAt(t, pos) == ' ' || CharacterAt(t, pos) == '\t')
+    ++pos;
+
+  unichar quote = CharacterAt(t, pos);
+  if (quote == '\'' || quote == '"')
+    ++pos;
+  else
+    quote = 0;
+
+  NSUInteger identifier = pos;
+  if (!IsIdentifierStart(CharacterAt(t, pos)))
+    return NO;
+  while (IsIdentifierCharacter(CharacterAt(t, pos)))
+    ++pos;
+  NSUInteger identifierLength = pos - identifier;
+  if (quote && CharacterAt(t, pos++) != quote)
+    return NO;
+  if (CharacterAt(t, pos) != '\n' && CharacterAt(t, pos) != '\r')
+    return NO;
+
+  // The body ends at the first line that starts with the identifier, after
+  // optional indentation.
+  while (pos < t->length) {
+    while (pos < t->length && t->chars[pos] != '\n')
+      ++pos;
+    if (pos < t->length)
+      ++pos;
+    while (CharacterAt(t, pos) == ' ' || CharacterAt(t, pos) == '\t')
+      ++pos;
+    if (pos + identifierLength <= t->length &&
+        memcmp(t->chars + pos, t->chars + identifier, identifierLength * sizeof(unichar)) == 0 &&
+        !IsIdentifierCharacter(CharacterAt(t, pos + identifierLength))) {
+      pos += identifierLength;
+      break;
+    }
+  }
+
+  t->pos = MIN(pos, t->length);
+  Emit(t, start, t->pos, kBSPHPTokenString);
+  return YES;
+}
+
+// Scans one token of PHP code. Returns NO if the token is the closing tag.
+static BOOL ScanPHPToken(Tokenizer* t) {
+  NSUInteger start = t->pos;
+  unichar c = t->chars[start];
+  unichar next = CharacterAt(t, start + 1);
+
+  if (IsWhitespace(c)) {
+    while (t->pos < t->length && IsWhitespace(t->chars[t->pos]))
+      ++t->pos;
+    EmitWhitespace(t, start, t->pos);
+  } else if (c == '?' && next == '>') {
+    t->pos += 2;
+    Emit(t, start, t->pos, kBSPHPTokenDefault);
+    return NO;
+  } else if ((c == '#' && next != '[') || (c == '/' && next == '/')) {
+    // Line comments end at the newline or at a closing tag.
+    while (t->pos < t->length && t->chars[t->pos] != '\n' &&
+           !(t->chars[t->pos] == '?' && CharacterAt(t, t->pos + 1) == '>')) {
+      ++t->pos;
+    }
+    Emit(t, start, t->pos, kBSPHPTokenComment);
+  } else if (c == '/' && next == '*') {
+    t->pos += 2;
+    while (t->pos < t->length && !(t->chars[t->pos] == '*' && CharacterAt(t, t->pos + 1) == '/'))
+      ++t->pos;
+    t->pos = MIN(t->pos + 2, t->length);
+    Emit(t, start, t->pos, kBSPHPTokenComment);
+  } else if (c == '\'') {
+    ++t->pos;
+    while (t->pos < t->length) {
+      unichar s = t->chars[t->pos];
+      if (s == '\\') {
+        t->pos = MIN(t->pos + 2, t->length);
+      } else {
+        ++t->pos;
+        if (s == '\'')
+          break;
+      }
+    }
+    Emit(t, start, t->pos, kBSPHPTokenString);
+  } else if (c == '"' || c == '`') {
+    ScanInterpolatedString(t, c);
+  } else if (c == '<' && next == '<' && CharacterAt(t, start + 2) == '<' && ScanHeredoc(t)) {
+    // Scanned.
+  } else if (c == '$' && IsIdentifierStart(next)) {
+    ++t->pos;
+    while (IsIdentifierCharacter(CharacterAt(t, t->pos)))
+      ++t->pos;
+    Emit(t, start, t->pos, kBSPHPTokenDefault);
+  } else if (IsIdentifierStart(c) || (c == '\\' && IsIdentifierStart(next))) {
+    BOOL qualified = NO;
+    while (IsIdentifierCharacter(CharacterAt(t, t->pos)) || CharacterAt(t, t->pos) == '\\') {
+      qualified |= t->chars[t->pos] == '\\';
+      ++t->pos;
+    }
+    BOOL keyword = !qualified && IsKeyword(t, start, t->pos);
+    Emit(t, start, t->pos, keyword ? kBSPHPTokenKeyword : kBSPHPTokenDefault);
+  } else if (IsDigit(c)) {
+    while (IsIdentifierCharacter(CharacterAt(t, t->pos)) || CharacterAt(t, t->pos) == '.')
+      ++t->pos;
+    Emit(t, start, t->pos, kBSPHPTokenDefault);
+  } else {
+    ++t->pos;
+    Emit(t, start, t->pos, kBSPHPTokenKeyword);
+  }
+  return YES;
+}
+
+static void Tokenize(Tokenizer* t) {
+  while (t->pos < t->length) {
+    // Everything up to an opening tag is inline HTML.
+    NSUInteger start = t->pos;
+    while (t->pos < t->length && !(t->chars[t->pos] == '<' && CharacterAt(t, t->pos + 1) == '?'))
+      ++t->pos;
+    Emit(t, start, t->pos, kBSPHPTokenHTML);
+    if (t->pos >= t->length)
+      return;
+
+    start = t->pos;
+    t->pos += 2;
+    if (MatchesIgnoringCase(t, t->pos, "php"))
+      t->pos += 3;
+    else if (CharacterAt(t, t->pos) == '=')
+      ++t->pos;
+    Emit(t, start, t->pos, kBSPHPTokenDefault);
+
+    while (t->pos < t->length && ScanPHPToken(t)) {
+    }
+  }
+}
+
+@implementation BSPHPHighlighter {
+  BSPHPHighlightRun* _runs;
+}
+
+- (instancetype)initWithSource:(NSString*)source {
+  if ((self = [super init])) {
+    _source = [source copy];
+
+    Tokenizer t = {0};
+    t.length = _source.length;
+    unichar* buffer = NULL;
+    t.chars = CFStringGetCharactersPtr((__bridge CFStringRef)_source);
+    if (!t.chars) {
+      buffer = malloc(t.length * sizeof(unichar));
+      [_source getCharacters:buffer range:NSMakeRange(0, t.length)];
+      t.chars = buffer;
+    }
+
+    Tokenize(&t);
+    free(buffer);
+
+    _runs = t.runs;
+    _runCount = t.runCount;
+  }
+  return self;
+}
+
+- (void)dealloc {
+  free(_runs);
+}
+
+- (BSPHPHighlightRun)runAtIndex:(NSUInteger)index {
+  assert(index < _runCount);
+  return _runs[index];
+}
+
+- (NSUInteger)indexOfRunContainingLocation:(NSUInteger)location {
+  NSUInteger low = 0;
+  NSUInteger high = _runCount;
+  while (low < high) {
+    NSUInteger mid = low + (high - low) / 2;
+    if (NSMaxRange(_runs[mid].range) <= location)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low;
+}
+
+- (void)applyRuns:(NSRange)runs toTextStorage:(NSTextStorage*)textStorage {
+  NSUInteger end = MIN(NSMaxRange(runs), _runCount);
+  [textStorage beginEditing];
+  for (NSUInteger i = runs.location; i < end; ++i) {
+    [textStorage addAttribute:NSForegroundColorAttributeName
+                        value:[[self class] colorForTokenType:_runs[i].type]
+                        range:_runs[i].range];
+  }
+  [textStorage endEditing];
+}
+
++ (NSColor*)colorForTokenType:(BSPHPTokenType)type {
+  switch (type) {
+    case kBSPHPTokenHTML: return [NSColor systemGrayColor];
+    case kBSPHPTokenDefault: return [NSColor systemBlueColor];
+    // The color of PHP's own highlighter, which was never given a
+    // highlight.keyword.
+    case kBSPHPTokenKeyword: return [NSColor colorWithSRGBRed:0 green:0x77 / 255.0 blue:0 alpha:1];
+    case kBSPHPTokenString: return [NSColor systemRedColor];
+    case kBSPHPTokenComment: return [NSColor systemOrangeColor];
+  }
+  return [NSColor textColor];
+}
+
+@end
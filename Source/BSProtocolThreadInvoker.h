@@ -23,11 +23,21 @@
 // minimal work. The class also protects against the target |object| reentering
 // itself; if it or something it calls runs a nested run loop, the messages
 // will be queued until it would no longer reenter the object.
+//
+// Messages may be sent from any number of threads. They are queued without
+// locking, and the target thread is woken once for each group of messages
+// rather than once per message.
 @interface BSProtocolThreadInvoker : NSObject
 
 // The target object to which messages will be sent.
 @property(readonly, atomic) NSObject* object;
 
+// By default, one queued message is delivered per pass of the target thread's
+// run loop. If set, all queued messages are delivered in a single pass, which
+// is faster for bursts of messages but delays other run loop sources until
+// they have been handled. This must be set before any messages are sent.
+@property(assign, nonatomic) BOOL batchesMessages;
+
 - (id)initWithObject:(NSObject*)object
             protocol:(Protocol*)protocol
               thread:(NSThread*)thread;
@@ -37,4 +47,10 @@
               thread:(NSThread*)thread
                modes:(NSArray*)runLoopModes;
 
+// Queues |block| to be called with |object| on the target thread, in order
+// with and with the same reentrancy protection as messages of the protocol.
+// This avoids the NSInvocation that forwarding a message creates, so it should
+// be preferred for frequent messages.
+- (void)invokeBlock:(void (^)(id object))block;
+
 @end
@@ -16,6 +16,83 @@
 
 #import "BSProtocolThreadInvoker.h"
 
+#include <stdatomic.h>
+#include <stdlib.h>
+
+typedef void (^BSProtocolThreadInvokerBlock)(id object);
+
+// A node of the message queue, holding a retained BSProtocolThreadInvokerBlock.
+typedef struct BSMessageNode {
+  _Atomic(struct BSMessageNode*) next;
+  void* block;
+} BSMessageNode;
+
+// An intrusive multiple-producer, single-consumer queue. Producers exchange
+// themselves into |head| and then link the previous node to themselves; the
+// consumer follows the links from |tail|. |stub| keeps the list non-empty so
+// that neither side needs a lock.
+typedef struct {
+  _Atomic(BSMessageNode*) head;
+  BSMessageNode* tail;
+  BSMessageNode stub;
+} BSMessageQueue;
+
+static void MessageQueueInit(BSMessageQueue* queue)
+{
+  atomic_init(&queue->stub.next, NULL);
+  queue->stub.block = NULL;
+  atomic_init(&queue->head, &queue->stub);
+  queue->tail = &queue->stub;
+}
+
+// Appends |node|. Can be called on any thread.
+static void MessageQueuePush(BSMessageQueue* queue, BSMessageNode* node)
+{
+  atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+  BSMessageNode* previous = atomic_exchange_explicit(&queue->head, node, memory_order_acq_rel);
+  atomic_store_explicit(&previous->next, node, memory_order_release);
+}
+
+// Removes the oldest node, or returns NULL if the queue is empty or the oldest
+// node is still being linked by its producer. Only the consumer may call this.
+static BSMessageNode* MessageQueuePop(BSMessageQueue* queue)
+{
+  BSMessageNode* tail = queue->tail;
+  BSMessageNode* next = atomic_load_explicit(&tail->next, memory_order_acquire);
+  if (tail == &queue->stub) {
+    if (!next)
+      return NULL;
+    queue->tail = next;
+    tail = next;
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+  }
+  if (next) {
+    queue->tail = next;
+    return tail;
+  }
+
+  // |tail| is the last linked node. If a producer has already exchanged itself
+  // into |head|, wait for it to link |tail| to it.
+  if (tail != atomic_load_explicit(&queue->head, memory_order_acquire))
+    return NULL;
+
+  // Requeue the stub so that |tail| can be removed.
+  MessageQueuePush(queue, &queue->stub);
+  next = atomic_load_explicit(&tail->next, memory_order_acquire);
+  if (next) {
+    queue->tail = next;
+    return tail;
+  }
+  return NULL;
+}
+
+// Whether the queue may hold a node. Only the consumer may call this.
+static BOOL MessageQueueMayHaveNodes(BSMessageQueue* queue)
+{
+  return queue->tail != &queue->stub ||
+      atomic_load_explicit(&queue->stub.next, memory_order_acquire) != NULL;
+}
+
 @interface BSProtocolThreadInvoker (Private)
 // Installs a run loop observer on the target thread that is used to start
 // dispatching messages again after falling out of a nested run loop.
@@ -26,10 +103,13 @@
 // thread since CFRunLoop is threadsafe.
 - (void)removeRunLoopObserver;
 
-// Enqueues the |invocation| for execution, and dequeues the first if not called
-// reentrantly.
+// Schedules |-dispatchMessages| on the target thread.
+- (void)scheduleDispatch;
+
+// Delivers the first queued message, or all of them if |batchesMessages|, if
+// not called reentrantly.
 // *MUST* be called on the target thread.
-- (void)dispatchInvocation:(NSInvocation*)invocation;
+- (void)dispatchMessages;
 
 // Callback for the run loop whenever it begins a new pass. This will schedule
 // work if any was previously deferred due to reentrancy protection.
@@ -44,12 +124,17 @@
   CFRunLoopRef _runLoop;
   NSArray* _modes;
 
-  // If executing an invocation from |-dispatchInvocation:|. Protects against
+  // If executing a message from |-dispatchMessages|. Protects against
   // reentering the target.
   BOOL _isDispatching;
 
-  // The queue of work to be executed. Enqueues in  |-dispatchInvocation:|.
-  NSMutableArray* _invocations;
+  // The queue of work to be executed. Enqueued by |-invokeBlock:| on any
+  // thread, and dequeued by |-dispatchMessages| on the target thread.
+  BSMessageQueue _queue;
+
+  // Set when a |-dispatchMessages| has been scheduled that has not yet begun
+  // dequeuing, so that a burst of messages schedules it only once.
+  atomic_bool _dispatchScheduled;
 
   CFRunLoopObserverRef _observer;
 }
@@ -76,7 +161,8 @@
     _protocol = protocol;
     _thread = thread;
     _modes = [runLoopModes copy];
-    _invocations = [[NSMutableArray alloc] init];
+    MessageQueueInit(&_queue);
+    atomic_init(&_dispatchScheduled, false);
 
     [self performSelector:@selector(addRunLoopObserver)
                  onThread:_thread
@@ -90,6 +176,13 @@
 - (void)dealloc
 {
   [self removeRunLoopObserver];
+
+  // Release the blocks of any messages that were never delivered.
+  BSMessageNode* node;
+  while ((node = MessageQueuePop(&_queue))) {
+    CFRelease(node->block);
+    free(node);
+  }
 }
 
 - (BOOL)conformsToProtocol:(Protocol*)protocol
@@ -115,9 +208,24 @@
 {
   if ([_object respondsToSelector:[invocation selector]]) {
     [invocation retainArguments];
-    [self performSelector:@selector(dispatchInvocation:)
+    [self invokeBlock:^(id object) {
+        [invocation invokeWithTarget:object];
+    }];
+  }
+}
+
+- (void)invokeBlock:(void (^)(id object))block
+{
+  BSMessageNode* node = malloc(sizeof(BSMessageNode));
+  node->block = (__bridge_retained void*)[block copy];
+  MessageQueuePush(&_queue, node);
+
+  // Only the first message since the last dispatch began needs to wake the
+  // target thread.
+  if (!atomic_exchange(&_dispatchScheduled, true)) {
+    [self performSelector:@selector(dispatchMessages)
                  onThread:_thread
-               withObject:invocation
+               withObject:nil
             waitUntilDone:NO
                     modes:_modes];
   }
@@ -150,13 +258,18 @@
   CFRelease(_observer);
 }
 
-- (void)dispatchInvocation:(NSInvocation*)invocation
+- (void)scheduleDispatch
 {
-  // |invocation| will be nil if dispatch was requested after entering a new
-  // pass of the run loop, to process deferred work.
-  if (invocation)
-    [_invocations addObject:invocation];
+  atomic_store(&_dispatchScheduled, true);
+  [self performSelector:@selector(dispatchMessages)
+               onThread:_thread
+             withObject:nil
+          waitUntilDone:NO
+                  modes:_modes];
+}
 
+- (void)dispatchMessages
+{
   // Protect the target object from reentering itself. This work will be
   // rescheduled when another run loop starts (including falling out of a
   // nested loop and starting a new pass through a lower loop).
@@ -165,33 +278,44 @@
 
   _isDispatching = YES;
 
-  // Dequeue only one item. If multiple items are present, the next pass through
-  // the run loop will schedule another dispatch via |-observedRunLoopEnter|.
-  invocation = [_invocations objectAtIndex:0];
-  [invocation invokeWithTarget:_object];
-  [_invocations removeObjectAtIndex:0];
+  BOOL dispatched = NO;
+  do {
+    // Messages sent from here on schedule another dispatch, unless this one
+    // dequeues them first.
+    atomic_store(&_dispatchScheduled, false);
+
+    BSMessageNode* node = MessageQueuePop(&_queue);
+    if (!node)
+      break;
+    BSProtocolThreadInvokerBlock block = (__bridge_transfer BSProtocolThreadInvokerBlock)node->block;
+    free(node);
+
+    block(_object);
+    dispatched = YES;
+  } while (_batchesMessages);
 
   _isDispatching = NO;
+
+  // Unless batching, dequeue only one item. If more may be present, schedule
+  // another dispatch for the next pass through the run loop.
+  if (dispatched && !_batchesMessages && MessageQueueMayHaveNodes(&_queue))
+    [self scheduleDispatch];
 }
 
 - (void)observedRunLoopEnter
 {
   // Don't do anything if there's nothing to do.
-  if ([_invocations count] == 0)
+  if (!MessageQueueMayHaveNodes(&_queue))
     return;
 
   // If this nested run loop is still executing from within
-  // |-dispatchInvocation:|, continue to wait for a the nested loop to exit.
+  // |-dispatchMessages|, continue to wait for a the nested loop to exit.
   if (_isDispatching)
     return;
 
-  // A run loop has started running outside of |-dispatchInvocation:|, so
+  // A run loop has started running outside of |-dispatchMessages|, so
   // schedule work to be done again.
-  [self performSelector:@selector(dispatchInvocation:)
-               onThread:_thread
-             withObject:nil
-          waitUntilDone:NO
-                  modes:_modes];
+  [self scheduleDispatch];
 }
 
 @end
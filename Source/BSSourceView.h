@@ -16,7 +16,9 @@
 
 #import <Cocoa/Cocoa.h>
 
+@class BSLineIndex;
 @class BSLineNumberRulerView;
+@class LocalSourceFile;
 @protocol BSSourceViewDelegate;
 @class BSSourceViewTextView;
 
@@ -30,6 +32,8 @@
 
 @property (nonatomic, readonly) NSTextView* textView;
 @property (nonatomic, readonly) NSScrollView* scrollView;
+// The line index of the displayed source, shared with the ruler and text view.
+@property (nonatomic, readonly) BSLineIndex* lineIndex;
 @property (nonatomic, copy) NSSet<NSNumber*>* markers;
 @property (nonatomic, copy) NSString* file;
 @property (nonatomic, assign) NSUInteger markedLine;
@@ -37,6 +41,7 @@
 
 - (void)setFile:(NSString*)f;
 - (void)setString:(NSString*)source asFile:(NSString*)path;
+- (void)setLocalFile:(LocalSourceFile*)localFile asFile:(NSString*)path;
 - (void)scrollToLine:(NSUInteger)line;
 
 + (NSFont*)sourceFont;
@@ -16,14 +16,25 @@
 
 #import "BSSourceView.h"
 
-#import "PreferenceNames.h"
+#import "BSHighlightCache.h"
+#import "BSLineIndex.h"
 #import "BSLineNumberRulerView.h"
+#import "BSPHPHighlighter.h"
 #import "BSSourceViewTextView.h"
+#import "LocalSourceFile.h"
+
+// The number of highlight runs to color per pass through the run loop.
+static const NSUInteger kHighlightChunkSize = 2000;
+
+// The number of highlighted files to remember.
+static const NSUInteger kHighlightCacheCapacity = 8;
 
 @interface BSSourceView (Private)
 - (void)setupViews;
 - (void)errorHighlightingFile:(NSNotification*)notif;
-- (void)setPlainTextStringFromFile:(NSString*)filePath;
+- (void)textStorageDidProcessEditing:(NSNotification*)notif;
+- (void)setSourceString:(NSString*)source;
+- (void)setSourceFromFile:(NSString*)filePath;
 @end
 
 @implementation BSSourceView {
@@ -35,16 +46,30 @@
   NSSet<NSNumber*>* _markers;
 
   NSString* _file;
+
+  // Incremented each time the source changes, to abandon highlighting of the
+  // previous source.
+  NSUInteger _highlightGeneration;
+
+  // The highlighted text of recently shown files.
+  BSHighlightCache* _highlightCache;
 }
 
 - (id)initWithFrame:(NSRect)frame
 {
   if (self = [super initWithFrame:frame]) {
+    _highlightCache = [[BSHighlightCache alloc] initWithCapacity:kHighlightCacheCapacity];
+    _lineIndex = [[BSLineIndex alloc] initWithString:@""];
     [self setupViews];
   }
   return self;
 }
 
+- (void)dealloc
+{
+  [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
 - (void)setMarkers:(NSSet*)markers {
   _markers = [markers copy];
   [_ruler setNeedsDisplay:YES];
@@ -65,11 +90,13 @@
   _file = [f copy];
   
   if (![[NSFileManager defaultManager] fileExistsAtPath:f]) {
+    ++_highlightGeneration;
     [_textView setString:@""];
+    [_ruler performLayout];
     return;
   }
 
-  [self setSource:f completionHandler:nil];
+  [self setSourceFromFile:f];
 }
 
 /**
@@ -78,19 +105,17 @@
 - (void)setString:(NSString*)source asFile:(NSString*)path
 {
   _file = [path copy];
+  [self setSourceString:source];
+}
 
-  // Write the source out as a temporary file so it can be highlighted.
-  NSError* error = nil;
-  NSString* tmpPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"MacGDBpHighlighter"];
-  [source writeToFile:tmpPath atomically:NO encoding:NSUTF8StringEncoding error:&error];
-  if (error) {
-    [_textView setString:source];
-    return;
-  }
-
-  [self setSource:tmpPath completionHandler:^{
-    [[NSFileManager defaultManager] removeItemAtPath:tmpPath error:NULL];
-  }];
+/**
+ * Sets the contents of the SourceView to the |localFile| representing the file
+ * at |path|.
+ */
+- (void)setLocalFile:(LocalSourceFile*)localFile asFile:(NSString*)path
+{
+  _file = [path copy];
+  [self setSourceString:localFile.string];
 }
 
 /**
@@ -106,23 +131,10 @@
  */
 - (void)scrollToLine:(NSUInteger)line
 {
-  if ([[_textView textStorage] length] == 0)
+  NSRange range = [_lineIndex rangeOfLine:line];
+  if (range.location == NSNotFound)
     return;
-  
-  // go through the document until we find the NSRange for the line we want
-  NSUInteger rangeIndex = 0;
-  for (NSUInteger i = 0; i < line; i++) {
-    rangeIndex = NSMaxRange([[_textView string] lineRangeForRange:NSMakeRange(rangeIndex, 0)]);
-  }
-
-  // now get the true start/end markers for it
-  NSUInteger lineStart, lineEnd;
-  [[_textView string] getLineStart:&lineStart
-                               end:NULL
-                       contentsEnd:&lineEnd
-                          forRange:NSMakeRange(rangeIndex - 1, 0)];
-  [_textView scrollRangeToVisible:[[_textView string]
-                lineRangeForRange:NSMakeRange(lineStart, lineEnd - lineStart)]];
+  [_textView scrollRangeToVisible:range];
 }
 
 /**
@@ -172,6 +184,12 @@
   [_textView setAutoresizingMask:NSViewNotSizable];
   [_scrollView setDocumentView:_textView];
 
+  // Keep the line index in sync with the text.
+  [[NSNotificationCenter defaultCenter] addObserver:self
+                                           selector:@selector(textStorageDidProcessEditing:)
+                                               name:NSTextStorageDidProcessEditingNotification
+                                             object:[_textView textStorage]];
+
   // Set up the ruler.
   _ruler = [[BSLineNumberRulerView alloc] initWithSourceView:self];
   [_scrollView setVerticalRulerView:_ruler];
@@ -182,109 +200,114 @@
   [self registerForDraggedTypes:@[ NSFilenamesPboardType ]];
 }
 
-NSString* ColorHEXStringINIDirective(NSString* directive, NSColor* color) {
-  CGFloat red, green, blue, alpha;
-  color = [color colorUsingColorSpaceName:NSCalibratedRGBColorSpace];
-  [color getRed:&red green:&green blue:&blue alpha:&alpha];
-  return [NSString stringWithFormat:@"%@=\"#%02x%02x%02x\"", directive, (UInt8)(red * 255), (UInt8)(green * 255), (UInt8)(blue * 255)];
-}
-
 /**
- * Reads the contents of |filePath| and sets it as the displayed text, after
- * attempting to highlight it using the PHP binary.
+ * Displays |source| as plain text, and then highlights it. The source is
+ * tokenized in the background, after which the visible runs are colored first
+ * and the rest are colored in chunks, so the UI stays responsive.
  */
-- (void)setSource:(NSString*)filePath completionHandler:(void(^)(void))handler
+- (void)setSourceString:(NSString*)source
 {
-  @try {
-    // Attempt to use the PHP CLI to highlight the source file as HTML
-    NSPipe* outPipe = [NSPipe pipe];
-    NSPipe* errPipe = [NSPipe pipe];
-    NSTask* task = [[NSTask alloc] init];
-
-    NSString* phpPath = [[NSUserDefaults standardUserDefaults] stringForKey:kPrefPhpPath];
-    if (!phpPath) {
-      // This is the path to the default Leopard PHP executable, but it will not
-      // exist on future macOS versions.
-      phpPath = @"/usr/bin/php";
-    }
+  NSUInteger generation = ++_highlightGeneration;
 
-    [task setLaunchPath:phpPath];
-    [task setArguments:@[
-      @"--syntax-highlight",
-      @"--define", ColorHEXStringINIDirective(@"highlight.string", [NSColor systemRedColor]),
-      @"--define", ColorHEXStringINIDirective(@"highlight.comment", [NSColor systemOrangeColor]),
-      @"--define", ColorHEXStringINIDirective(@"highlight.default", [NSColor systemBlueColor]),
-      @"--define", ColorHEXStringINIDirective(@"highlight.html", [NSColor systemGrayColor]),
-      filePath
-    ]];
-    [task setStandardOutput:outPipe];
-    [task setStandardError:errPipe];
-    [task setTerminationHandler:^(NSTask* taskBlock) {
-      if (task.terminationStatus != 0) {
-        NSLog(@"Failed to highlight PHP file %@. Termination status=%d. stderr: %@",
-              filePath, taskBlock.terminationStatus,
-              [[NSString alloc] initWithData:[[errPipe fileHandleForReading] readDataToEndOfFile] encoding:NSUTF8StringEncoding]);
-      }
-    }];
-    [task launch];
-
-    // Start reading the stdout pipe immediately. This is separate from the
-    // terminiationHandler, since a large file could be greater than
-    // the pipe buffer.
-    NSMutableAttributedString* source;
-    NSData* data = [[outPipe fileHandleForReading] readDataToEndOfFile];
-    if (data.length) {
-      source = [[NSMutableAttributedString alloc] initWithHTML:data
-                                                       options:@{ NSCharacterEncodingDocumentAttribute : @(NSUTF8StringEncoding) }
-                                            documentAttributes:nil];
-
-      // PHP uses &nbsp; in the highlighted output, which should be converted
-      // back to normal spaces.
-      NSMutableString* stringData = [source mutableString];
-      [stringData replaceOccurrencesOfString:@"\u00A0" withString:@" " options:0 range:NSMakeRange(0, stringData.length)];
-
-      // Override the default font from Courier.
-      [source addAttributes:@{ NSFontAttributeName : [[self class] sourceFont] }
-                      range:NSMakeRange(0, source.length)];
-    }
+  NSAttributedString* cached = [_highlightCache textForSource:source atPath:_file];
+  if (cached) {
+    [[_textView textStorage] setAttributedString:cached];
+    [_ruler performLayout];
+    return;
+  }
 
-    if (source) {
-      [[_textView textStorage] setAttributedString:source];
-    } else {
-      [self setPlainTextStringFromFile:filePath];
-    }
+  NSDictionary* attributes = @{ NSFontAttributeName : [[self class] sourceFont] };
+  NSAttributedString* string = [[NSAttributedString alloc] initWithString:source
+                                                               attributes:attributes];
+  [[_textView textStorage] setAttributedString:string];
+  [_ruler performLayout];
 
-    [_ruler performLayout];
+  dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    BSPHPHighlighter* highlighter = [[BSPHPHighlighter alloc] initWithSource:source];
+    dispatch_async(dispatch_get_main_queue(), ^{
+      if (generation != self->_highlightGeneration)
+        return;
+
+      // Find the runs that are on screen.
+      NSLayoutManager* layoutManager = [self->_textView layoutManager];
+      NSRange glyphs = [layoutManager glyphRangeForBoundingRect:[self->_textView visibleRect]
+                                                inTextContainer:[self->_textView textContainer]];
+      NSRange visible = [layoutManager characterRangeForGlyphRange:glyphs actualGlyphRange:NULL];
+      NSUInteger first = [highlighter indexOfRunContainingLocation:visible.location];
+      NSUInteger last = [highlighter indexOfRunContainingLocation:NSMaxRange(visible)];
+      last = MIN(last + 1, highlighter.runCount);
+
+      NSArray<NSValue*>* runs = @[
+        [NSValue valueWithRange:NSMakeRange(first, last - first)],
+        [NSValue valueWithRange:NSMakeRange(last, highlighter.runCount - last)],
+        [NSValue valueWithRange:NSMakeRange(0, first)],
+      ];
+      [self applyHighlightRuns:runs highlighter:highlighter generation:generation];
+    });
+  });
+}
 
-    if (handler) {
-      handler();
-    }
-  } @catch (NSException* exception) {
-    // If the PHP executable is not available then the NSTask will throw an exception
-    NSLog(@"Failed to highlight file: %@", exception);
-    [self setPlainTextStringFromFile:filePath];
+/**
+ * Colors a chunk of the first range of |runs|, and schedules the remainder to
+ * be colored on a later pass through the run loop.
+ */
+- (void)applyHighlightRuns:(NSArray<NSValue*>*)runs
+               highlighter:(BSPHPHighlighter*)highlighter
+                generation:(NSUInteger)generation
+{
+  if (generation != _highlightGeneration || runs.count == 0)
+    return;
+
+  NSMutableArray<NSValue*>* remaining = [runs mutableCopy];
+  NSRange range = [remaining[0] rangeValue];
+  NSRange chunk = NSMakeRange(range.location, MIN(range.length, kHighlightChunkSize));
+  [highlighter applyRuns:chunk toTextStorage:[_textView textStorage]];
+
+  if (chunk.length == range.length)
+    [remaining removeObjectAtIndex:0];
+  else
+    remaining[0] = [NSValue valueWithRange:NSMakeRange(NSMaxRange(chunk), range.length - chunk.length)];
+
+  if (remaining.count) {
+    dispatch_async(dispatch_get_main_queue(), ^{
+      [self applyHighlightRuns:remaining highlighter:highlighter generation:generation];
+    });
+  } else {
+    [_highlightCache setText:[_textView textStorage]
+                   forSource:highlighter.source
+                      atPath:_file];
   }
 }
 
 /**
- * Gets the plain-text representation of the file at |filePath| and sets the
- * contents in the source view.
+ * Patches the line index for the lines touched by an edit to the text. Edits
+ * that only change attributes, such as highlighting, are ignored.
  */
-- (void)setPlainTextStringFromFile:(NSString*)filePath
+- (void)textStorageDidProcessEditing:(NSNotification*)notif
+{
+  NSTextStorage* textStorage = [notif object];
+  if (!([textStorage editedMask] & NSTextStorageEditedCharacters))
+    return;
+  [_lineIndex updateForEditedRange:[textStorage editedRange]
+                    changeInLength:[textStorage changeInLength]
+                            string:[textStorage string]];
+}
+
+/**
+ * Reads the file at |filePath| and sets it as the displayed text.
+ */
+- (void)setSourceFromFile:(NSString*)filePath
 {
   NSError* error = nil;
-  NSString* contents = [NSString stringWithContentsOfFile:filePath
-                                                 encoding:NSUTF8StringEncoding
-                                                    error:&error];
-  if (error) {
+  NSString* contents = [[LocalSourceFile fileAtPath:filePath error:&error] string];
+  if (!contents) {
     NSLog(@"Error reading file at %@: %@", filePath, error);
     if ([_delegate respondsToSelector:@selector(error:whileHighlightingFile:)]) {
       [_delegate error:error whileHighlightingFile:filePath];
     }
     return;
   }
-  [_textView setString:contents];
-  [_ruler performLayout];
+  [self setSourceString:contents];
 }
 
 // Drag Handlers ///////////////////////////////////////////////////////////////
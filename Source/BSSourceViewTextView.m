@@ -16,6 +16,7 @@
 
 #import "BSSourceViewTextView.h"
 
+#import "BSLineIndex.h"
 #import "BSSourceView.h"
 
 @implementation BSSourceViewTextView
@@ -24,23 +25,22 @@
 {
   [super drawRect:rect];
 
-  NSLayoutManager* layoutManager = [self layoutManager];
-  NSUInteger i = 0, line = 1;
-  while (i < [layoutManager numberOfGlyphs]) {
-    NSRange fragRange;
-    NSRect fragRect = [layoutManager lineFragmentRectForGlyphAtIndex:i
-                                                      effectiveRange:&fragRange];
-    if ([_sourceView markedLine] == line) {
-      fragRect = [self convertRect:fragRect fromView:self];
-      fragRect.origin.x = rect.origin.x;  // Flush all the way to the edge.
-      [[[NSColor redColor] colorWithAlphaComponent:0.25] set];
-      [NSBezierPath fillRect:fragRect];
-      break;
-    }
+  NSUInteger characterIndex =
+      [[_sourceView lineIndex] characterIndexForLine:[_sourceView markedLine]];
+  if (characterIndex == NSNotFound)
+    return;
 
-    i += fragRange.length;
-    ++line;
+  NSLayoutManager* layoutManager = [self layoutManager];
+  NSRect fragRect;
+  if (characterIndex < [[self textStorage] length]) {
+    NSUInteger glyphIndex = [layoutManager glyphIndexForCharacterAtIndex:characterIndex];
+    fragRect = [layoutManager lineFragmentRectForGlyphAtIndex:glyphIndex effectiveRange:NULL];
+  } else {
+    fragRect = [layoutManager extraLineFragmentRect];
   }
+  fragRect.origin.x = rect.origin.x;  // Flush all the way to the edge.
+  [[[NSColor redColor] colorWithAlphaComponent:0.25] set];
+  [NSBezierPath fillRect:fragRect];
 }
 
 @end
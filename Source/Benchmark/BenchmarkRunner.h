@@ -0,0 +1,78 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Foundation/Foundation.h>
+
+@class BenchmarkScenario;
+@class ProtocolMetrics;
+@class SessionRecording;
+
+// The measurements of one run of a BenchmarkScenario.
+@interface BenchmarkResult : NSObject
+
+@property(readonly, nonatomic) NSString* name;
+
+// The time each step took, from sending the step command until the top frame
+// was loaded, in seconds.
+@property(readonly, nonatomic) NSArray<NSNumber*>* latencies;
+
+// The time all the steps took, in seconds.
+@property(readonly, nonatomic) NSTimeInterval duration;
+
+// The number of commands the engine received and the number of bytes it sent
+// during the steps.
+@property(readonly, nonatomic) NSUInteger commands;
+@property(readonly, nonatomic) NSUInteger bytes;
+
+// The peak resident set size of the process after the run, in bytes. This
+// covers everything the process did before, so it is only the scenario's own
+// when the scenario is the first thing the process runs.
+@property(readonly, nonatomic) NSUInteger peakResidentSize;
+
+// The timings of the commands sent during the steps.
+@property(readonly, nonatomic) ProtocolMetrics* metrics;
+
+// Returns the step latency at |percentile|, between 0 and 100.
+- (NSTimeInterval)latencyAtPercentile:(double)percentile;
+
+@end
+
+// BenchmarkRunner runs a scenario against a FakeDebuggerEngine over loopback,
+// or replays a recorded session, driving a DebuggerBackEnd the way the
+// DebuggerController would. It must be used on the main thread, whose run loop
+// it runs while it waits.
+@interface BenchmarkRunner : NSObject
+
+// The directory of the scripts that scenarios send as source, which is
+// dev/tests/ in the source tree.
+@property(copy, nonatomic) NSString* scriptsDirectory;
+
+// Runs |scenario|. Returns nil and prints the reason if its script cannot be
+// read from |scriptsDirectory|, or if the session stalls.
+- (BenchmarkResult*)runScenario:(BenchmarkScenario*)scenario;
+
+// Replays |recording| with a SessionReplayer. Whenever the replay waits for a
+// command that the back end does not send by itself, the user action that
+// sends it is performed: a step, loading a page of a variable, or selecting a
+// stack frame. The latencies are those of the steps. If |preservesTiming|, the
+// recorded delays of the engine are reproduced. Returns nil and prints the
+// reason if the recording needs an action that cannot be reproduced, or if
+// the session stalls.
+- (BenchmarkResult*)runRecording:(SessionRecording*)recording
+                            name:(NSString*)name
+                 preservesTiming:(BOOL)preservesTiming;
+
+@end
@@ -0,0 +1,350 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "BenchmarkRunner.h"
+
+#include <sys/resource.h>
+
+#import "BenchmarkScenario.h"
+#import "DebuggerBackEnd.h"
+#import "DebuggerModel.h"
+#import "FakeDebuggerEngine.h"
+#import "ProtocolMetrics.h"
+#import "SessionRecording.h"
+#import "SessionReplayer.h"
+#import "SourceCache.h"
+#import "StackFrame.h"
+#import "VariableNode.h"
+
+// How long to wait for the debugger before giving up on a scenario.
+static const NSTimeInterval kTimeout = 60;
+
+static NSTimeInterval Now(void) {
+  return [[NSProcessInfo processInfo] systemUptime];
+}
+
+// Returns the value of the |-flag| argument in |command|, or nil.
+static NSString* ArgumentValue(NSString* command, NSString* flag) {
+  NSArray<NSString*>* arguments = [command componentsSeparatedByString:@" "];
+  NSUInteger index = [arguments indexOfObject:flag];
+  if (index == NSNotFound || index + 1 >= arguments.count)
+    return nil;
+  return arguments[index + 1];
+}
+
+// Returns the node named |fullName| among |nodes| and their loaded
+// descendants, or nil.
+static VariableNode* FindVariable(NSArray<VariableNode*>* nodes, NSString* fullName) {
+  for (VariableNode* node in nodes) {
+    if (node.isPlaceholder)
+      continue;
+    if ([node.fullName isEqualToString:fullName])
+      return node;
+    if (node.isLeaf || ![fullName hasPrefix:node.fullName])
+      continue;
+    VariableNode* found = FindVariable(node.children, fullName);
+    if (found)
+      return found;
+  }
+  return nil;
+}
+
+// Returns the peak resident set size of the process, in bytes.
+static NSUInteger PeakResidentSize(void) {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+@implementation BenchmarkResult {
+  // |latencies|, sorted.
+  NSArray<NSNumber*>* _sortedLatencies;
+}
+
+- (instancetype)initWithName:(NSString*)name
+                   latencies:(NSArray<NSNumber*>*)latencies
+                    duration:(NSTimeInterval)duration
+                    commands:(NSUInteger)commands
+                       bytes:(NSUInteger)bytes
+                     metrics:(ProtocolMetrics*)metrics {
+  if ((self = [super init])) {
+    _name = [name copy];
+    _latencies = [latencies copy];
+    _sortedLatencies = [latencies sortedArrayUsingSelector:@selector(compare:)];
+    _duration = duration;
+    _commands = commands;
+    _bytes = bytes;
+    _metrics = metrics;
+    _peakResidentSize = PeakResidentSize();
+  }
+  return self;
+}
+
+- (NSTimeInterval)latencyAtPercentile:(double)percentile {
+  if (_sortedLatencies.count == 0)
+    return 0;
+  // The nearest-rank method.
+  NSUInteger rank = (NSUInteger)ceil(percentile / 100 * _sortedLatencies.count);
+  NSUInteger index = MIN(MAX(rank, 1u), _sortedLatencies.count) - 1;
+  return [_sortedLatencies[index] doubleValue];
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////
+
+@implementation BenchmarkRunner
+
+- (BenchmarkResult*)runScenario:(BenchmarkScenario*)scenario {
+  NSString* script = nil;
+  if (scenario.script) {
+    NSString* path = [self.scriptsDirectory stringByAppendingPathComponent:scenario.script];
+    NSError* error = nil;
+    script = [NSString stringWithContentsOfFile:path encoding:NSUTF8StringEncoding error:&error];
+    if (!script) {
+      fprintf(stderr, "Could not read %s: %s\n",
+              [path UTF8String], [[error localizedDescription] UTF8String]);
+      return nil;
+    }
+  }
+
+  uint16_t port = 19000 + arc4random_uniform(1000);
+  DebuggerModel* model = [[DebuggerModel alloc] init];
+  DebuggerBackEnd* backEnd = [[DebuggerBackEnd alloc] initWithModel:model port:port autoAttach:YES];
+
+  FakeDebuggerEngine* engine = [[FakeDebuggerEngine alloc] initWithPort:port];
+  engine.stackDepth = scenario.stackDepth;
+  engine.arrayLength = scenario.arrayLength;
+  engine.globalsCount = scenario.globalsCount;
+  if (scenario.expandsArray)
+    backEnd.expandedVariables = [NSSet setWithObject:@"$a"];
+  if (script) {
+    engine.source = [@"" stringByPaddingToLength:script.length * scenario.sourceRepeat
+                                      withString:script
+                                 startingAtIndex:0];
+  }
+
+  // Each context has one variable, plus the ones the scenario adds.
+  NSUInteger variableCount = 3 + (scenario.arrayLength ? 1 : 0) + scenario.globalsCount;
+
+  BenchmarkResult* result = nil;
+  [engine connect];
+  if ([self waitFor:@"connection" until:^BOOL{ return model.connected; }]) {
+    NSUInteger commands = engine.commands.count;
+    NSUInteger bytes = engine.bytesWritten;
+    NSMutableArray<NSNumber*>* latencies = [NSMutableArray array];
+    ProtocolMetrics* metrics = [[ProtocolMetrics alloc] init];
+    backEnd.metrics = metrics;
+    NSTimeInterval start = Now();
+
+    for (NSUInteger i = 0; i < scenario.steps; ++i) {
+      if (scenario.refetchesSource)
+        [backEnd.sourceCache removeAllSources];
+
+      NSTimeInterval stepStart = Now();
+      if (![self stepBackEnd:backEnd model:model variableCount:variableCount scenario:scenario])
+        break;
+      [latencies addObject:@(Now() - stepStart)];
+    }
+
+    if (latencies.count == scenario.steps) {
+      result = [[BenchmarkResult alloc] initWithName:scenario.name
+                                           latencies:latencies
+                                            duration:Now() - start
+                                            commands:engine.commands.count - commands
+                                               bytes:engine.bytesWritten - bytes
+                                             metrics:metrics];
+    }
+  }
+
+  backEnd.autoAttach = NO;
+  [engine disconnect];
+  return result;
+}
+
+- (BenchmarkResult*)runRecording:(SessionRecording*)recording
+                            name:(NSString*)name
+                 preservesTiming:(BOOL)preservesTiming {
+  uint16_t port = 19000 + arc4random_uniform(1000);
+  DebuggerModel* model = [[DebuggerModel alloc] init];
+  DebuggerBackEnd* backEnd = [[DebuggerBackEnd alloc] initWithModel:model port:port autoAttach:YES];
+  ProtocolMetrics* metrics = [[ProtocolMetrics alloc] init];
+  backEnd.metrics = metrics;
+
+  SessionReplayer* replayer = [[SessionReplayer alloc] initWithRecording:recording port:port];
+  replayer.preservesTiming = preservesTiming;
+
+  NSUInteger commands = 0;
+  NSUInteger bytes = 0;
+  for (SessionRecord* record in recording.records) {
+    if (record.direction == kLogEntrySending)
+      ++commands;
+    else
+      bytes += record.message.length;
+  }
+
+  BenchmarkResult* result = nil;
+  [replayer connect];
+  if ([self waitFor:@"connection" until:^BOOL{ return model.connected; }]) {
+    NSMutableArray<NSNumber*>* latencies = [NSMutableArray array];
+    NSTimeInterval start = Now();
+    NSTimeInterval stepStart = 0;
+    for (;;) {
+      // The client is idle once every command it sent has been handled. If
+      // the replay is then waiting for a command, it is one the user sent.
+      BOOL idle = [self waitFor:@"replay" until:^BOOL{
+        return replayer.finished || replayer.failed ||
+            (replayer.awaitedCommand && metrics.pendingTransactionCount == 0);
+      }];
+      if (!idle || replayer.failed)
+        break;
+      if (stepStart) {
+        [latencies addObject:@(Now() - stepStart)];
+        stepStart = 0;
+      }
+
+      NSString* command = replayer.awaitedCommand;
+      if (replayer.finished || !command) {
+        result = [[BenchmarkResult alloc] initWithName:name
+                                             latencies:latencies
+                                              duration:Now() - start
+                                              commands:commands
+                                                 bytes:bytes
+                                               metrics:metrics];
+        break;
+      }
+
+      NSTimeInterval actionStart = Now();
+      BOOL isStep = NO;
+      // An action that sends nothing, such as loading a page that is already
+      // loaded, means the session has diverged from the recording.
+      if (![self performCommand:command backEnd:backEnd model:model isStep:&isStep] ||
+          metrics.pendingTransactionCount == 0) {
+        fprintf(stderr, "The recording needs \"%s\", which cannot be reproduced\n",
+                [command UTF8String]);
+        break;
+      }
+      if (isStep)
+        stepStart = actionStart;
+    }
+  }
+  if (replayer.failed)
+    fprintf(stderr, "The session diverged from the recording\n");
+
+  backEnd.autoAttach = NO;
+  [replayer disconnect];
+  return result;
+}
+
+// Private /////////////////////////////////////////////////////////////////////
+
+// Performs the user action that makes the back end send |command|. Sets
+// |isStep| if it continues the program. Returns NO if there is no such action.
+- (BOOL)performCommand:(NSString*)command
+               backEnd:(DebuggerBackEnd*)backEnd
+                 model:(DebuggerModel*)model
+                isStep:(BOOL*)isStep {
+  NSString* name = [command componentsSeparatedByString:@" "].firstObject;
+  *isStep = YES;
+  if ([name isEqualToString:@"step_into"]) {
+    [backEnd stepIn];
+  } else if ([name isEqualToString:@"step_over"]) {
+    [backEnd stepOver];
+  } else if ([name isEqualToString:@"step_out"]) {
+    [backEnd stepOut];
+  } else if ([name isEqualToString:@"run"]) {
+    [backEnd run];
+  } else {
+    *isStep = NO;
+  }
+  if (*isStep)
+    return YES;
+
+  if ([name isEqualToString:@"stop"]) {
+    [backEnd stop];
+    return YES;
+  }
+  if ([name isEqualToString:@"detach"]) {
+    [backEnd detach];
+    return YES;
+  }
+
+  // The other actions are in the scope of a stack frame.
+  NSUInteger depth = [ArgumentValue(command, @"-d") integerValue];
+  if (depth >= model.stack.count)
+    return NO;
+  StackFrame* frame = model.stack[depth];
+  if ([name isEqualToString:@"context_names"] || [name isEqualToString:@"context_get"]) {
+    [backEnd loadStackFrame:frame];
+    return YES;
+  }
+  if ([name isEqualToString:@"property_get"]) {
+    NSString* fullName = ArgumentValue(command, @"-n");
+    VariableNode* variable = fullName ? FindVariable(frame.variables, fullName) : nil;
+    if (!variable)
+      return NO;
+    [backEnd loadPage:[ArgumentValue(command, @"-p") integerValue]
+       ofVariableNode:variable
+        forStackFrame:frame];
+    return YES;
+  }
+  return NO;
+}
+
+// Steps and waits for the new top frame to have its |variableCount| variables
+// and its source, and then for the array $a to be loaded if the scenario
+// expands it.
+- (BOOL)stepBackEnd:(DebuggerBackEnd*)backEnd
+              model:(DebuggerModel*)model
+      variableCount:(NSUInteger)variableCount
+           scenario:(BenchmarkScenario*)scenario {
+  StackFrame* previous = model.stack.firstObject;
+  [backEnd stepIn];
+  BOOL loaded = [self waitFor:@"top frame" until:^BOOL{
+    StackFrame* frame = model.stack.firstObject;
+    return frame && frame != previous && frame.variables.count == variableCount &&
+        (frame.source || frame.localFile);
+  }];
+  if (!loaded || !scenario.expandsArray)
+    return loaded;
+
+  StackFrame* frame = model.stack.firstObject;
+  VariableNode* array = nil;
+  for (VariableNode* variable in frame.variables) {
+    if ([variable.name isEqualToString:@"$a"])
+      array = variable;
+  }
+  NSUInteger pages = (array.childCount + array.pageSize - 1) / MAX(array.pageSize, 1u);
+  for (NSUInteger page = 0; page < pages; ++page)
+    [backEnd loadPage:page ofVariableNode:array forStackFrame:frame];
+  return [self waitFor:@"$a" until:^BOOL{ return array.childrenLoaded; }];
+}
+
+// Runs the run loop until |predicate| returns YES. Returns NO if it times out.
+- (BOOL)waitFor:(NSString*)description until:(BOOL (^)(void))predicate {
+  NSDate* deadline = [NSDate dateWithTimeIntervalSinceNow:kTimeout];
+  while (!predicate()) {
+    if ([deadline timeIntervalSinceNow] < 0) {
+      fprintf(stderr, "Timed out waiting for %s\n", [description UTF8String]);
+      return NO;
+    }
+    [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode
+                             beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.001]];
+  }
+  return YES;
+}
+
+@end
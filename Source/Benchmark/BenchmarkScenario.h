@@ -0,0 +1,57 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Foundation/Foundation.h>
+
+// A BenchmarkScenario describes a debugging session for the benchmark to run
+// against the FakeDebuggerEngine. Most scenarios imitate one of the scripts in
+// dev/tests/, with the stack and variables that script has; the others are
+// synthetic, to stress one part of the protocol.
+@interface BenchmarkScenario : NSObject
+
+@property(copy, nonatomic) NSString* name;
+
+// The name of the script in dev/tests/ that the engine sends as the source of
+// every file, or nil to send the engine's default source.
+@property(copy, nonatomic) NSString* script;
+
+// The number of times the debugger is stepped.
+@property(assign, nonatomic) NSUInteger steps;
+
+// The FakeDebuggerEngine settings of the same names.
+@property(assign, nonatomic) NSUInteger stackDepth;
+@property(assign, nonatomic) NSUInteger arrayLength;
+@property(assign, nonatomic) NSUInteger globalsCount;
+
+// The number of copies of the script that make up the source of each file.
+@property(assign, nonatomic) NSUInteger sourceRepeat;
+
+// Whether every page of the array $a is loaded after each step, as if the user
+// had expanded it and scrolled through it.
+@property(assign, nonatomic) BOOL expandsArray;
+
+// Whether the source cache is emptied before each step, so that each step
+// transfers the source of the top frame.
+@property(assign, nonatomic) BOOL refetchesSource;
+
+// The scenarios that are run by default.
++ (NSArray<BenchmarkScenario*>*)defaultScenarios;
+
+// Returns a scenario with the given |name|, |script| and |steps|, a one-frame
+// stack, and only the variables that the engine always sends.
++ (instancetype)scenarioNamed:(NSString*)name script:(NSString*)script steps:(NSUInteger)steps;
+
+@end
@@ -0,0 +1,76 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "BenchmarkScenario.h"
+
+@implementation BenchmarkScenario
+
++ (instancetype)scenarioNamed:(NSString*)name script:(NSString*)script steps:(NSUInteger)steps {
+  BenchmarkScenario* scenario = [[self alloc] init];
+  scenario.name = name;
+  scenario.script = script;
+  scenario.steps = steps;
+  scenario.stackDepth = 1;
+  scenario.sourceRepeat = 1;
+  return scenario;
+}
+
++ (NSArray<BenchmarkScenario*>*)defaultScenarios {
+  // Stepping through C::test(), called from the top level, which measures the
+  // fixed cost of a step.
+  BenchmarkScenario* steps = [self scenarioNamed:@"static" script:@"static.php" steps:200];
+  steps.stackDepth = 2;
+
+  // The 2048 element array that the script builds, read in pages of 32.
+  BenchmarkScenario* longArray = [self scenarioNamed:@"long_array" script:@"long_array.php" steps:20];
+  longArray.arrayLength = 2048;
+  longArray.expandsArray = YES;
+
+  // Stepping to the exception thrown in Something(), called from the top
+  // level.
+  BenchmarkScenario* exception = [self scenarioNamed:@"exception" script:@"exception.php" steps:20];
+  exception.stackDepth = 2;
+
+  // Iterating over $_SERVER in OK(), whose entries are sent as strings in the
+  // Superglobals context. Its size depends on the server and the environment,
+  // so 50 entries is an assumption.
+  BenchmarkScenario* server = [self scenarioNamed:@"space name" script:@"space name.php" steps:20];
+  server.stackDepth = 2;
+  server.globalsCount = 50;
+
+  // Stepping through the template's loop, which runs 100 times, with its
+  // source transferred on every step.
+  BenchmarkScenario* source = [self scenarioNamed:@"bug-207" script:@"bug-207.php" steps:100];
+  source.refetchesSource = YES;
+
+  // The synthetic scenarios. A 256-frame stack, as in a deep framework call.
+  BenchmarkScenario* deepStack = [self scenarioNamed:@"deep_stack" script:nil steps:20];
+  deepStack.stackDepth = 256;
+
+  // 5000 globals, which makes context_get responses large.
+  BenchmarkScenario* globals = [self scenarioNamed:@"many_globals" script:nil steps:20];
+  globals.globalsCount = 5000;
+
+  // bug-207.php's template repeated to about 1.4 MB, transferred on every
+  // step.
+  BenchmarkScenario* largeSource = [self scenarioNamed:@"large_source" script:@"bug-207.php" steps:20];
+  largeSource.sourceRepeat = 2000;
+  largeSource.refetchesSource = YES;
+
+  return @[ steps, longArray, exception, server, source, deepStack, globals, largeSource ];
+}
+
+@end
@@ -0,0 +1,172 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+// MacGDBp-Benchmark measures how quickly the DebuggerBackEnd handles debugging
+// sessions, by running scenarios against a FakeDebuggerEngine over loopback.
+//
+// Usage: MacGDBp-Benchmark [-scripts <dir>] [-scenario <name>] [-steps <count>]
+//                          [-commands YES]
+//        MacGDBp-Benchmark -replay <recording> [-timing YES] [-commands YES]
+//
+// By default, every scenario in +[BenchmarkScenario defaultScenarios] is run.
+// -scripts is the dev/tests/ directory of the source tree, whose scripts the
+// scenarios send as source; it defaults to dev/tests in the current directory.
+// -scenario runs only the one with that name, and -steps overrides the number
+// of steps. When more than one scenario runs, each runs in a process of its
+// own, so that its peak RSS is not that of the scenarios before it.
+// -commands breaks each scenario down by command, into the median time waiting
+// for the engine (first byte and receive) and the median time the client spent
+// (parse, queue and handler).
+//
+// -replay instead replays a session recorded by MacGDBp, as set up in its
+// SessionRecordingDirectory preference, in place of the FakeDebuggerEngine.
+// The engine's messages are sent as soon as the client asks for them, unless
+// -timing reproduces the recorded delays.
+
+#import <Foundation/Foundation.h>
+
+#import "BenchmarkRunner.h"
+#import "BenchmarkScenario.h"
+#import "ProtocolMetrics.h"
+#import "SessionRecording.h"
+
+static void PrintHeader(void) {
+  printf("%-20s %6s %9s %9s %9s %9s %10s %9s %11s\n",
+         "scenario", "steps", "p50 ms", "p90 ms", "p99 ms", "max ms", "cmds/s", "MB/s", "peak RSS MB");
+}
+
+static void PrintResult(BenchmarkResult* result) {
+  printf("%-20s %6lu %9.2f %9.2f %9.2f %9.2f %10.0f %9.2f %11.1f\n",
+         [result.name UTF8String],
+         result.latencies.count,
+         [result latencyAtPercentile:50] * 1000,
+         [result latencyAtPercentile:90] * 1000,
+         [result latencyAtPercentile:99] * 1000,
+         [result latencyAtPercentile:100] * 1000,
+         result.commands / result.duration,
+         result.bytes / result.duration / (1024 * 1024),
+         result.peakResidentSize / (1024.0 * 1024));
+}
+
+static void PrintCommandMetrics(ProtocolMetrics* metrics) {
+  printf("  %-18s %6s %9s %9s %9s %9s %9s %9s\n",
+         "command", "count", "first ms", "recv ms", "parse ms", "queue ms", "handle ms", "p99 ms");
+  for (NSString* command in metrics.commands) {
+    CommandMetrics* commandMetrics = [metrics metricsForCommand:command];
+    printf("  %-18s %6lu %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f\n",
+           [command UTF8String],
+           commandMetrics.count,
+           [commandMetrics.timeToFirstByte durationAtPercentile:50] * 1000,
+           [commandMetrics.receiveTime durationAtPercentile:50] * 1000,
+           [commandMetrics.parseTime durationAtPercentile:50] * 1000,
+           [commandMetrics.queueTime durationAtPercentile:50] * 1000,
+           [commandMetrics.handlerTime durationAtPercentile:50] * 1000,
+           [commandMetrics.totalTime durationAtPercentile:99] * 1000);
+  }
+}
+
+// Runs this tool again for just the scenario |name|, passing on the other
+// |arguments|, and returns its exit status.
+static int RunScenarioInProcess(NSString* name, NSUserDefaults* arguments) {
+  NSMutableArray<NSString*>* taskArguments =
+      [NSMutableArray arrayWithObjects:@"-scenario", name, @"-noHeader", @"YES", nil];
+  for (NSString* key in @[ @"scripts", @"steps", @"commands" ]) {
+    NSString* value = [arguments stringForKey:key];
+    if (value)
+      [taskArguments addObjectsFromArray:@[ [@"-" stringByAppendingString:key], value ]];
+  }
+
+  NSTask* task = [[NSTask alloc] init];
+  task.launchPath = [[NSBundle mainBundle] executablePath];
+  task.arguments = taskArguments;
+  [task launch];
+  [task waitUntilExit];
+  return task.terminationStatus;
+}
+
+int main(int argc, const char* argv[]) {
+  @autoreleasepool {
+    NSUserDefaults* arguments = [NSUserDefaults standardUserDefaults];
+    NSString* name = [arguments stringForKey:@"scenario"];
+    NSInteger steps = [arguments integerForKey:@"steps"];
+    BOOL printsCommands = [arguments boolForKey:@"commands"];
+
+    NSString* replayPath = [arguments stringForKey:@"replay"];
+    if (replayPath) {
+      NSError* error = nil;
+      SessionRecording* recording = [SessionRecording recordingAtPath:replayPath error:&error];
+      if (!recording) {
+        fprintf(stderr, "Could not read %s: %s\n",
+                [replayPath UTF8String], [[error localizedDescription] UTF8String]);
+        return 1;
+      }
+      PrintHeader();
+      BenchmarkResult* result =
+          [[[BenchmarkRunner alloc] init] runRecording:recording
+                                                  name:[replayPath lastPathComponent]
+                                       preservesTiming:[arguments boolForKey:@"timing"]];
+      if (!result) {
+        fprintf(stderr, "%s did not complete\n", [replayPath UTF8String]);
+        return 1;
+      }
+      PrintResult(result);
+      if (printsCommands)
+        PrintCommandMetrics(result.metrics);
+      return 0;
+    }
+
+    NSMutableArray<BenchmarkScenario*>* scenarios = [NSMutableArray array];
+    for (BenchmarkScenario* scenario in [BenchmarkScenario defaultScenarios]) {
+      if (name && ![scenario.name isEqualToString:name])
+        continue;
+      if (steps > 0)
+        scenario.steps = steps;
+      [scenarios addObject:scenario];
+    }
+    if (scenarios.count == 0) {
+      fprintf(stderr, "No scenario named %s\n", [name UTF8String]);
+      return 1;
+    }
+
+    // Peak RSS only ever grows within a process, so each scenario of a full
+    // run is measured in a process of its own.
+    if (scenarios.count > 1) {
+      PrintHeader();
+      fflush(stdout);
+      int status = 0;
+      for (BenchmarkScenario* scenario in scenarios) {
+        if (RunScenarioInProcess(scenario.name, arguments) != 0)
+          status = 1;
+      }
+      return status;
+    }
+
+    if (![arguments boolForKey:@"noHeader"])
+      PrintHeader();
+    BenchmarkRunner* runner = [[BenchmarkRunner alloc] init];
+    runner.scriptsDirectory = [arguments stringForKey:@"scripts"] ?: @"dev/tests";
+    BenchmarkScenario* scenario = scenarios.firstObject;
+    BenchmarkResult* result = [runner runScenario:scenario];
+    if (!result) {
+      fprintf(stderr, "%s did not complete\n", [scenario.name UTF8String]);
+      return 1;
+    }
+    PrintResult(result);
+    if (printsCommands)
+      PrintCommandMetrics(result.metrics);
+    return 0;
+  }
+}
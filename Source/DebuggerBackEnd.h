@@ -20,6 +20,8 @@
 
 @class Breakpoint;
 @class DebuggerModel;
+@class LoggingController;
+@class SourceCache;
 @class StackFrame;
 @class VariableNode;
 
@@ -36,6 +38,35 @@
 // The model object to update in response to changes in the debugger.
 @property(readonly, nonatomic) DebuggerModel* model;
 
+// Whether the stack is fetched with a single stack_get command, rather than
+// a stack_depth command followed by a stack_get for each frame. Defaults to
+// YES.
+@property(assign, nonatomic) BOOL fetchesStackInOneRequest;
+
+// Whether expanding a variable also fetches the children of its descendants
+// that are going to be re-expanded, in a single property_get with a deeper
+// max_depth, or with parallel property_gets if the engine does not honor it.
+// Defaults to YES.
+@property(assign, nonatomic) BOOL batchesVariableExpansion;
+
+// The full names of the variables that are expanded in the UI. After the
+// program runs, only the pages of children of these are fetched again; those
+// of collapsed variables are fetched when they are next expanded.
+@property(strong, nonatomic) NSSet<NSString*>* expandedVariables;
+
+// The source code fetched during the current connection.
+@property(readonly, nonatomic) SourceCache* sourceCache;
+
+// The controller that records the messages exchanged with the debugger engine.
+@property(weak, nonatomic) LoggingController* logger;
+
+// If set, each connection is saved as a SessionRecording in this directory.
+@property(copy, nonatomic) NSString* recordingDirectory;
+
+// If set, the timings of the commands sent to the debugger engine are
+// collected here.
+@property(strong, nonatomic) ProtocolMetrics* metrics;
+
 // Designated initializer. Sets up a connection on |aPort| and will
 // initialize it if |autoAttach| is YES.
 - (instancetype)initWithModel:(DebuggerModel*)model
@@ -56,11 +87,25 @@
 // Takes a partially loaded stack frame and fetches the rest of the information.
 - (void)loadStackFrame:(StackFrame*)frame;
 
-// Ensures that a variable node's immediate children are loaded, and fetches
-// any that are not. This is done within the scope of the given stack frame.
+// Ensures that the first page of a variable node's immediate children is
+// loaded, and fetches it if not. This is done within the scope of the given
+// stack frame.
 - (void)loadVariableNode:(VariableNode*)variable
            forStackFrame:(StackFrame*)frame;
 
+// Like |-loadVariableNode:forStackFrame:|, but also fetches the first page of
+// children of the descendants of |variable| whose full names are in
+// |expanded|, so that expanding them again does not take a round trip each.
+- (void)loadVariableNode:(VariableNode*)variable
+           forStackFrame:(StackFrame*)frame
+     expandedDescendants:(NSSet<NSString*>*)expanded;
+
+// Fetches a page of a variable node's children, unless it has already been
+// loaded or requested.
+- (void)loadPage:(NSUInteger)page
+    ofVariableNode:(VariableNode*)variable
+     forStackFrame:(StackFrame*)frame;
+
 // Breakpoint management.
 - (void)addBreakpoint:(Breakpoint*)bp;
 - (void)removeBreakpoint:(Breakpoint*)bp;
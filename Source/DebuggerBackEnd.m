@@ -16,16 +16,138 @@
 
 #import "DebuggerBackEnd.h"
 
-#import "AppDelegate.h"
 #import "Breakpoint.h"
 #import "DebuggerModel.h"
-#import "NSXMLElementAdditions.h"
+#import "LocalSourceFile.h"
+#import "SourceCache.h"
 #import "StackFrame.h"
+#import "VariableNode.h"
+
+// The maximum number of bytes of source code to cache per connection.
+static const NSUInteger kSourceCacheCapacity = 32 * 1024 * 1024;
+
+// The most levels of a variable's subtree that are fetched by one property_get.
+// Each level can hold a page of children per node, so this bounds the size of
+// the response.
+static const NSUInteger kMaxBatchDepth = 3;
+
+// Returns whether |name| is the full name of a descendant of the variable whose
+// full name is |ancestor|, which it extends with an array index or a property.
+static BOOL IsDescendantName(NSString* name, NSString* ancestor) {
+  if (name.length <= ancestor.length || ![name hasPrefix:ancestor])
+    return NO;
+  unichar next = [name characterAtIndex:ancestor.length];
+  return next == '[' || next == '-' || next == ':';
+}
+
+// Returns the full names in |expanded| that are descendants of |ancestor|,
+// shortest first.
+static NSArray<NSString*>* ExpandedDescendants(NSString* ancestor, NSSet<NSString*>* expanded) {
+  NSMutableArray<NSString*>* descendants = [NSMutableArray array];
+  for (NSString* name in expanded) {
+    if (IsDescendantName(name, ancestor))
+      [descendants addObject:name];
+  }
+  [descendants sortUsingComparator:^NSComparisonResult(NSString* a, NSString* b) {
+    return a.length < b.length ? NSOrderedAscending : a.length > b.length ? NSOrderedDescending : NSOrderedSame;
+  }];
+  return descendants;
+}
+
+// Returns how many levels of |nodes|' descendants are |expanded| and have their
+// first page of children loaded, up to |limit|.
+static NSUInteger LoadedDepth(NSArray<VariableNode*>* nodes,
+                              NSSet<NSString*>* expanded,
+                              NSUInteger limit) {
+  NSUInteger depth = 0;
+  for (VariableNode* node in nodes) {
+    if (depth == limit)
+      break;
+    if (node.isLeaf || ![expanded containsObject:node.fullName])
+      continue;
+    NSArray<VariableNode*>* children = [node childrenOfPage:0];
+    if (children.count)
+      depth = MAX(depth, LoadedDepth(children, expanded, limit - 1) + 1);
+  }
+  return depth;
+}
+
+// Returns the key in |_prefetchedChildren| for the variable named |fullName|.
+static NSString* PrefetchKey(NSString* fullName, StackFrame* frame) {
+  return [NSString stringWithFormat:@"%lu %@", frame.index, fullName];
+}
+
+// Returns how many levels below |ancestor| its descendant named |name| is, up
+// to |limit|. Each array index or property that extends the name is a level.
+static NSUInteger NestingDepth(NSString* name, NSString* ancestor, NSUInteger limit) {
+  NSUInteger depth = 0;
+  unichar quote = 0;
+  for (NSUInteger i = ancestor.length; i < name.length && depth < limit; ++i) {
+    unichar c = [name characterAtIndex:i];
+    unichar next = i + 1 < name.length ? [name characterAtIndex:i + 1] : 0;
+    if (quote) {
+      // Skip over quoted array keys, which may contain anything.
+      if (c == '\\')
+        ++i;
+      else if (c == quote)
+        quote = 0;
+    } else if (c == '\'' || c == '"') {
+      quote = c;
+    } else if (c == '[') {
+      ++depth;
+    } else if ((c == '-' && next == '>') || (c == ':' && next == ':')) {
+      ++depth;
+      ++i;
+    }
+  }
+  return depth;
+}
+
+// Returns how many levels below |ancestor| the deepest of its |descendants|
+// is, up to |limit|.
+static NSUInteger ExpansionDepth(NSArray<NSString*>* descendants,
+                                 NSString* ancestor,
+                                 NSUInteger limit) {
+  NSUInteger depth = 0;
+  for (NSString* name in descendants) {
+    depth = MAX(depth, NestingDepth(name, ancestor, limit));
+    if (depth == limit)
+      break;
+  }
+  return depth;
+}
 
 @implementation DebuggerBackEnd {
   // The connection to the debugger engine.
   uint16_t _port;
   ProtocolClient* _client;
+
+  // The IDs of the variable contexts, which do not change during a session.
+  // This is nil until the first context_names response arrives.
+  NSArray<NSNumber*>* _contextIDs;
+
+  // After a step, the variables of the new top frame are loaded into this
+  // frame before the stack arrives. It then replaces the top frame.
+  StackFrame* _prefetchedFrame;
+
+  // The top frame before the step, and the depth of its stack. Once the new
+  // top frame arrives, its variables are merged with those of this one only if
+  // it is the same frame, and |_prefetchPreviousVariables| is set.
+  StackFrame* _previousTopFrame;
+  NSUInteger _previousStackDepth;
+  NSArray<VariableNode*>* _prefetchPreviousVariables;
+
+  // Whether the engine is believed to honor the max_depth feature. This is
+  // cleared if a batched fetch finds that it does not.
+  BOOL _supportsMaxDepth;
+
+  // The first page of children of variables that were fetched before being
+  // expanded, keyed by PrefetchKey(). The value is NSNull while the fetch is
+  // in flight. This is replaced after each step.
+  NSMutableDictionary<NSString*, id>* _prefetchedChildren;
+
+  // Variables that were expanded while their prefetch was in flight.
+  NSMutableDictionary<NSString*, VariableNode*>* _prefetchWaiters;
 }
 
 - (instancetype)initWithModel:(DebuggerModel*)model
@@ -36,6 +158,12 @@
     _model = model;
     _port = aPort;
     _client = [[ProtocolClient alloc] initWithDelegate:self];
+    _fetchesStackInOneRequest = YES;
+    _batchesVariableExpansion = YES;
+    _supportsMaxDepth = YES;
+    _prefetchedChildren = [[NSMutableDictionary alloc] init];
+    _prefetchWaiters = [[NSMutableDictionary alloc] init];
+    _sourceCache = [[SourceCache alloc] initWithCapacity:kSourceCacheCapacity];
 
     [self setAutoAttach:doAttach];
   }
@@ -52,6 +180,30 @@
   return _port;
 }
 
+- (LoggingController*)logger {
+  return _client.logger;
+}
+
+- (void)setLogger:(LoggingController*)logger {
+  _client.logger = logger;
+}
+
+- (NSString*)recordingDirectory {
+  return _client.recordingDirectory;
+}
+
+- (void)setRecordingDirectory:(NSString*)recordingDirectory {
+  _client.recordingDirectory = recordingDirectory;
+}
+
+- (ProtocolMetrics*)metrics {
+  return _client.metrics;
+}
+
+- (void)setMetrics:(ProtocolMetrics*)metrics {
+  _client.metrics = metrics;
+}
+
 /**
  * Sets the attached state of the debugger. This will open and close the
  * connection as appropriate.
@@ -75,7 +227,7 @@
  * Tells the debugger to continue running the script. Returns the current stack frame.
  */
 - (void)run {
-  [_client sendCommandWithFormat:@"run" handler:^(NSXMLDocument* message) {
+  [_client sendCommandWithFormat:@"run" handler:^(ProtocolResponse* message) {
     [self debuggerStep:message];
   }];
 }
@@ -84,7 +236,7 @@
  * Tells the debugger to step into the current command.
  */
 - (void)stepIn {
-  [_client sendCommandWithFormat:@"step_into" handler:^(NSXMLDocument* message) {
+  [_client sendCommandWithFormat:@"step_into" handler:^(ProtocolResponse* message) {
     [self debuggerStep:message];
   }];
 }
@@ -93,7 +245,7 @@
  * Tells the debugger to step out of the current context
  */
 - (void)stepOut {
-  [_client sendCommandWithFormat:@"step_out" handler:^(NSXMLDocument* message) {
+  [_client sendCommandWithFormat:@"step_out" handler:^(ProtocolResponse* message) {
     [self debuggerStep:message];
   }];
 }
@@ -102,7 +254,7 @@
  * Tells the debugger to step over the current function
  */
 - (void)stepOver {
-  [_client sendCommandWithFormat:@"step_over" handler:^(NSXMLDocument* message) {
+  [_client sendCommandWithFormat:@"step_over" handler:^(ProtocolResponse* message) {
     [self debuggerStep:message];
   }];
 }
@@ -129,19 +281,8 @@
   if (!self.model.connected)
     return;
 
-  // Get the source code of the file. Escape % in URL chars.
-  if ([frame.filename length]) {
-    ProtocolClientMessageHandler handler = ^(NSXMLDocument* message) {
-      frame.source = [[message rootElement] base64DecodedValue];
-    };
-    [_client sendCommandWithFormat:@"source -f %@" handler:handler, frame.filename];
-  }
-
-  // Get the names of all the contexts.
-  ProtocolClientMessageHandler handler = ^(NSXMLDocument* message) {
-    [self loadContexts:message forFrame:frame];
-  };
-  [_client sendCommandWithFormat:@"context_names -d %d" handler:handler, frame.index];
+  [self loadSourceForFrame:frame];
+  [self loadVariablesForFrame:frame previousVariables:nil];
 
   // This frame will be fully loaded.
   frame.loaded = YES;
@@ -149,17 +290,79 @@
 
 - (void)loadVariableNode:(VariableNode*)variable
            forStackFrame:(StackFrame*)frame {
-  if (variable.children.count == variable.childCount)
-    return;
-
-  [self loadVariableNode:variable forStackFrame:frame dataPage:0 loadedData:@[]];
+  [self loadPage:0 ofVariableNode:variable forStackFrame:frame];
 }
 
 - (void)loadVariableNode:(VariableNode*)variable
            forStackFrame:(StackFrame*)frame
-                dataPage:(unsigned int)dataPage
-              loadedData:(NSArray*)loadedData {
-  ProtocolClientMessageHandler handler = ^(NSXMLDocument* message) {
+     expandedDescendants:(NSSet<NSString*>*)expanded {
+  NSArray<NSString*>* descendants =
+      self.batchesVariableExpansion ? ExpandedDescendants(variable.fullName, expanded) : @[];
+  if (descendants.count == 0 || variable.isLeaf || ![variable needsPage:0]) {
+    [self loadVariableNode:variable forStackFrame:frame];
+    return;
+  }
+  if ([self takePrefetchedChildrenForVariable:variable forStackFrame:frame])
+    return;
+
+  if (!_supportsMaxDepth) {
+    [self loadVariableNode:variable forStackFrame:frame];
+    [self prefetchChildrenOfVariables:descendants forStackFrame:frame];
+    return;
+  }
+
+  // Fetch the subtree deep enough to include the children of the expanded
+  // descendants. If the engine ignored max_depth, fetch the descendants
+  // separately, all at once.
+  NSUInteger depth = ExpansionDepth(descendants, variable.fullName, kMaxBatchDepth - 1) + 1;
+  [self loadSubtreeOfVariableNode:variable
+                            depth:depth
+                    forStackFrame:frame
+                          handler:^(NSArray<VariableNode*>* children, BOOL depthAccepted) {
+    [variable setChildren:children forPage:0];
+    if (!depthAccepted)
+      [self prefetchChildrenOfVariables:descendants forStackFrame:frame];
+  }];
+}
+
+- (void)loadPage:(NSUInteger)page
+    ofVariableNode:(VariableNode*)variable
+     forStackFrame:(StackFrame*)frame {
+  [self loadPage:page ofVariableNode:variable forStackFrame:frame previousChildren:nil];
+}
+
+/**
+ * Fetches a page of |variable|'s children, and merges them with the
+ * |previous| children of that page, if any, from before the program ran.
+ */
+- (void)loadPage:(NSUInteger)page
+      ofVariableNode:(VariableNode*)variable
+       forStackFrame:(StackFrame*)frame
+    previousChildren:(NSArray<VariableNode*>*)previous {
+  if (variable.isLeaf || ![variable needsPage:page])
+    return;
+  if (page == 0 && [self takePrefetchedChildrenForVariable:variable forStackFrame:frame])
+    return;
+
+  // When reloading a subtree that was loaded more than one level deep, fetch
+  // those levels together.
+  NSUInteger depth = 1;
+  if (page == 0)
+    depth = LoadedDepth(previous, self.expandedVariables, kMaxBatchDepth - 1) + 1;
+  if (depth > 1 && self.batchesVariableExpansion && _supportsMaxDepth) {
+    [self loadSubtreeOfVariableNode:variable
+                              depth:depth
+                      forStackFrame:frame
+                            handler:^(NSArray<VariableNode*>* children, BOOL depthAccepted) {
+      [variable setChildren:[self nodesByMergingNodes:children withPrevious:previous forFrame:frame]
+                    forPage:0];
+    }];
+    return;
+  }
+
+  [variable setPageRequested:page];
+
+  ProtocolClientMessageHandler handler = ^(ProtocolResponse* message) {
     /*
      <response>
        <property> <!-- this is the one we requested -->
@@ -167,26 +370,25 @@
        </property>
      </repsonse>
      */
-
-    // Detach all the children so we can insert them into another document.
-    NSXMLElement* parent = (NSXMLElement*)[[message rootElement] childAtIndex:0];
-    NSArray* children = [parent children];
-    [parent setChildren:nil];
-
-    // Check to see if there are more children to load.
-    NSArray* newLoadedData = [loadedData arrayByAddingObjectsFromArray:children];
-
-    NSInteger totalChildren = [[[parent attributeForName:@"numchildren"] stringValue] integerValue];
-    if ([newLoadedData count] < (NSUInteger)totalChildren) {
-      [self loadVariableNode:variable
-               forStackFrame:frame
-                    dataPage:dataPage + 1
-                  loadedData:newLoadedData];
-    } else {
-      [variable setChildrenFromXMLChildren:newLoadedData];
+    VariableNode* parent = message.properties.firstObject;
+    if (!parent) {
+      [variable cancelPageRequest:page];
+      return;
     }
+    NSArray<VariableNode*>* children = [self nodesByMergingNodes:[parent childrenOfPage:page]
+                                                    withPrevious:previous
+                                                        forFrame:frame];
+    [variable setChildren:children forPage:page];
+  };
+  // If the property no longer exists, let the page be requested again rather
+  // than leaving it marked as in flight.
+  ProtocolClientMessageHandler errorHandler = ^(ProtocolResponse* message) {
+    [variable cancelPageRequest:page];
+    [self protocolClient:self->_client receivedErrorMessage:message];
   };
-  [_client sendCommandWithFormat:@"property_get -d %d -n %@ -p %u" handler:handler, frame.index, variable.fullName, dataPage];
+  [_client sendCommandWithFormat:@"property_get -d %d -n %@ -p %lu"
+                         handler:handler
+                    errorHandler:errorHandler, frame.index, variable.fullName, page];
 }
 
 // Breakpoint Management ///////////////////////////////////////////////////////
@@ -199,8 +401,8 @@
   if (!self.model.connected)
     return;
 
-  ProtocolClientMessageHandler handler = ^(NSXMLDocument* message) {
-    [bp setDebuggerId:[[[[message rootElement] attributeForName:@"id"] stringValue] intValue]];
+  ProtocolClientMessageHandler handler = ^(ProtocolResponse* message) {
+    [bp setDebuggerId:[message.attributes[@"id"] intValue]];
   };
   if (bp.type == kBreakpointTypeFile) {
     NSString* file = [ProtocolClient escapedFilePathURI:[bp transformedPath]];
@@ -228,10 +430,8 @@
     return;
 
   NSData* stringData = [str dataUsingEncoding:NSUTF8StringEncoding];
-  ProtocolClientMessageHandler handler = ^(NSXMLDocument* message) {
-    NSXMLElement* parent = (NSXMLElement*)[[message rootElement] childAtIndex:0];
-    NSString* value = [parent base64DecodedValue];
-    callback(value);
+  ProtocolClientMessageHandler handler = ^(ProtocolResponse* message) {
+    callback(message.properties.firstObject.value);
   };
   [_client sendCustomCommandWithFormat:@"eval -i {txn} -- %@"
                                handler:handler, [stringData base64EncodedStringWithOptions:0]];
@@ -241,6 +441,14 @@
 #pragma mark Protocol Client Delegate
 
 - (void)debuggerEngineConnected:(ProtocolClient*)client {
+  _contextIDs = nil;
+  _prefetchedFrame = nil;
+  _previousTopFrame = nil;
+  _prefetchPreviousVariables = nil;
+  _supportsMaxDepth = YES;
+  _prefetchedChildren = [[NSMutableDictionary alloc] init];
+  _prefetchWaiters = [[NSMutableDictionary alloc] init];
+  [_sourceCache removeAllSources];
   [_model onNewConnection];
 }
 
@@ -249,23 +457,20 @@
  * socket if the debugger remains attached.
  */
 - (void)debuggerEngineDisconnected:(ProtocolClient*)client {
+  [_sourceCache removeAllSources];
   [_model onDisconnect];
 
   if (self.autoAttach)
     [self doConnect];
 }
 
-- (void)protocolClient:(ProtocolClient*)client receivedInitialMessage:(NSXMLDocument*)message {
+- (void)protocolClient:(ProtocolClient*)client receivedInitialMessage:(ProtocolResponse*)message {
   [self handleInitialResponse:message];
 }
 
-- (void)protocolClient:(ProtocolClient*)client receivedErrorMessage:(NSXMLDocument*)message {
-  NSArray* error = [[message rootElement] elementsForName:@"error"];
-  if ([error count] > 0) {
-    NSLog(@"Xdebug error: %@", error);
-    NSString* errorMessage = [[[[error objectAtIndex:0] children] objectAtIndex:0] stringValue];
-    _model.lastError = errorMessage;
-  }
+- (void)protocolClient:(ProtocolClient*)client receivedErrorMessage:(ProtocolResponse*)message {
+  NSLog(@"Xdebug error %ld: %@", message.errorCode, message.errorMessage);
+  _model.lastError = message.errorMessage;
 }
 
 // Specific Response Handlers //////////////////////////////////////////////////
@@ -274,7 +479,7 @@
 /**
  * Initial packet received. We've started a brand-new connection to the engine.
  */
-- (void)handleInitialResponse:(NSXMLDocument*)response {
+- (void)handleInitialResponse:(ProtocolResponse*)response {
   if (!self.autoAttach) {
     [_client sendCommandWithFormat:@"detach"];
     return;
@@ -290,8 +495,8 @@
 /**
  * Receiver for status updates. This just freshens up the UI.
  */
-- (void)updateStatus:(NSXMLDocument*)response {
-  NSString* status = [[[[response rootElement] attributeForName:@"status"] stringValue] capitalizedString];
+- (void)updateStatus:(ProtocolResponse*)response {
+  NSString* status = [response.attributes[@"status"] capitalizedString];
   self.model.status = status;
   if (!status || [status isEqualToString:@"Stopped"]) {
     [_model onDisconnect];
@@ -304,32 +509,69 @@
  * Step in/out/over and run all take this path. We first get the status of the
  * debugger and then request fresh stack information.
  */
-- (void)debuggerStep:(NSXMLDocument*)response {
+- (void)debuggerStep:(ProtocolResponse*)response {
   [self updateStatus:response];
   if (!self.model.connected)
     return;
 
-  [_client sendCommandWithFormat:@"stack_depth" handler:^(NSXMLDocument* message) {
-    [self rebuildStack:message];
+  if (self.fetchesStackInOneRequest) {
+    // Without a depth, stack_get returns every frame of the stack.
+    [_client sendCommandWithFormat:@"stack_get" handler:^(ProtocolResponse* message) {
+      NSArray<StackFrame*>* stack = message.stackFrames;
+      [self matchPreviousTopFrame:stack.firstObject depth:stack.count];
+      [self.model updateStack:[self stackAdoptingPrefetchedFrame:stack]];
+    }];
+  } else {
+    __block NSUInteger depth = 0;
+    [_client sendCommandWithFormat:@"stack_depth" handler:^(ProtocolResponse* message) {
+      depth = [message.attributes[@"depth"] intValue];
+    }];
+    // The top frame is requested right away, so that it arrives before the
+    // variables that are being prefetched.
+    [_client sendCommandWithFormat:@"stack_get -d 0" handler:^(ProtocolResponse* message) {
+      [self rebuildStackWithTopFrame:message.stackFrames.firstObject depth:depth];
+    }];
+  }
+
+  // Children fetched ahead of time belong to the variables before the step.
+  _prefetchedChildren = [[NSMutableDictionary alloc] init];
+  _prefetchWaiters = [[NSMutableDictionary alloc] init];
+
+  // The top frame is almost always the one that will be displayed, so load
+  // its variables without waiting for the stack to arrive. If the step stayed
+  // in the same frame, they are merged with those of the previous top frame,
+  // so that what was loaded before is kept. The stack responses come before
+  // the variables, so this is known by the time they are merged.
+  _previousTopFrame = self.model.stack.firstObject;
+  _previousStackDepth = self.model.stack.count;
+  _prefetchPreviousVariables = nil;
+  _prefetchedFrame = [[StackFrame alloc] init];
+  [self loadVariablesForFrame:_prefetchedFrame previousVariables:^{
+    return self->_prefetchPreviousVariables;
   }];
 }
 
 /**
- * We ask for the stack_depth and now we clobber the stack and start rebuilding
- * it.
+ * Once the top frame has arrived, this requests the rest of the stack with one
+ * stack_get per frame.
  */
-- (void)rebuildStack:(NSXMLDocument*)response {
-  NSUInteger depth = [[[[response rootElement] attributeForName:@"depth"] stringValue] intValue];
+- (void)rebuildStackWithTopFrame:(StackFrame*)top depth:(NSUInteger)depth {
+  [self matchPreviousTopFrame:top depth:depth];
+  if (!top || depth <= 1) {
+    [self.model updateStack:[self stackAdoptingPrefetchedFrame:top ? @[ top ] : @[]]];
+    return;
+  }
 
-  // Send a request to get each frame of the stack, which will be added to this
-  // array. When the final frame arrives, the |tempStack| is released.
-  __block NSMutableArray* tempStack = [[NSMutableArray alloc] init];
+  // Send a request to get each remaining frame of the stack, which will be
+  // added to this array. When the final frame arrives, the |tempStack| is
+  // released.
+  __block NSMutableArray* tempStack = [NSMutableArray arrayWithObject:top];
 
-  for (NSUInteger i = 0; i < depth; ++i) {
-    ProtocolClientMessageHandler handler = ^(NSXMLDocument* message) {
-      [tempStack addObject:[self transformXMLToStackFrame:message]];
+  for (NSUInteger i = 1; i < depth; ++i) {
+    ProtocolClientMessageHandler handler = ^(ProtocolResponse* message) {
+      [tempStack addObject:message.stackFrames.firstObject];
       if (i == depth - 1) {
-        [self.model updateStack:tempStack];
+        [self.model updateStack:[self stackAdoptingPrefetchedFrame:tempStack]];
       }
     };
     [_client sendCommandWithFormat:@"stack_get -d %d" handler:handler, i];
@@ -337,30 +579,123 @@
 }
 
 /**
- * Creates a StackFrame object from an NSXMLDocument response from the "stack_get"
- * command.
+ * Compares the new |top| frame with the top frame before the step. If it has
+ * the same function and file, at the same stack |depth|, the previous frame's
+ * variables are used to merge the prefetched ones.
  */
-- (StackFrame*)transformXMLToStackFrame:(NSXMLDocument*)response {
-  NSXMLElement* xmlframe = (NSXMLElement*)[[[response rootElement] children] objectAtIndex:0];
-  StackFrame* frame = [[StackFrame alloc] init];
-  frame.index = [[[xmlframe attributeForName:@"level"] stringValue] intValue];
-  frame.filename = [[xmlframe attributeForName:@"filename"] stringValue];
-  frame.lineNumber = [[[xmlframe attributeForName:@"lineno"] stringValue] intValue];
-  frame.function = [[xmlframe attributeForName:@"where"] stringValue];
-  return frame;
+- (void)matchPreviousTopFrame:(StackFrame*)top depth:(NSUInteger)depth {
+  StackFrame* previous = _previousTopFrame;
+  _previousTopFrame = nil;
+  if (previous && depth == _previousStackDepth &&
+      [top.function isEqualToString:previous.function] &&
+      [top.filename isEqualToString:previous.filename]) {
+    _prefetchPreviousVariables = previous.variables;
+  }
 }
 
 /**
- * Enumerates all the contexts of a given stack frame. We then in turn get the
- * contents of each one of these contexts.
+ * Replaces the top frame of |stack| with |_prefetchedFrame|, into which the
+ * variables of the top frame are already being loaded, and loads its source.
  */
-- (void)loadContexts:(NSXMLDocument*)response forFrame:(StackFrame*)frame {
-  NSXMLElement* contextNames = [response rootElement];
-  for (NSXMLElement* context in [contextNames children]) {
-    NSInteger cid = [[[context attributeForName:@"id"] stringValue] intValue];
-    
+- (NSArray<StackFrame*>*)stackAdoptingPrefetchedFrame:(NSArray<StackFrame*>*)stack {
+  StackFrame* prefetched = _prefetchedFrame;
+  _prefetchedFrame = nil;
+  if (!prefetched || stack.count == 0)
+    return stack;
+
+  StackFrame* top = stack.firstObject;
+  prefetched.index = top.index;
+  prefetched.filename = top.filename;
+  prefetched.lineNumber = top.lineNumber;
+  prefetched.function = top.function;
+  [self loadSourceForFrame:prefetched];
+  prefetched.loaded = YES;
+
+  NSMutableArray<StackFrame*>* newStack = [stack mutableCopy];
+  newStack[0] = prefetched;
+  return newStack;
+}
+
+/**
+ * Fetches the source code of the frame's file, unless it is already cached or
+ * there is a local copy of the file that is known to match. A local copy is
+ * compared with the engine's source the first time the file is seen on a
+ * connection, and again whenever the copy changes on disk, so a stale checkout
+ * is never shown in place of the real code.
+ */
+- (void)loadSourceForFrame:(StackFrame*)frame {
+  NSString* file = frame.filename;
+  if (![file length])
+    return;
+
+  LocalSourceFile* localFile = nil;
+  LocalFileMatch match = [_sourceCache localFileMatchForFile:file matchingFile:&localFile];
+  if (match == kLocalFileMatches) {
+    frame.localFile = localFile;
+    return;
+  }
+  if (match == kLocalFileUnchecked)
+    localFile = [LocalSourceFile fileForRemoteURI:file];
+
+  void (^useSource)(NSString*) = ^(NSString* source) {
+    if (localFile) {
+      BOOL matches = [localFile.string isEqualToString:source];
+      [self.sourceCache setLocalFile:localFile matches:matches forFile:file];
+      if (matches) {
+        frame.localFile = localFile;
+        return;
+      }
+    }
+    frame.source = [self.sourceCache setSource:source forFile:file];
+  };
+
+  NSString* source = [_sourceCache sourceForFile:file];
+  if (source && !localFile) {
+    frame.source = source;
+    return;
+  }
+  if (source) {
+    useSource(source);
+    return;
+  }
+
+  ProtocolClientMessageHandler handler = ^(ProtocolResponse* message) {
+    if (message.value)
+      useSource(message.value);
+  };
+  [_client sendCommandWithFormat:@"source -f %@" handler:handler, file];
+}
+
+/**
+ * Fetches the variables in each context of the frame. The context names are
+ * only requested the first time. The variables are merged with those returned
+ * by |previous|, which is called as each context arrives.
+ */
+- (void)loadVariablesForFrame:(StackFrame*)frame
+            previousVariables:(NSArray<VariableNode*>* (^)(void))previous {
+  if (_contextIDs) {
+    [self loadContexts:_contextIDs forFrame:frame previousVariables:previous];
+    return;
+  }
+
+  ProtocolClientMessageHandler handler = ^(ProtocolResponse* message) {
+    self->_contextIDs = message.contextIDs;
+    [self loadContexts:message.contextIDs forFrame:frame previousVariables:previous];
+  };
+  [_client sendCommandWithFormat:@"context_names -d %d" handler:handler, frame.index];
+}
+
+/**
+ * Gets the contents of each of the contexts of a given stack frame.
+ */
+- (void)loadContexts:(NSArray<NSNumber*>*)contextIDs
+             forFrame:(StackFrame*)frame
+    previousVariables:(NSArray<VariableNode*>* (^)(void))previous {
+  for (NSNumber* context in contextIDs) {
+    NSInteger cid = [context integerValue];
+
     // Fetch each context's variables.
-    ProtocolClientMessageHandler handler = ^(NSXMLDocument* message) {
+    ProtocolClientMessageHandler handler = ^(ProtocolResponse* message) {
       NSMutableArray* variables = [NSMutableArray array];
 
       // Merge the frame's existing variables.
@@ -368,13 +703,9 @@
         [variables addObjectsFromArray:frame.variables];
 
       // Add these new variables.
-      NSArray* addVariables = [[message rootElement] children];
-      if (addVariables) {
-        for (NSXMLElement* elm in addVariables) {
-          VariableNode* node = [[VariableNode alloc] initWithXMLNode:elm];
-          [variables addObject:node];
-        }
-      }
+      [variables addObjectsFromArray:[self nodesByMergingNodes:message.properties
+                                                  withPrevious:previous ? previous() : nil
+                                                      forFrame:frame]];
 
       frame.variables = variables;
     };
@@ -382,6 +713,132 @@
   }
 }
 
+/**
+ * Merges |nodes| with the |previous| nodes in their place, reusing those that
+ * have not changed. The pages of children that were loaded before are fetched
+ * again and merged in turn, but only for the |expandedVariables|, so only the
+ * parts of the tree that the user can see are refreshed.
+ */
+- (NSArray<VariableNode*>*)nodesByMergingNodes:(NSArray<VariableNode*>*)nodes
+                                  withPrevious:(NSArray<VariableNode*>*)previous
+                                      forFrame:(StackFrame*)frame {
+  return [VariableNode nodesByMergingNodes:nodes
+                              withPrevious:previous
+                                  expanded:self.expandedVariables
+                                 reloading:^(VariableNode* node, NSUInteger page, NSArray<VariableNode*>* children) {
+    [self loadPage:page ofVariableNode:node forStackFrame:frame previousChildren:children];
+  }];
+}
+
+/**
+ * Fetches the first page of |variable|'s children, and the first page of their
+ * descendants' children down to |depth| levels, with one property_get. The
+ * max_depth feature is raised for just that command, and since commands are
+ * pipelined this takes a single round trip. |handler| receives the children,
+ * and whether the engine honored max_depth. If it did not, the children have
+ * no descendants loaded and later fetches do not try again.
+ */
+- (void)loadSubtreeOfVariableNode:(VariableNode*)variable
+                            depth:(NSUInteger)depth
+                    forStackFrame:(StackFrame*)frame
+                          handler:(void (^)(NSArray<VariableNode*>* children, BOOL depthAccepted))subtreeHandler {
+  [variable setPageRequested:0];
+
+  __block BOOL depthAccepted = NO;
+  [_client sendCommandWithFormat:@"feature_set -n max_depth -v %lu" handler:^(ProtocolResponse* message) {
+    depthAccepted = [message.attributes[@"success"] isEqualToString:@"1"];
+  }, depth];
+
+  ProtocolClientMessageHandler handler = ^(ProtocolResponse* message) {
+    VariableNode* parent = message.properties.firstObject;
+    if (!parent) {
+      [variable cancelPageRequest:0];
+      return;
+    }
+    if (!depthAccepted)
+      self->_supportsMaxDepth = NO;
+    subtreeHandler([parent childrenOfPage:0], depthAccepted);
+  };
+  ProtocolClientMessageHandler errorHandler = ^(ProtocolResponse* message) {
+    [variable cancelPageRequest:0];
+    [self protocolClient:self->_client receivedErrorMessage:message];
+  };
+  [_client sendCommandWithFormat:@"property_get -d %d -n %@"
+                         handler:handler
+                    errorHandler:errorHandler, frame.index, variable.fullName];
+  [_client sendCommandWithFormat:@"feature_set -n max_depth -v 1"];
+}
+
+/**
+ * Fetches the first page of children of each of the variables named in
+ * |fullNames|, without waiting for their parents to arrive. The requests are
+ * all in flight at once, and the children are kept until the variables are
+ * expanded.
+ */
+- (void)prefetchChildrenOfVariables:(NSArray<NSString*>*)fullNames
+                      forStackFrame:(StackFrame*)frame {
+  NSMutableDictionary<NSString*, id>* prefetched = _prefetchedChildren;
+  NSMutableDictionary<NSString*, VariableNode*>* waiters = _prefetchWaiters;
+  for (NSString* fullName in fullNames) {
+    NSString* key = PrefetchKey(fullName, frame);
+    if (prefetched[key])
+      continue;
+    prefetched[key] = [NSNull null];
+
+    // Resolves the prefetch with the variable's children, or with nil if it
+    // no longer exists.
+    void (^resolve)(NSArray<VariableNode*>*) = ^(NSArray<VariableNode*>* children) {
+      VariableNode* waiter = waiters[key];
+      if (waiter) {
+        [waiters removeObjectForKey:key];
+        [prefetched removeObjectForKey:key];
+        if (children)
+          [waiter setChildren:children forPage:0];
+        else
+          [waiter cancelPageRequest:0];
+      } else if (children) {
+        prefetched[key] = children;
+      } else {
+        [prefetched removeObjectForKey:key];
+      }
+    };
+    ProtocolClientMessageHandler handler = ^(ProtocolResponse* message) {
+      VariableNode* parent = message.properties.firstObject;
+      resolve(parent ? [parent childrenOfPage:0] : nil);
+    };
+    // The user did not ask for this, so an error is not reported. If the
+    // variable is expanded, it is fetched again and the error shown then.
+    ProtocolClientMessageHandler errorHandler = ^(ProtocolResponse* message) {
+      resolve(nil);
+    };
+    [_client sendCommandWithFormat:@"property_get -d %d -n %@"
+                           handler:handler
+                      errorHandler:errorHandler, frame.index, fullName];
+  }
+}
+
+/**
+ * If the first page of |variable|'s children was prefetched, sets it, or
+ * arranges for it to be set when it arrives. Returns NO if it was not
+ * prefetched.
+ */
+- (BOOL)takePrefetchedChildrenForVariable:(VariableNode*)variable
+                            forStackFrame:(StackFrame*)frame {
+  NSString* key = PrefetchKey(variable.fullName, frame);
+  id children = _prefetchedChildren[key];
+  if (!children)
+    return NO;
+
+  if (children == [NSNull null]) {
+    [variable setPageRequested:0];
+    _prefetchWaiters[key] = variable;
+  } else {
+    [_prefetchedChildren removeObjectForKey:key];
+    [variable setChildren:children forPage:0];
+  }
+  return YES;
+}
+
 // Private /////////////////////////////////////////////////////////////////////
 #pragma mark Private
 
@@ -26,10 +26,12 @@
 #import "FileAccessController.h"
 #import "PreferenceNames.h"
 #import "StackFrame.h"
+#import "VariableNode.h"
 
 @interface DebuggerController (Private)
 - (void)updateSourceViewer;
 - (void)expandVariables;
+- (void)expandVariablesInNodes:(NSArray<NSTreeNode*>*)nodes selection:(NSString*)selection;
 @end
 
 @implementation DebuggerController {
@@ -71,6 +73,7 @@
                 context:nil];
 
     _expandedVariables = [[NSMutableSet alloc] init];
+    _connection.expandedVariables = _expandedVariables;
     [[self window] makeKeyAndOrderFront:nil];
     [[self window] setDelegate:self];
     
@@ -287,11 +290,38 @@
   NSTreeNode* node = [[notif userInfo] objectForKey:@"NSObject"];
   [_expandedVariables addObject:[[node representedObject] fullName]];
 
+  // Fetch the children of the descendants that will be expanded again along
+  // with this node's.
   [_connection loadVariableNode:[node representedObject]
-                 forStackFrame:[[_stackArrayController selectedObjects] lastObject]];
+                  forStackFrame:[[_stackArrayController selectedObjects] lastObject]
+            expandedDescendants:_expandedVariables];
   [self expandVariables];
 }
 
+/**
+ * Called before a row is drawn. Variables that changed since the last step are
+ * drawn in red. If the row is a placeholder for a child that has not been
+ * fetched, this fetches the page that contains it, so that only the pages that
+ * are scrolled into view are loaded.
+ */
+- (void)outlineView:(NSOutlineView*)outlineView
+    willDisplayCell:(id)cell
+     forTableColumn:(NSTableColumn*)tableColumn
+               item:(id)item
+{
+  VariableNode* variable = [item representedObject];
+  if ([cell respondsToSelector:@selector(setTextColor:)])
+    [cell setTextColor:variable.changed ? [NSColor redColor] : [NSColor controlTextColor]];
+
+  if (!variable.isPlaceholder)
+    return;
+
+  VariableNode* parent = variable.parent;
+  [_connection loadPage:[parent pageForChildAtIndex:variable.indexInParent]
+         ofVariableNode:parent
+          forStackFrame:[[_stackArrayController selectedObjects] lastObject]];
+}
+
 /**
  * Called when an item was collapsed. This allows us to remove it from the list of expanded items
  */
@@ -323,7 +353,9 @@
 
   if (![_sourceViewer.file isEqualToString:filename]) {
     // Replace the source if necessary.
-    if (frame.source) {
+    if (frame.localFile) {
+      [_sourceViewer setLocalFile:frame.localFile asFile:filename];
+    } else if (frame.source) {
       [_sourceViewer setString:frame.source asFile:filename];
     } else {
       [_sourceViewer setFile:filename];
@@ -342,19 +374,34 @@
  */
 - (void)expandVariables
 {
-  NSString* selection = [_selectedVariable fullName];
+  if (_expandedVariables.count == 0 && !_selectedVariable)
+    return;
+  [self expandVariablesInNodes:[[_variablesTreeController arrangedObjects] childNodes]
+                     selection:[_selectedVariable fullName]];
+}
 
-  for (NSInteger i = 0; i < [_variablesOutlineView numberOfRows]; i++) {
-    NSTreeNode* node = [_variablesOutlineView itemAtRow:i];
+/**
+ * Expands those of |nodes| that were expanded before, and selects the one that
+ * was selected. Only the children of expanded nodes are visited, so this does
+ * not walk the parts of the tree that are collapsed.
+ */
+- (void)expandVariablesInNodes:(NSArray<NSTreeNode*>*)nodes selection:(NSString*)selection
+{
+  for (NSTreeNode* node in nodes) {
     NSString* fullName = [[node representedObject] fullName];
-    
-    // see if it needs expanding
-    if ([_expandedVariables containsObject:fullName])
-      [_variablesOutlineView expandItem:node];
-    
+    if (!fullName)
+      continue;
+
     // select it if we had it selected before
     if ([fullName isEqualToString:selection])
       [_variablesTreeController setSelectionIndexPath:[node indexPath]];
+
+    // see if it needs expanding
+    if ([_expandedVariables containsObject:fullName]) {
+      if (![_variablesOutlineView isItemExpanded:node])
+        [_variablesOutlineView expandItem:node];
+      [self expandVariablesInNodes:[node childNodes] selection:selection];
+    }
   }
 }
 
@@ -0,0 +1,53 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Foundation/Foundation.h>
+
+// LocalSourceFile is a read-only snapshot of a source file on the local disk.
+// The file is memory-mapped and decoded as soon as it is read, so the mapping
+// is released before the file can be changed underneath it.
+@interface LocalSourceFile : NSObject
+
+// The path of the file on the local disk.
+@property(readonly, nonatomic) NSString* path;
+
+// The contents of the file, decoded as UTF-8, or as ISO Latin 1 if the file is
+// not valid UTF-8.
+@property(readonly, nonatomic) NSString* string;
+
+// The modification date and size of the file when it was read.
+@property(readonly, nonatomic) NSDate* modificationDate;
+@property(readonly, nonatomic) unsigned long long size;
+
+// Reads the file at |path|. Returns nil and sets |error| if the file cannot be
+// read.
++ (instancetype)fileAtPath:(NSString*)path error:(NSError**)error;
+
+// Reads the local copy of the file that the debugger engine refers to by
+// |fileURI|, if one exists. The path is resolved through the path replacements
+// preference.
++ (instancetype)fileForRemoteURI:(NSString*)fileURI;
+
+// Returns the local path for the remote |fileURI| by applying the remote to
+// local path |replacements|, which are dictionaries with "remote" and "local"
+// keys. Returns nil if |fileURI| is not a file URI.
++ (NSString*)localPathForRemoteURI:(NSString*)fileURI replacements:(NSArray<NSDictionary*>*)replacements;
+
+// Returns whether the file on disk no longer has the modification date and
+// size that it had when it was read, including if it has been removed.
+- (BOOL)isModified;
+
+@end
@@ -0,0 +1,96 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "LocalSourceFile.h"
+
+#import "PreferenceNames.h"
+
+@implementation LocalSourceFile
+
++ (instancetype)fileAtPath:(NSString*)path error:(NSError**)error {
+  // The attributes are read first, so that a change made while the file is
+  // being read shows up as a modification.
+  NSDictionary* attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:error];
+  if (!attributes)
+    return nil;
+
+  NSData* data = [NSData dataWithContentsOfFile:path
+                                        options:NSDataReadingMappedAlways
+                                          error:error];
+  if (!data)
+    return nil;
+
+  NSString* string = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+  if (!string)
+    string = [[NSString alloc] initWithData:data encoding:NSISOLatin1StringEncoding];
+
+  return [[self alloc] initWithPath:path
+                             string:string
+                   modificationDate:[attributes fileModificationDate]
+                               size:[attributes fileSize]];
+}
+
++ (instancetype)fileForRemoteURI:(NSString*)fileURI {
+  NSArray* replacements =
+      [[NSUserDefaults standardUserDefaults] arrayForKey:kPrefPathReplacements];
+  NSString* path = [self localPathForRemoteURI:fileURI replacements:replacements];
+  if (!path)
+    return nil;
+
+  BOOL isDirectory = NO;
+  if (![[NSFileManager defaultManager] fileExistsAtPath:path isDirectory:&isDirectory] || isDirectory)
+    return nil;
+
+  return [self fileAtPath:path error:NULL];
+}
+
++ (NSString*)localPathForRemoteURI:(NSString*)fileURI replacements:(NSArray<NSDictionary*>*)replacements {
+  NSURL* url = [NSURL URLWithString:fileURI];
+  if (![url isFileURL])
+    return nil;
+
+  NSString* path = [url path];
+  for (NSDictionary* replacement in replacements) {
+    NSString* remote = [replacement valueForKey:@"remote"];
+    NSString* local = [replacement valueForKey:@"local"];
+    if ([remote length] && local) {
+      path = [path stringByReplacingOccurrencesOfString:remote withString:local];
+    }
+  }
+  return path;
+}
+
+- (instancetype)initWithPath:(NSString*)path
+                      string:(NSString*)string
+            modificationDate:(NSDate*)modificationDate
+                        size:(unsigned long long)size {
+  if ((self = [super init])) {
+    _path = [path copy];
+    _string = string;
+    _modificationDate = modificationDate;
+    _size = size;
+  }
+  return self;
+}
+
+- (BOOL)isModified {
+  NSDictionary* attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:_path error:NULL];
+  return !attributes ||
+      ![[attributes fileModificationDate] isEqualToDate:_modificationDate] ||
+      [attributes fileSize] != _size;
+}
+
+@end
@@ -18,26 +18,79 @@
 
 @class LogEntry;
 
+// How much of each message is recorded in the log.
+typedef enum _LogCaptureLevel {
+  kLogCaptureOff = 0,
+  kLogCaptureHeaders,  // The command, or the opening tag of the response.
+  kLogCaptureFull
+} LogCaptureLevel;
+
 // The LoggingController manages the communication log with the debugger engine.
 // Whenever a command or a response received, the NetworkConnection notifies
-// this class to record the relevant information.
+// this class to record the relevant information. The log is bounded: it holds
+// at most |capacity| entries and |byteBudget| bytes of message contents, and
+// the oldest entries are discarded to make room for new ones. Nothing is
+// captured while the log window is closed.
 @interface LoggingController : NSWindowController
 {
-  // An array of log entries, with object at index 0 being the oldest entry.
-  NSMutableArray* logEntries_;
+  // A ring buffer of |capacity_| log entries, of which |count_| starting at
+  // |firstEntry_| are in use. Unused slots are NULL.
+  NSPointerArray* entries_;
+  NSUInteger capacity_;
+  NSUInteger firstEntry_;
+  NSUInteger count_;
+
+  // The number of bytes of message contents held, and the most that will be
+  // held before the oldest entries are discarded.
+  NSUInteger byteCount_;
+  NSUInteger byteBudget_;
+
+  // Whether the UI will be updated at the end of the current run loop pass.
+  BOOL updatePending_;
+
+  // The configured capture level, and whether the log window is visible.
+  LogCaptureLevel captureLevel_;
+  BOOL windowVisible_;
 
   // The array controller.
   IBOutlet NSArrayController* logEntriesController_;
 }
+// The log entries, with object at index 0 being the oldest entry.
 @property (readonly) NSArray* logEntries;
 
-// Designated initializer.
+// The maximum number of entries held.
+@property (readonly) NSUInteger capacity;
+
+// The number of bytes of message contents held, and the most that will be held.
+// Lowering the budget discards entries immediately. The newest entry is always
+// kept, even if it alone exceeds the budget.
+@property (readonly) NSUInteger byteCount;
+@property (assign, nonatomic) NSUInteger byteBudget;
+
+// The level at which messages are captured while the log window is visible.
+// This follows the user default, which is set in the Preferences window.
+@property (assign, nonatomic) LogCaptureLevel captureLevel;
+
+// The level at which messages should be captured right now, which is off while
+// the log window is closed. This may be read from any thread, without locking,
+// so that clients can avoid creating entries that would not be kept.
+@property (readonly) LogCaptureLevel activeCaptureLevel;
+
+// Creates a log with the default capacity and byte budget.
 - (id)init;
 
-// Records a log entry. This will add it to the list and will update the UI.
-// This will take ownership of |entry|.
+// Designated initializer.
+- (id)initWithCapacity:(NSUInteger)capacity byteBudget:(NSUInteger)byteBudget;
+
+// Records a log entry. This will add it to the list and will update the UI
+// once the current run loop pass completes. This will take ownership of
+// |entry|, and at kLogCaptureHeaders it will discard the body of the message.
+// Entries must be recorded on the main thread, which is the log's only writer.
 - (void)recordEntry:(LogEntry*)entry;
 
+// Discards all the entries. This happens when the log window is closed.
+- (void)removeAllEntries;
+
 @end
 
 // Log Entry ///////////////////////////////////////////////////////////////////
@@ -47,27 +100,36 @@ typedef enum _LogEntryDirection {
   kLogEntryReceiving
 } LogEntryDirection;
 
-// A simple class that stores information for a single log entry.
+// A simple class that stores information for a single log entry. The message
+// is held as the raw bytes that were sent or received, and it is converted to
+// a string only when it is displayed.
 @interface LogEntry : NSObject
 {
   // The direction this communication went.
   LogEntryDirection direction_;
   
-  // The command that was sent or the response.
-  NSString* contents_;
+  // The UTF-8 bytes of the command that was sent or the response.
+  NSData* data_;
 
   // The values of the last read and written transaction IDs.
   NSUInteger lastWrittenTransactionID_;
   NSUInteger lastReadTransactionID_;
 }
 @property (assign) LogEntryDirection direction;
-@property (copy) NSString* contents;
+@property (copy) NSData* data;
 @property (assign) NSUInteger lastWrittenTransactionID;
 @property (assign) NSUInteger lastReadTransactionID;
 
+// The message, decoded from |data| each time it is requested.
+@property (copy) NSString* contents;
+
+// The start of the first line of the message, for display in a table row.
+@property (readonly) NSString* summary;
+
 - (NSString*)directionName;
 
 + (LogEntry*)newSendEntry:(NSString*)command;
 + (LogEntry*)newReceiveEntry:(NSString*)command;
++ (LogEntry*)newReceiveEntryWithData:(NSData*)data;
 
 @end
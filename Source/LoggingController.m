@@ -16,34 +16,295 @@
 
 #import "LoggingController.h"
 
+#include <stdatomic.h>
+
+#import "PreferenceNames.h"
+
+// The default number of entries held by the log.
+static const NSUInteger kDefaultCapacity = 10000;
+
+// The default number of bytes of message contents held by the log.
+static const NSUInteger kDefaultByteBudget = 32 * 1024 * 1024;
+
+// The number of bytes of a message shown in a LogEntry's summary.
+static const NSUInteger kSummaryLength = 256;
+
+// The most bytes of a message kept at kLogCaptureHeaders.
+static const NSUInteger kMaxHeaderLength = 512;
+
+// The KVO context for the capture level user default.
+static void* kCaptureLevelContext = &kCaptureLevelContext;
+
+// Returns the part of |data| that identifies the message: a command without
+// its base64 data argument, or a response up to the end of the opening tag of
+// its root element.
+static NSData* MessageHeader(NSData* data, LogEntryDirection direction)
+{
+  const char* bytes = data.bytes;
+  const char* end = bytes + MIN(data.length, kMaxHeaderLength);
+  const char* headerEnd = end;
+  if (direction == kLogEntrySending)
+  {
+    const char* dataArgument = memmem(bytes, end - bytes, " -- ", 4);
+    if (dataArgument)
+      headerEnd = dataArgument;
+  }
+  else
+  {
+    // Skip past the XML declaration to the root element.
+    const char* tag = memchr(bytes, '<', end - bytes);
+    if (tag && tag + 1 < end && tag[1] == '?')
+    {
+      const char* declarationEnd = memmem(tag, end - tag, "?>", 2);
+      tag = declarationEnd ? memchr(declarationEnd, '<', end - declarationEnd) : NULL;
+    }
+    const char* tagEnd = tag ? memchr(tag, '>', end - tag) : NULL;
+    if (tagEnd)
+      headerEnd = tagEnd + 1;
+  }
+
+  if (headerEnd == bytes + data.length)
+    return data;
+  return [data subdataWithRange:NSMakeRange(0, headerEnd - bytes)];
+}
+
+@interface LoggingController (Private)
+- (void)removeOldestEntry;
+- (void)trimToByteBudget;
+- (void)scheduleUpdate;
+- (void)updateEntries;
+- (void)updateActiveCaptureLevel;
+- (void)windowWillClose:(NSNotification*)notification;
+@end
 
 @implementation LoggingController
+{
+  // The value of |activeCaptureLevel|, which is written on the main thread and
+  // read from any thread.
+  atomic_int activeCaptureLevel_;
+}
 
-@synthesize logEntries = logEntries_;
+@synthesize capacity = capacity_;
+@synthesize byteCount = byteCount_;
+@synthesize byteBudget = byteBudget_;
+@synthesize captureLevel = captureLevel_;
 
 - (id)init
+{
+  return [self initWithCapacity:kDefaultCapacity byteBudget:kDefaultByteBudget];
+}
+
+- (id)initWithCapacity:(NSUInteger)capacity byteBudget:(NSUInteger)byteBudget
 {
   if (self = [self initWithWindowNibName:@"Log"])
   {
-    logEntries_ = [NSMutableArray new];
+    capacity_ = capacity ? capacity : 1;
+    byteBudget_ = byteBudget;
+    entries_ = [NSPointerArray strongObjectsPointerArray];
+    entries_.count = capacity_;
+    captureLevel_ = [[NSUserDefaults standardUserDefaults] integerForKey:kPrefLogCaptureLevel];
+    atomic_init(&activeCaptureLevel_, kLogCaptureOff);
+
+    // Follow the setting in the Preferences window.
+    [[NSUserDefaultsController sharedUserDefaultsController]
+        addObserver:self
+         forKeyPath:[@"values." stringByAppendingString:kPrefLogCaptureLevel]
+            options:0
+            context:kCaptureLevelContext];
   }
   return self;
 }
 
+- (void)dealloc
+{
+  [[NSUserDefaultsController sharedUserDefaultsController]
+      removeObserver:self
+          forKeyPath:[@"values." stringByAppendingString:kPrefLogCaptureLevel]
+             context:kCaptureLevelContext];
+  [[NSNotificationCenter defaultCenter] removeObserver:self];
+  [NSObject cancelPreviousPerformRequestsWithTarget:self];
+}
+
+- (void)windowDidLoad
+{
+  [super windowDidLoad];
+  [[NSNotificationCenter defaultCenter] addObserver:self
+                                           selector:@selector(windowWillClose:)
+                                               name:NSWindowWillCloseNotification
+                                             object:self.window];
+}
+
+- (void)showWindow:(id)sender
+{
+  [super showWindow:sender];
+  windowVisible_ = YES;
+  [self updateActiveCaptureLevel];
+}
+
+- (void)observeValueForKeyPath:(NSString*)keyPath
+                      ofObject:(id)object
+                        change:(NSDictionary*)change
+                       context:(void*)context
+{
+  if (context == kCaptureLevelContext)
+    self.captureLevel = [[NSUserDefaults standardUserDefaults] integerForKey:kPrefLogCaptureLevel];
+  else
+    [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+}
+
+- (void)setCaptureLevel:(LogCaptureLevel)captureLevel
+{
+  captureLevel_ = captureLevel;
+  if (captureLevel_ == kLogCaptureOff)
+    [self removeAllEntries];
+  [self updateActiveCaptureLevel];
+}
+
+- (LogCaptureLevel)activeCaptureLevel
+{
+  return atomic_load_explicit(&activeCaptureLevel_, memory_order_relaxed);
+}
+
+- (NSArray*)logEntries
+{
+  NSMutableArray* entries = [NSMutableArray arrayWithCapacity:count_];
+  for (NSUInteger i = 0; i < count_; ++i)
+    [entries addObject:(__bridge LogEntry*)[entries_ pointerAtIndex:(firstEntry_ + i) % capacity_]];
+  return entries;
+}
+
+- (void)setByteBudget:(NSUInteger)byteBudget
+{
+  byteBudget_ = byteBudget;
+  [self trimToByteBudget];
+  [self scheduleUpdate];
+}
+
 - (void)recordEntry:(LogEntry*)entry
 {
-  [logEntries_ addObject:entry];
-  [logEntriesController_ rearrangeObjects];  
+  if (captureLevel_ == kLogCaptureOff)
+    return;
+  if (captureLevel_ == kLogCaptureHeaders)
+    entry.data = MessageHeader(entry.data, entry.direction);
+
+  if (count_ == capacity_)
+    [self removeOldestEntry];
+
+  [entries_ replacePointerAtIndex:(firstEntry_ + count_) % capacity_
+                      withPointer:(__bridge void*)entry];
+  ++count_;
+  byteCount_ += entry.data.length;
+
+  [self trimToByteBudget];
+  [self scheduleUpdate];
+}
+
+- (void)removeAllEntries
+{
+  while (count_)
+    [self removeOldestEntry];
+  firstEntry_ = 0;
+  [self scheduleUpdate];
+}
+
+@end
+
+// Private /////////////////////////////////////////////////////////////////////
+
+@implementation LoggingController (Private)
+
+/**
+ * Releases the entry at the head of the ring buffer.
+ */
+- (void)removeOldestEntry
+{
+  LogEntry* entry = (__bridge LogEntry*)[entries_ pointerAtIndex:firstEntry_];
+  byteCount_ -= entry.data.length;
+  [entries_ replacePointerAtIndex:firstEntry_ withPointer:NULL];
+  firstEntry_ = (firstEntry_ + 1) % capacity_;
+  --count_;
+}
+
+/**
+ * Discards the oldest entries until the log fits in its byte budget, keeping
+ * at least the newest entry.
+ */
+- (void)trimToByteBudget
+{
+  while (byteCount_ > byteBudget_ && count_ > 1)
+    [self removeOldestEntry];
+}
+
+/**
+ * Arranges for the UI to be updated once the current run loop pass completes,
+ * so that a burst of entries costs a single update.
+ */
+- (void)scheduleUpdate
+{
+  if (updatePending_)
+    return;
+  updatePending_ = YES;
+  [self performSelector:@selector(updateEntries)
+             withObject:nil
+             afterDelay:0
+                inModes:@[ NSRunLoopCommonModes ]];
+}
+
+/**
+ * Notifies observers of |logEntries|, which causes the array controller to
+ * fetch and rearrange the new contents.
+ */
+- (void)updateEntries
+{
+  updatePending_ = NO;
+  [self willChangeValueForKey:@"logEntries"];
+  [self didChangeValueForKey:@"logEntries"];
+}
+
+/**
+ * Captures messages only while the log window is visible, so that a session
+ * with the log closed does not pay to record it.
+ */
+- (void)updateActiveCaptureLevel
+{
+  LogCaptureLevel level = windowVisible_ ? captureLevel_ : kLogCaptureOff;
+  atomic_store_explicit(&activeCaptureLevel_, level, memory_order_relaxed);
+}
+
+/**
+ * Stops capturing and releases the log when the window is closed.
+ */
+- (void)windowWillClose:(NSNotification*)notification
+{
+  windowVisible_ = NO;
+  [self updateActiveCaptureLevel];
+  [self removeAllEntries];
 }
 
 @end
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Decodes the first |length| bytes of |data|. Messages that are not valid UTF-8
+// are shown as Latin-1 rather than not at all.
+static NSString* DecodeBytes(NSData* data, NSUInteger length)
+{
+  NSString* string = [[NSString alloc] initWithBytes:data.bytes
+                                              length:length
+                                            encoding:NSUTF8StringEncoding];
+  if (!string)
+  {
+    string = [[NSString alloc] initWithBytes:data.bytes
+                                      length:length
+                                    encoding:NSISOLatin1StringEncoding];
+  }
+  return string;
+}
+
 @implementation LogEntry
 
 @synthesize direction = direction_;
-@synthesize contents = contents_;
+@synthesize data = data_;
 @synthesize lastWrittenTransactionID = lastWrittenTransactionID_;
 @synthesize lastReadTransactionID = lastReadTransactionID_;
 
@@ -63,10 +324,59 @@
   return entry;
 }
 
++ (LogEntry*)newReceiveEntryWithData:(NSData*)data
+{
+  LogEntry* entry = [LogEntry new];
+  entry.direction = kLogEntryReceiving;
+  entry.data      = data;
+  return entry;
+}
+
++ (NSSet*)keyPathsForValuesAffectingContents
+{
+  return [NSSet setWithObject:@"data"];
+}
+
++ (NSSet*)keyPathsForValuesAffectingSummary
+{
+  return [NSSet setWithObject:@"data"];
+}
+
+- (NSString*)contents
+{
+  if (!data_)
+    return nil;
+  return DecodeBytes(data_, data_.length);
+}
+
+- (void)setContents:(NSString*)contents
+{
+  self.data = [contents dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+- (NSString*)summary
+{
+  if (!data_)
+    return nil;
+
+  // Do not split a multi-byte UTF-8 sequence.
+  const uint8_t* bytes = data_.bytes;
+  NSUInteger length = data_.length;
+  if (length > kSummaryLength)
+  {
+    length = kSummaryLength;
+    while (length > 0 && (bytes[length] & 0xC0) == 0x80)
+      --length;
+  }
+
+  NSString* summary = DecodeBytes(data_, length);
+  return [[summary componentsSeparatedByCharactersInSet:[NSCharacterSet newlineCharacterSet]]
+      componentsJoinedByString:@" "];
+}
+
 - (NSString*)directionName
 {
   return (direction_ == kLogEntryReceiving ? @"Recv" : @"Send");
 }
 
 @end
-
@@ -0,0 +1,47 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Foundation/Foundation.h>
+
+// MessageFrameReader splits a DBGp byte stream into messages. Each packet on
+// the wire is an ASCII decimal length, a NUL byte, that many bytes of message
+// data, and a terminating NUL byte.
+//
+// Bytes are read directly into a single growable buffer. Once a length header
+// has been parsed, the buffer is sized to hold the entire message, so that the
+// remainder of the message can be read without further copies. Large messages
+// are handed out as an NSData that takes ownership of that buffer.
+//
+// This class is not thread-safe.
+@interface MessageFrameReader : NSObject
+
+// Reads available bytes from |fd| into the buffer. Returns the result of the
+// read(2) call, so 0 indicates end-of-file and -1 an error.
+- (ssize_t)readFromFileDescriptor:(int)fd;
+
+// Copies |length| bytes into the buffer, for when the stream does not come
+// from a file descriptor.
+- (void)appendBytes:(const void*)bytes length:(NSUInteger)length;
+
+// Whether bytes of a message that is not yet complete have been read.
+- (BOOL)hasPartialMessage;
+
+// Returns the next complete message, or nil if more bytes are needed. A single
+// read can complete several messages, so this should be called until it
+// returns nil.
+- (NSData*)nextMessage;
+
+@end
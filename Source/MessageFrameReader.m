@@ -0,0 +1,185 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "MessageFrameReader.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// The minimum amount of free space offered to each read when waiting for a
+// length header. Messages smaller than this are copied out of the buffer
+// rather than taking ownership of it.
+static const size_t kMinimumReadSize = 16 * 1024;
+
+// The buffer is released once it is empty and has grown beyond this size.
+static const size_t kMaximumIdleCapacity = 4 * kMinimumReadSize;
+
+// Sentinel for |_messageLength| when no header has been parsed.
+static const size_t kNoMessage = SIZE_MAX;
+
+@implementation MessageFrameReader {
+  // The buffer into which bytes are read. Bytes in the range [_start, _end)
+  // have been read but not yet consumed.
+  uint8_t* _buffer;
+  size_t _capacity;
+  size_t _start;
+  size_t _end;
+
+  // The length of the message being read, as parsed from its header. When a
+  // message is being read, its first byte is at the start of |_buffer|.
+  size_t _messageLength;
+}
+
+- (instancetype)init {
+  if ((self = [super init])) {
+    _messageLength = kNoMessage;
+  }
+  return self;
+}
+
+- (void)dealloc {
+  free(_buffer);
+}
+
+- (ssize_t)readFromFileDescriptor:(int)fd {
+  [self reserveSpace];
+  ssize_t bytesRead = read(fd, _buffer + _end, _capacity - _end);
+  if (bytesRead > 0)
+    _end += bytesRead;
+  return bytesRead;
+}
+
+- (void)appendBytes:(const void*)bytes length:(NSUInteger)length {
+  const uint8_t* source = bytes;
+  while (length > 0) {
+    [self reserveSpace];
+    size_t count = MIN(length, _capacity - _end);
+    memcpy(_buffer + _end, source, count);
+    _end += count;
+    source += count;
+    length -= count;
+  }
+}
+
+- (BOOL)hasPartialMessage {
+  return _messageLength != kNoMessage || _start != _end;
+}
+
+- (NSData*)nextMessage {
+  if (_messageLength == kNoMessage && ![self parseHeader])
+    return nil;
+
+  // The message is complete once its data and terminator have been read.
+  const size_t packetLength = _messageLength + 1;
+  if (_end - _start < packetLength)
+    return nil;
+
+  if (_buffer[_start + _messageLength] != '\0')
+    NSLog(@"Message of length %zu is not NUL-terminated", _messageLength);
+
+  NSData* message;
+  if (_start == 0 && _end == packetLength && _messageLength >= kMinimumReadSize) {
+    // The buffer holds exactly this message, so give it away rather than
+    // copying it.
+    message = [[NSData alloc] initWithBytesNoCopy:_buffer
+                                           length:_messageLength
+                                     freeWhenDone:YES];
+    _buffer = NULL;
+    _capacity = 0;
+    _start = 0;
+    _end = 0;
+  } else {
+    message = [[NSData alloc] initWithBytes:_buffer + _start length:_messageLength];
+    _start += packetLength;
+    if (_start == _end) {
+      _start = 0;
+      _end = 0;
+      if (_capacity > kMaximumIdleCapacity) {
+        free(_buffer);
+        _buffer = NULL;
+        _capacity = 0;
+      }
+    }
+  }
+
+  _messageLength = kNoMessage;
+  return message;
+}
+
+// Private /////////////////////////////////////////////////////////////////////
+
+// Ensures that there is free space at the end of the buffer for another read.
+- (void)reserveSpace {
+  if (_end < _capacity)
+    return;
+
+  // Reclaim the space of already-consumed bytes.
+  if (_start > 0) {
+    memmove(_buffer, _buffer + _start, _end - _start);
+    _end -= _start;
+    _start = 0;
+    if (_end < _capacity)
+      return;
+  }
+
+  [self growToCapacity:MAX(kMinimumReadSize, _capacity * 2)];
+}
+
+// Reallocates the buffer to hold at least |capacity| bytes.
+- (void)growToCapacity:(size_t)capacity {
+  if (capacity <= _capacity)
+    return;
+  uint8_t* buffer = realloc(_buffer, capacity);
+  if (!buffer)
+    [NSException raise:NSMallocException format:@"Could not allocate %zu bytes", capacity];
+  _buffer = buffer;
+  _capacity = capacity;
+}
+
+// Attempts to read the length header at |_start|. If one is found, the
+// partially read message is moved to the front of the buffer, which is then
+// sized to hold the complete packet.
+- (BOOL)parseHeader {
+  if (_start == _end)
+    return NO;
+
+  const uint8_t* header = _buffer + _start;
+  const uint8_t* separator = memchr(header, '\0', _end - _start);
+  if (!separator)
+    return NO;
+
+  size_t length = 0;
+  for (const uint8_t* digit = header; digit < separator; ++digit) {
+    if (*digit < '0' || *digit > '9') {
+      NSLog(@"Invalid character in message length header: 0x%02x", *digit);
+      continue;
+    }
+    length = length * 10 + (*digit - '0');
+  }
+
+  _start = separator - _buffer + 1;
+  _messageLength = length;
+
+  const size_t bytesRead = _end - _start;
+  memmove(_buffer, _buffer + _start, bytesRead);
+  _start = 0;
+  _end = bytesRead;
+  [self growToCapacity:MAX(length + 1, bytesRead)];
+  return YES;
+}
+
+@end
@@ -24,6 +24,7 @@
 // program with which it exchanges UTF8 string messages. A message contains two
 // parts, both terminated by '\0'. The first is an ASCII integer number that is
 // the length of the second part. The second part is the actual string message.
+// Received messages are delivered as the raw bytes of the second part.
 @interface MessageQueue : NSObject
 
 // Creates a new MessasgeQueue that will listen on |port| and report information
@@ -43,6 +44,10 @@
 // thread.
 - (void)sendMessage:(NSString*)message;
 
+// Queues |block| to be called with the delegate on the delegate's thread, in
+// order with the delegate messages. This may be called from any thread.
+- (void)invokeDelegateBlock:(void (^)(id<MessageQueueDelegate> delegate))block;
+
 @end
 
 // Delegate ////////////////////////////////////////////////////////////////////
@@ -62,6 +67,11 @@
 // Callback for when a message has been sent.
 - (void)messageQueue:(MessageQueue*)queue didSendMessage:(NSString*)message;
 
-// Callback with the message content when one has been receieved.
-- (void)messageQueue:(MessageQueue*)queue didReceiveMessage:(NSString*)message;
+// Callback with the message content when one has been receieved. The times at
+// which its first and last bytes were read are given as the system uptime,
+// since the callback may be delivered some time later.
+- (void)messageQueue:(MessageQueue*)queue
+   didReceiveMessage:(NSData*)message
+       firstByteTime:(NSTimeInterval)firstByteTime
+        lastByteTime:(NSTimeInterval)lastByteTime;
 @end
@@ -24,6 +24,7 @@
 #include <unistd.h>
 
 #import "BSProtocolThreadInvoker.h"
+#import "MessageFrameReader.h"
 
 @implementation MessageQueue {
   // The port number on which to open a listening socket.
@@ -55,11 +56,12 @@
   // Whether |_writeSource| has been suspended through |-dequeueAndSend|.
   BOOL _writeSuspended;
 
-  // When a message is being read, this temporary buffer is used to build up
-  // the complete message from successive reads.
-  NSMutableString* _message;
-  NSUInteger _totalMessageSize;
-  NSUInteger _messageSize;
+  // Assembles messages from the bytes read from a connected |_socket|.
+  MessageFrameReader* _reader;
+
+  // The system uptime at which the first byte of the message that |_reader| is
+  // assembling was read, or 0 if it has not begun one.
+  NSTimeInterval _messageStartTime;
 }
 
 - (id)initWithPort:(NSUInteger)port delegate:(id<MessageQueueDelegate>)delegate {
@@ -73,6 +75,9 @@
         [[BSProtocolThreadInvoker alloc] initWithObject:delegate
                                          protocol:@protocol(MessageQueueDelegate)
                                            thread:[NSThread currentThread]];
+    // A burst of responses, such as those to a stack_get per frame, is
+    // delivered in one pass of the delegate's run loop.
+    _delegate.batchesMessages = YES;
     _socket = -1;
   }
   return self;
@@ -108,6 +113,10 @@
   });
 }
 
+- (void)invokeDelegateBlock:(void (^)(id<MessageQueueDelegate> delegate))block {
+  [_delegate invokeBlock:block];
+}
+
 // Private /////////////////////////////////////////////////////////////////////
 
 - (void)openListeningSocket {
@@ -180,6 +189,7 @@
   }
 
   [_messageQueue removeAllObjects];
+  _reader = nil;
 
   _connected = NO;
   [_delegate messageQueueDidDisconnect:self];
@@ -243,56 +253,40 @@
     totalWritten += bytesWritten;
   }
 
-  [_delegate messageQueue:self didSendMessage:message];
+  [_delegate invokeBlock:^(id<MessageQueueDelegate> delegate) {
+    [delegate messageQueue:self didSendMessage:message];
+  }];
 
   free(buffer);
 }
 
-// Reads bytes out of the read stream. This may be called multiple times if the
-// message cannot be read in one pass.
+// Reads bytes out of the read stream and delivers any messages that were
+// completed by the read. A message may span multiple calls.
 - (void)readMessageFromStream {
-  const NSUInteger kBufferSize = 1024;
-  char buffer[kBufferSize];
-  ssize_t bufferOffset = 0;  // Starting point in |buffer| to work with.
-  ssize_t bytesRead = read(_socket, buffer, kBufferSize);
+  ssize_t bytesRead = [_reader readFromFileDescriptor:_socket];
   if (bytesRead == 0) {
     [self disconnectClient];
     return;
+  } else if (bytesRead < 0) {
+    NSLog(@"Failed to read from stream: %d, %s", errno, strerror(errno));
+    return;
   }
 
-  // The read loop works by going through the buffer until all the bytes have
-  // been processed.
-  while (bufferOffset < bytesRead) {
-    // Find the NUL separator, or the end of the string.
-    NSUInteger partLength = 0;
-    for (ssize_t i = bufferOffset; i < bytesRead && buffer[i] != '\0'; ++i, ++partLength) ;
-
-    // If there is not a current packet, set some state.
-    if (!_message) {
-      // Read the message header: the size.  This will be |partLength| bytes.
-      _totalMessageSize = atoi(buffer + bufferOffset);
-      _messageSize = 0;
-      _message = [[NSMutableString alloc] initWithCapacity:_totalMessageSize];
-      bufferOffset += partLength + 1;  // Pass over the NUL byte.
-      continue;  // Spin the loop to begin reading actual data.
-    }
-
-    // Substring the byte stream and append it to the packet string.
-    NSString* bufferString = [[NSString alloc] initWithBytesNoCopy:buffer + bufferOffset
-                                                            length:partLength
-                                                          encoding:NSUTF8StringEncoding
-                                                      freeWhenDone:NO];
-    [_message appendString:bufferString];
-
-    // Advance counters.
-    _messageSize += partLength;
-    bufferOffset += partLength + 1;
-
-    // If this read finished the packet, handle it and reset.
-    if (_messageSize >= _totalMessageSize) {
-      [_delegate messageQueue:self didReceiveMessage:_message];
-      _message = nil;
-    }
+  NSTimeInterval now = [[NSProcessInfo processInfo] systemUptime];
+  if (!_messageStartTime)
+    _messageStartTime = now;
+
+  NSData* message;
+  while ((message = [_reader nextMessage])) {
+    NSTimeInterval firstByteTime = _messageStartTime;
+    [_delegate invokeBlock:^(id<MessageQueueDelegate> delegate) {
+      [delegate messageQueue:self
+           didReceiveMessage:message
+               firstByteTime:firstByteTime
+                lastByteTime:now];
+    }];
+    // Any bytes left over are the start of the next message.
+    _messageStartTime = [_reader hasPartialMessage] ? now : 0;
   }
 }
 
@@ -320,6 +314,8 @@
   });
 
   _socket = connection;
+  _reader = [[MessageFrameReader alloc] init];
+  _messageStartTime = 0;
 
   dispatch_resume(_readSource);
   dispatch_resume(_writeSource);
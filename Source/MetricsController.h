@@ -0,0 +1,36 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Cocoa/Cocoa.h>
+
+@class DebuggerBackEnd;
+@class ProtocolMetrics;
+
+// MetricsController shows the slowest transactions of a DebuggerBackEnd as they
+// complete, to find the commands that make stepping slow. Like the connection
+// log, metrics are only collected while its window is open, and they are
+// discarded when it is closed.
+@interface MetricsController : NSWindowController
+
+// The metrics that the back end records into while the window is open.
+@property(readonly, nonatomic) ProtocolMetrics* metrics;
+
+- (instancetype)initWithBackEnd:(DebuggerBackEnd*)backEnd;
+
+// Discards the metrics collected so far.
+- (IBAction)resetMetrics:(id)sender;
+
+@end
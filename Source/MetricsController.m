@@ -0,0 +1,63 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "MetricsController.h"
+
+#import "DebuggerBackEnd.h"
+#import "ProtocolMetrics.h"
+
+@implementation MetricsController {
+  DebuggerBackEnd* _backEnd;
+}
+
+- (instancetype)initWithBackEnd:(DebuggerBackEnd*)backEnd {
+  if ((self = [super initWithWindowNibName:@"Metrics"])) {
+    _backEnd = backEnd;
+    _metrics = [[ProtocolMetrics alloc] init];
+  }
+  return self;
+}
+
+- (void)dealloc {
+  [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+- (void)windowDidLoad {
+  [super windowDidLoad];
+  [[NSNotificationCenter defaultCenter] addObserver:self
+                                           selector:@selector(windowWillClose:)
+                                               name:NSWindowWillCloseNotification
+                                             object:self.window];
+}
+
+- (void)showWindow:(id)sender {
+  [super showWindow:sender];
+  _backEnd.metrics = _metrics;
+}
+
+- (IBAction)resetMetrics:(id)sender {
+  [_metrics reset];
+}
+
+/**
+ * Stops collecting metrics once the window is closed.
+ */
+- (void)windowWillClose:(NSNotification*)notification {
+  _backEnd.metrics = nil;
+  [_metrics reset];
+}
+
+@end
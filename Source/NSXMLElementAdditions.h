@@ -16,9 +16,40 @@
 
 #import <Cocoa/Cocoa.h>
 
+// Decodes the text content of a DBGp element, given the values of its
+// |encoding| and |children| attributes. Returns nil if the element has no
+// value of its own.
+NSString* DecodedElementValue(NSString* text, NSString* encoding, NSString* children);
+
+// Decodes |length| bytes of base64, for which the trailing padding is
+// optional. Returns nil if the bytes are not valid base64.
+NSData* Base64DecodedData(const void* bytes, NSUInteger length);
+
+// An EncodedValue holds the base64 text content of an element until its value
+// is first requested. Most values are never displayed, so this avoids both
+// decoding them and allocating the decoded strings.
+@interface EncodedValue : NSObject
+
+// The encoded text, either as the bytes of a CDATA section or as a string.
+- (instancetype)initWithData:(NSData*)data;
+- (instancetype)initWithString:(NSString*)string;
+
+// Whether |value| has been decoded, after which the encoded text is released.
+@property(readonly, nonatomic) BOOL isDecoded;
+
+// The decoded value, or nil if it is not UTF-8.
+@property(readonly, nonatomic) NSString* value;
+
+// Whether the two values are the same. This compares the encoded text if
+// neither has been decoded.
+- (BOOL)isEqualToEncodedValue:(EncodedValue*)other;
+
+@end
+
 @interface NSXMLElement (GDBpAdditions)
 
 - (BOOL)isLeaf;
+- (EncodedValue*)encodedValue;
 - (NSString*)base64DecodedValue;
 
 @end
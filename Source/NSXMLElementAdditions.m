@@ -14,41 +14,268 @@
  * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
  */
 
-#import <Cocoa/Cocoa.h>
+#import "NSXMLElementAdditions.h"
 
-#import "AppDelegate.h"
+// A vector of 16 base64 characters, or the sextets they encode.
+typedef uint8_t Base64Vector __attribute__((vector_size(16)));
+typedef uint64_t Base64Lanes __attribute__((vector_size(16)));
 
-@implementation NSXMLElement (GDBpAdditions)
+static const uint8_t kBase64Invalid = 0xFF;
 
 /**
- * Returns whether or not this node has any children
+ * Returns the sextet encoded by |c|, or kBase64Invalid.
  */
-- (BOOL)isLeaf
+static inline uint8_t Base64Sextet(uint8_t c)
 {
-  return ([[[self attributeForName:@"children"] stringValue] intValue] == 0);
+  if (c >= 'A' && c <= 'Z')
+    return c - 'A';
+  if (c >= 'a' && c <= 'z')
+    return c - 'a' + 26;
+  if (c >= '0' && c <= '9')
+    return c - '0' + 52;
+  if (c == '+')
+    return 62;
+  if (c == '/')
+    return 63;
+  return kBase64Invalid;
 }
 
 /**
- * Returns the value of the property
+ * Translates the 16 characters in |chars| to sextets by adding the offset for
+ * the range that each one falls in. Returns false if any character is not in
+ * the base64 alphabet.
  */
-- (NSString*)base64DecodedValue
+static inline bool Base64TranslateVector(Base64Vector chars, Base64Vector* sextets)
 {
-  // The value of the node is base64 encoded.
-  if ([[[self attributeForName:@"encoding"] stringValue] isEqualToString:@"base64"]) {
-    NSData* data = [[self stringValue] dataUsingEncoding:NSASCIIStringEncoding];
-    NSData* base64Data = [[NSData alloc] initWithBase64EncodedData:data options:0];
-    if (base64Data) {
-      return [[NSString alloc] initWithData:base64Data encoding:NSUTF8StringEncoding];
-    } else {
-      return @"<< Failed to base64-decode data >>";
+  Base64Vector upper = (Base64Vector)((chars >= (uint8_t)'A') & (chars <= (uint8_t)'Z'));
+  Base64Vector lower = (Base64Vector)((chars >= (uint8_t)'a') & (chars <= (uint8_t)'z'));
+  Base64Vector digit = (Base64Vector)((chars >= (uint8_t)'0') & (chars <= (uint8_t)'9'));
+  Base64Vector plus = (Base64Vector)(chars == (uint8_t)'+');
+  Base64Vector slash = (Base64Vector)(chars == (uint8_t)'/');
+
+  Base64Lanes invalid = (Base64Lanes)~(upper | lower | digit | plus | slash);
+  if (invalid[0] | invalid[1])
+    return false;
+
+  Base64Vector offset = (upper & (uint8_t)(0 - 'A')) |
+                        (lower & (uint8_t)(26 - 'a')) |
+                        (digit & (uint8_t)(52 - '0')) |
+                        (plus & (uint8_t)(62 - '+')) |
+                        (slash & (uint8_t)(63 - '/'));
+  *sextets = chars + offset;
+  return true;
+}
+
+/**
+ * Decodes |length| characters of base64 from |input|. The trailing padding
+ * may be omitted. Returns a buffer that the caller must free, or NULL if the
+ * input is not valid base64.
+ */
+static uint8_t* Base64Decode(const uint8_t* input, size_t length, size_t* outputLength)
+{
+  size_t end = length;
+  if (end % 4 == 0 && end && input[end - 1] == '=') {
+    --end;
+    if (input[end - 1] == '=')
+      --end;
+  }
+  if (end % 4 == 1)
+    return NULL;
+
+  size_t capacity = end / 4 * 3 + (end % 4 ? end % 4 - 1 : 0);
+  uint8_t* output = (uint8_t*)malloc(capacity ? capacity : 1);
+  size_t i = 0;
+  size_t o = 0;
+
+  // Decode 16 characters into 12 bytes at a time.
+  for (; i + 16 <= end; i += 16, o += 12) {
+    Base64Vector chars;
+    memcpy(&chars, input + i, sizeof(chars));
+    Base64Vector sextets;
+    if (!Base64TranslateVector(chars, &sextets)) {
+      free(output);
+      return NULL;
+    }
+    for (int j = 0; j < 4; ++j) {
+      uint32_t word = (uint32_t)sextets[4 * j] << 18 | (uint32_t)sextets[4 * j + 1] << 12 |
+                      (uint32_t)sextets[4 * j + 2] << 6 | sextets[4 * j + 3];
+      output[o + 3 * j] = word >> 16;
+      output[o + 3 * j + 1] = word >> 8;
+      output[o + 3 * j + 2] = word;
     }
   }
 
+  // Decode the rest one character at a time.
+  uint32_t word = 0;
+  int count = 0;
+  for (; i < end; ++i) {
+    uint8_t sextet = Base64Sextet(input[i]);
+    if (sextet == kBase64Invalid) {
+      free(output);
+      return NULL;
+    }
+    word = word << 6 | sextet;
+    if (++count == 4) {
+      output[o++] = word >> 16;
+      output[o++] = word >> 8;
+      output[o++] = word;
+      word = 0;
+      count = 0;
+    }
+  }
+  if (count == 2) {
+    output[o++] = word >> 4;
+  } else if (count == 3) {
+    output[o++] = word >> 10;
+    output[o++] = word >> 2;
+  }
+
+  *outputLength = o;
+  return output;
+}
+
+NSData* Base64DecodedData(const void* bytes, NSUInteger length)
+{
+  size_t outputLength = 0;
+  uint8_t* output = Base64Decode((const uint8_t*)bytes, length, &outputLength);
+  if (!output)
+    return nil;
+  return [NSData dataWithBytesNoCopy:output length:outputLength freeWhenDone:YES];
+}
+
+/**
+ * Decodes base64 |bytes| into a UTF-8 string, without copying the decoded
+ * bytes. Returns nil if they are not UTF-8.
+ */
+static NSString* Base64DecodedString(const void* bytes, NSUInteger length)
+{
+  size_t outputLength = 0;
+  uint8_t* output = Base64Decode((const uint8_t*)bytes, length, &outputLength);
+  if (!output)
+    return @"<< Failed to base64-decode data >>";
+  NSString* string = [[NSString alloc] initWithBytesNoCopy:output
+                                                    length:outputLength
+                                                  encoding:NSUTF8StringEncoding
+                                              freeWhenDone:YES];
+  if (!string)
+    free(output);
+  return string;
+}
+
+/**
+ * Decodes the base64 |text|, reading its characters in place if possible.
+ */
+static NSString* Base64DecodedText(NSString* text)
+{
+  const char* bytes = CFStringGetCStringPtr((__bridge CFStringRef)text, kCFStringEncodingASCII);
+  if (bytes)
+    return Base64DecodedString(bytes, strlen(bytes));
+  NSData* data = [text dataUsingEncoding:NSASCIIStringEncoding];
+  if (!data)
+    return @"<< Failed to base64-decode data >>";
+  return Base64DecodedString(data.bytes, data.length);
+}
+
+NSString* DecodedElementValue(NSString* text, NSString* encoding, NSString* children)
+{
+  // The value of the node is base64 encoded.
+  if ([encoding isEqualToString:@"base64"])
+    return Base64DecodedText(text);
+
   // The value is just a normal string.
-  if ([self isLeaf])
-    return [self stringValue];
+  if ([children intValue] == 0)
+    return text;
 
   return nil;
 }
 
+@implementation EncodedValue {
+  // The encoded value, as either NSData or NSString. This is released once
+  // the value is decoded.
+  id _encoded;
+  NSString* _value;
+}
+
+- (instancetype)initWithData:(NSData*)data
+{
+  if ((self = [super init])) {
+    _encoded = data ?: [NSData data];
+  }
+  return self;
+}
+
+- (instancetype)initWithString:(NSString*)string
+{
+  if ((self = [super init])) {
+    _encoded = [string copy] ?: @"";
+  }
+  return self;
+}
+
+- (BOOL)isDecoded
+{
+  return _encoded == nil;
+}
+
+- (NSString*)value
+{
+  if (_encoded) {
+    if ([_encoded isKindOfClass:[NSData class]])
+      _value = Base64DecodedString([_encoded bytes], [_encoded length]);
+    else
+      _value = Base64DecodedText(_encoded);
+    _encoded = nil;
+  }
+  return _value;
+}
+
+- (BOOL)isEqualToEncodedValue:(EncodedValue*)other
+{
+  if (_encoded && other->_encoded)
+    return [[self encodedData] isEqualToData:[other encodedData]];
+  NSString* value = self.value;
+  NSString* otherValue = other.value;
+  return value == otherValue || [value isEqualToString:otherValue];
+}
+
+/**
+ * Returns the encoded text as bytes.
+ */
+- (NSData*)encodedData
+{
+  if ([_encoded isKindOfClass:[NSData class]])
+    return _encoded;
+  return [_encoded dataUsingEncoding:NSASCIIStringEncoding allowLossyConversion:YES];
+}
+
+@end
+
+@implementation NSXMLElement (GDBpAdditions)
+
+/**
+ * Returns whether or not this node has any children
+ */
+- (BOOL)isLeaf
+{
+  return ([[[self attributeForName:@"children"] stringValue] intValue] == 0);
+}
+
+/**
+ * Returns the encoded value of the property, which is decoded when needed.
+ */
+- (EncodedValue*)encodedValue
+{
+  return [[EncodedValue alloc] initWithString:[self stringValue]];
+}
+
+/**
+ * Returns the value of the property
+ */
+- (NSString*)base64DecodedValue
+{
+  return DecodedElementValue([self stringValue],
+                             [[self attributeForName:@"encoding"] stringValue],
+                             [[self attributeForName:@"children"] stringValue]);
+}
+
 @end
@@ -25,9 +25,6 @@ extern NSString* const kPrefInspectorWindowVisible;
 // NSMutableArray of path replacements.
 extern NSString* const kPrefPathReplacements;
 
-// NSString to the path to the PHP binary used for syntax highlighting.
-extern NSString* const kPrefPhpPath;
-
 #if USE_APP_SANDBOX
 // NSMutableDictionary of NSString paths to NSData file access bookmarks.
 extern NSString* const kPrefFileAccessBookmarks;
@@ -52,3 +49,11 @@ extern NSString* const kPrefBreakpoints;
 
 // The selected segment in the DebuggerController.
 extern NSString* const kPrefSelectedDebuggerSegment;
+
+// NSNumber LogCaptureLevel for how much of each message the LoggingController
+// records while the log window is open.
+extern NSString* const kPrefLogCaptureLevel;
+
+// NSString path to a directory in which each debugger connection is saved as a
+// SessionRecording. Sessions are not recorded if this is unset.
+extern NSString* const kPrefSessionRecordingDirectory;
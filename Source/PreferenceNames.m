@@ -22,8 +22,6 @@ NSString* const kPrefInspectorWindowVisible = @"InspectorWindowVisible";
 
 NSString* const kPrefPathReplacements = @"PathReplacements";
 
-NSString* const kPrefPhpPath = @"PhpPath";
-
 #if USE_APP_SANDBOX
 NSString* const kPrefFileAccessBookmarks = @"FileAccessBookmarks";
 
@@ -39,3 +37,7 @@ NSString* const kPrefUnstableVersionCast = @"UnstableVersionCast";
 NSString* const kPrefBreakpoints = @"Breakpoints";
 
 NSString* const kPrefSelectedDebuggerSegment = @"DebuggerSegment";
+
+NSString* const kPrefLogCaptureLevel = @"LogCaptureLevel";
+
+NSString* const kPrefSessionRecordingDirectory = @"SessionRecordingDirectory";
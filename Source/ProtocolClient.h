@@ -17,18 +17,37 @@
 #import <Foundation/Foundation.h>
 
 #import "MessageQueue.h"
+#import "ProtocolResponse.h"
 
+@class LoggingController;
+@class ProtocolMetrics;
+@class SessionRecorder;
 @protocol ProtocolClientDelegate;
 
-typedef void (^ProtocolClientMessageHandler)(NSXMLDocument*);
+typedef void (^ProtocolClientMessageHandler)(ProtocolResponse*);
 
 // ProtocolClient sends string commands to a DBGP <http://www.xdebug.org/docs-dbgp.php>
-// debugger engine and receives XML packets in response. This class ensures
-// proper sequencing of the messages.
+// debugger engine and receives XML packets in response, which are decoded into
+// ProtocolResponse objects on a background queue. Handlers and delegate
+// methods are called on the thread that called |-connectOnPort:|, in the order
+// the responses were received. This class ensures proper sequencing of the messages.
 @interface ProtocolClient : NSObject<MessageQueueDelegate>
 
 - (id)initWithDelegate:(id<ProtocolClientDelegate>)delegate;
 
+// The controller that records the messages sent and received, if any.
+@property(weak, nonatomic) LoggingController* logger;
+
+// If set, the raw messages of each connection are saved to a new
+// SessionRecording file in this directory.
+@property(copy, nonatomic) NSString* recordingDirectory;
+
+// The recorder for the current connection, if it is being recorded.
+@property(readonly, nonatomic) SessionRecorder* recorder;
+
+// If set, the timings of each command and its response are collected here.
+@property(strong, nonatomic) ProtocolMetrics* metrics;
+
 - (BOOL)isConnected;
 
 - (void)connectOnPort:(NSUInteger)port;
@@ -44,6 +63,14 @@ typedef void (^ProtocolClientMessageHandler)(NSXMLDocument*);
                       handler:(ProtocolClientMessageHandler)handler,
                       ...;
 
+// Like |-sendCommandWithFormat:handler:|, but if the debugger responds with an
+// error, |errorHandler| is invoked with it instead of the delegate being
+// notified.
+- (void)sendCommandWithFormat:(NSString*)format
+                      handler:(ProtocolClientMessageHandler)handler
+                 errorHandler:(ProtocolClientMessageHandler)errorHandler,
+                 ...;
+
 // Sends a command to the debugger. The command must have a substring |{txn}|
 // within it, which will be replaced with the transaction ID. Use this if
 // |-sendCommandWithFormat:|'s insertion of the transaction ID is incorrect.
@@ -51,7 +78,6 @@ typedef void (^ProtocolClientMessageHandler)(NSXMLDocument*);
                             handler:(ProtocolClientMessageHandler)handler,
                             ...;
 
-- (NSInteger)transactionIDFromResponse:(NSXMLDocument*)response;
 - (NSInteger)transactionIDFromCommand:(NSString*)command;
 
 // Given a path to a file, creates a URI for it that is suitable for sending to
@@ -62,11 +88,11 @@ typedef void (^ProtocolClientMessageHandler)(NSXMLDocument*);
 
 // Delegate ////////////////////////////////////////////////////////////////////
 
-// All methods of the protocol client are dispatched to the thread on which the
-// ProtocolClient was created.
+// All methods of the protocol client are dispatched to the thread that called
+// |-connectOnPort:|.
 @protocol ProtocolClientDelegate
 - (void)debuggerEngineConnected:(ProtocolClient*)client;
 - (void)debuggerEngineDisconnected:(ProtocolClient*)client;
-- (void)protocolClient:(ProtocolClient*)client receivedInitialMessage:(NSXMLDocument*)message;
-- (void)protocolClient:(ProtocolClient*)client receivedErrorMessage:(NSXMLDocument*)message;
+- (void)protocolClient:(ProtocolClient*)client receivedInitialMessage:(ProtocolResponse*)message;
+- (void)protocolClient:(ProtocolClient*)client receivedErrorMessage:(ProtocolResponse*)message;
 @end
@@ -16,8 +16,29 @@
 
 #import "ProtocolClient.h"
 
-#import "AppDelegate.h"
 #import "LoggingController.h"
+#import "ProtocolMetrics.h"
+#import "SessionRecording.h"
+
+// Returns the value of the transaction_id attribute in the raw |message|, or
+// NSNotFound if it has none. This is used for messages that could not be
+// decoded.
+static NSInteger UndecodedTransactionID(NSData* message) {
+  NSData* attribute = [@"transaction_id=\"" dataUsingEncoding:NSUTF8StringEncoding];
+  NSRange start = [message rangeOfData:attribute options:0 range:NSMakeRange(0, message.length)];
+  if (start.location == NSNotFound)
+    return NSNotFound;
+
+  const char* bytes = (const char*)message.bytes;
+  NSUInteger i = NSMaxRange(start);
+  NSInteger transactionID = 0;
+  BOOL hasDigits = NO;
+  for (; i < message.length && bytes[i] >= '0' && bytes[i] <= '9'; ++i) {
+    transactionID = transactionID * 10 + (bytes[i] - '0');
+    hasDigits = YES;
+  }
+  return hasDigits ? transactionID : NSNotFound;
+}
 
 @implementation ProtocolClient {
   // The object responsible for the actual communication with the debug server.
@@ -30,19 +51,35 @@
   // A map between transaction ID and handler block for that message.
   NSMutableDictionary<NSNumber*, ProtocolClientMessageHandler>* _dispatchTable;
 
+  // A map between transaction ID and the block that handles an error response
+  // to that message, for those that were sent with one.
+  NSMutableDictionary<NSNumber*, ProtocolClientMessageHandler>* _errorTable;
+
   // The next transaction ID to assign.
   int _nextID;
 
   // Records the last read and written transaction IDs. These are only used in
-  // creating LogEntry objects.
+  // creating LogEntry objects and session records.
   NSInteger _lastReadID;
   NSInteger _lastWrittenID;
+
+  // The serial queue on which received messages are decoded, so that large
+  // responses do not block the delegate's thread.
+  dispatch_queue_t _decodeQueue;
+
+  // Incremented when the connection is closed, so that messages decoded for
+  // a previous connection are not dispatched.
+  NSUInteger _generation;
 }
 
 - (id)initWithDelegate:(id<ProtocolClientDelegate>)delegate {
   if ((self = [super init])) {
     _delegate = delegate;
     _dispatchTable = [[NSMutableDictionary alloc] init];
+    _errorTable = [[NSMutableDictionary alloc] init];
+    _decodeQueue = dispatch_queue_create(
+        [[NSString stringWithFormat:@"org.bluestatic.MacGDBp.ProtocolClient.%p", self] UTF8String],
+        DISPATCH_QUEUE_SERIAL);
   }
   return self;
 }
@@ -68,7 +105,7 @@
   NSString* command = [[NSString alloc] initWithFormat:format arguments:args];
   va_end(args);
 
-  [self sendCommandWithFormat:command handler:^(NSXMLDocument* message){}];
+  [self sendCommandWithFormat:command handler:^(ProtocolResponse* message){}];
 }
 
 - (void)sendCommandWithFormat:(NSString*)format
@@ -81,10 +118,21 @@
 
   int transaction = _nextID++;
   NSString* taggedCommand = [NSString stringWithFormat:@"%@ -i %d", command, transaction];
+  [self sendCommand:taggedCommand transaction:transaction handler:handler errorHandler:nil];
+}
 
-  assert(_messageQueue);
-  [_dispatchTable setObject:[handler copy] forKey:@(transaction)];
-  [_messageQueue sendMessage:taggedCommand];
+- (void)sendCommandWithFormat:(NSString*)format
+                      handler:(ProtocolClientMessageHandler)handler
+                 errorHandler:(ProtocolClientMessageHandler)errorHandler, ... {
+  // Collect varargs and format command.
+  va_list args;
+  va_start(args, errorHandler);
+  NSString* command = [[NSString alloc] initWithFormat:format arguments:args];
+  va_end(args);
+
+  int transaction = _nextID++;
+  NSString* taggedCommand = [NSString stringWithFormat:@"%@ -i %d", command, transaction];
+  [self sendCommand:taggedCommand transaction:transaction handler:handler errorHandler:errorHandler];
 }
 
 - (void)sendCustomCommandWithFormat:(NSString*)format
@@ -99,17 +147,10 @@
   NSString* taggedCommand =
       [command stringByReplacingOccurrencesOfString:@"{txn}"
                                          withString:[NSString stringWithFormat:@"%d", transaction]];
-
-  assert(_messageQueue);
-  [_dispatchTable setObject:[handler copy] forKey:@(transaction)];
-  [_messageQueue sendMessage:taggedCommand];
+  [self sendCommand:taggedCommand transaction:transaction handler:handler errorHandler:nil];
 }
 
 
-- (NSInteger)transactionIDFromResponse:(NSXMLDocument*)response {
-  return [[[[response rootElement] attributeForName:@"transaction_id"] stringValue] intValue];
-}
-
 - (NSInteger)transactionIDFromCommand:(NSString*)command {
   NSRange occurrence = [command rangeOfString:@"-i "];
   if (occurrence.location == NSNotFound)
@@ -136,12 +177,21 @@
   _lastReadID = 0;
   _lastWrittenID = 0;
 
+  if (self.recordingDirectory)
+    [self startRecording];
+
   [_delegate debuggerEngineConnected:self];
 }
 
 - (void)messageQueueDidDisconnect:(MessageQueue*)queue {
+  [_recorder close];
+  _recorder = nil;
+
+  ++_generation;
   _messageQueue = nil;
   [_dispatchTable removeAllObjects];
+  [_errorTable removeAllObjects];
+  [_metrics removePendingTransactions];
   [_delegate debuggerEngineDisconnected:self];
 }
 
@@ -150,51 +200,180 @@
   NSInteger tag = [self transactionIDFromCommand:message];
   _lastWrittenID = tag;
 
-  LoggingController* logger = [[AppDelegate instance] loggingController];
+  [_recorder recordMessage:[message dataUsingEncoding:NSUTF8StringEncoding]
+                 direction:kLogEntrySending
+     lastReadTransactionID:_lastReadID
+  lastWrittenTransactionID:_lastWrittenID];
+
+  LoggingController* logger = self.logger;
+  if (logger.activeCaptureLevel == kLogCaptureOff)
+    return;
+
   LogEntry* entry = [LogEntry newSendEntry:message];
   entry.lastReadTransactionID = _lastReadID;
   entry.lastWrittenTransactionID = _lastWrittenID;
   [logger recordEntry:entry];
 }
 
-// Callback with the message content when one has been receieved.
-- (void)messageQueue:(MessageQueue*)queue didReceiveMessage:(NSString*)message {
-  // Record this message in the transaction log.
-  LoggingController* logger = [[AppDelegate instance] loggingController];
-  LogEntry* entry = [LogEntry newReceiveEntry:message];
-  entry.lastReadTransactionID = _lastReadID;
-  entry.lastWrittenTransactionID = _lastWrittenID;
-  [logger recordEntry:entry];
+// Callback with the message content when one has been receieved. The message
+// is decoded on |_decodeQueue| and then dispatched back through the |queue|'s
+// delegate invoker, in order with its other messages.
+- (void)messageQueue:(MessageQueue*)queue
+   didReceiveMessage:(NSData*)data
+       firstByteTime:(NSTimeInterval)firstByteTime
+        lastByteTime:(NSTimeInterval)lastByteTime {
+  // Record the message as it arrived, before |_lastReadID| is updated from it.
+  [_recorder recordMessage:data
+                 direction:kLogEntryReceiving
+     lastReadTransactionID:_lastReadID
+  lastWrittenTransactionID:_lastWrittenID];
+
+  NSUInteger generation = _generation;
+  LoggingController* logger = self.logger;
+
+  // Only time the response if metrics are being collected.
+  TransactionMetrics* timing = nil;
+  if (_metrics) {
+    timing = [[TransactionMetrics alloc] init];
+    timing.responseBytes = data.length;
+    timing.firstByteTime = firstByteTime;
+    timing.lastByteTime = lastByteTime;
+  }
+
+  dispatch_async(_decodeQueue, ^{
+    // Only hold on to the message for the log if it is being captured.
+    LogEntry* entry = nil;
+    if (logger.activeCaptureLevel != kLogCaptureOff)
+      entry = [LogEntry newReceiveEntryWithData:data];
+
+    // Decode the response. If the streaming decoder cannot handle the packet,
+    // fall back to the more forgiving DOM parser.
+    timing.parseStartTime = [[NSProcessInfo processInfo] systemUptime];
+    NSError* error = nil;
+    ProtocolResponse* response = [ProtocolResponse responseWithData:data error:&error];
+    if (!response) {
+      NSLog(@"Falling back to DOM parsing after error: %@", error);
+      error = nil;
+      response = [ProtocolResponse responseWithDocumentData:data error:&error];
+    }
+    timing.parseEndTime = [[NSProcessInfo processInfo] systemUptime];
+    NSInteger undecodedID = response ? NSNotFound : UndecodedTransactionID(data);
+
+    [queue invokeDelegateBlock:^(id<MessageQueueDelegate> delegate) {
+      // Drop responses from a connection that has since been closed.
+      if (generation != self->_generation)
+        return;
+      if (undecodedID != NSNotFound)
+        [self abandonTransaction:undecodedID];
+      [self dispatchResponse:response logEntry:entry timing:timing error:error];
+    }];
+  });
+}
+
+// Private /////////////////////////////////////////////////////////////////////
+
+// Registers the handlers for |transaction| and sends the |taggedCommand|.
+- (void)sendCommand:(NSString*)taggedCommand
+        transaction:(int)transaction
+            handler:(ProtocolClientMessageHandler)handler
+       errorHandler:(ProtocolClientMessageHandler)errorHandler {
+  assert(_messageQueue);
+  [_dispatchTable setObject:[handler copy] forKey:@(transaction)];
+  if (errorHandler)
+    [_errorTable setObject:[errorHandler copy] forKey:@(transaction)];
+  [_metrics beginTransaction:transaction command:taggedCommand];
+  [_messageQueue sendMessage:taggedCommand];
+}
+
+// Creates a recorder for the new connection in |recordingDirectory|.
+- (void)startRecording {
+  NSDateFormatter* formatter = [[NSDateFormatter alloc] init];
+  formatter.dateFormat = @"yyyyMMdd-HHmmss";
+  NSString* name = [NSString stringWithFormat:@"session-%@-%lu.dbgprec",
+      [formatter stringFromDate:[NSDate date]], _generation];
+  NSString* path = [self.recordingDirectory stringByAppendingPathComponent:name];
 
-  // Parse the XML and test for errors.
   NSError* error = nil;
-  NSXMLDocument* xml = [[NSXMLDocument alloc] initWithXMLString:message
-                                                        options:NSXMLDocumentTidyXML
-                                                          error:&error];
-  if (error) {
-    [self messageQueue:queue error:error];
+  _recorder = [[SessionRecorder alloc] initWithPath:path error:&error];
+  if (!_recorder)
+    NSLog(@"Could not record session to %@: %@", path, error);
+}
+
+// Forgets the handlers and pending metrics of |transactionID|, whose response
+// could not be decoded, so that it does not stay pending forever.
+- (void)abandonTransaction:(NSInteger)transactionID {
+  [_dispatchTable removeObjectForKey:@(transactionID)];
+  [_errorTable removeObjectForKey:@(transactionID)];
+  [_metrics takeTransaction:transactionID];
+}
+
+// Records the |entry| for a received message and dispatches its decoded
+// |response|, or reports the |error| if the message could not be decoded. The
+// receive and parse times in |timing| complete the metrics of the transaction.
+// Called on the delegate's thread, in the order the messages were received.
+- (void)dispatchResponse:(ProtocolResponse*)response
+                logEntry:(LogEntry*)entry
+                  timing:(TransactionMetrics*)timing
+                   error:(NSError*)error {
+  // Record this message in the transaction log, unless capture stopped while
+  // it was being decoded.
+  LoggingController* logger = self.logger;
+  if (entry && logger.activeCaptureLevel != kLogCaptureOff) {
+    entry.lastReadTransactionID = _lastReadID;
+    entry.lastWrittenTransactionID = _lastWrittenID;
+    [logger recordEntry:entry];
+  }
+
+  if (!response) {
+    [self messageQueue:_messageQueue error:error];
     return;
   }
-  NSInteger transactionID = [self transactionIDFromResponse:xml];
+  NSInteger transactionID = response.transactionID;
 
   _lastReadID = transactionID;
   entry.lastReadTransactionID = _lastReadID;
 
-  if ([[[xml rootElement] elementsForName:@"error"] count] > 0) {
-    // Handle back-end errors.
-    [_delegate protocolClient:self receivedErrorMessage:xml];
-  } else if ([[[xml rootElement] name] isEqualToString:@"init"]) {
+  // The initial message does not answer a command, so it has no transaction.
+  TransactionMetrics* transaction = nil;
+  if (timing && ![response.name isEqualToString:@"init"])
+    transaction = [_metrics takeTransaction:transactionID];
+  transaction.responseBytes = timing.responseBytes;
+  transaction.firstByteTime = timing.firstByteTime;
+  transaction.lastByteTime = timing.lastByteTime;
+  transaction.parseStartTime = timing.parseStartTime;
+  transaction.parseEndTime = timing.parseEndTime;
+  transaction.handlerStartTime = [[NSProcessInfo processInfo] systemUptime];
+
+  if (response.errorCode) {
+    // Handle back-end errors. The transaction is complete, so its handlers are
+    // no longer needed.
+    ProtocolClientMessageHandler errorHandler = [_errorTable objectForKey:@(transactionID)];
+    [_dispatchTable removeObjectForKey:@(transactionID)];
+    [_errorTable removeObjectForKey:@(transactionID)];
+    if (errorHandler)
+      errorHandler(response);
+    else
+      [_delegate protocolClient:self receivedErrorMessage:response];
+  } else if ([response.name isEqualToString:@"init"]) {
     // Handle the initial connection message.
-    [_delegate protocolClient:self receivedInitialMessage:xml];
+    [_delegate protocolClient:self receivedInitialMessage:response];
   } else {
     // Dispatch the handler for the message.
     ProtocolClientMessageHandler handler = [_dispatchTable objectForKey:@(transactionID)];
-    if (!handler) {
-      NSLog(@"Could not dispatch handler for transaction %ld: %@", transactionID, message);
-      return;
+    if (handler) {
+      handler(response);
+      [_dispatchTable removeObjectForKey:@(transactionID)];
+      [_errorTable removeObjectForKey:@(transactionID)];
+    } else {
+      NSLog(@"Could not dispatch handler for transaction %ld: %@", transactionID, response.command);
     }
-    handler(xml);
-    [_dispatchTable removeObjectForKey:@(transactionID)];
+  }
+
+  // The transaction was taken from the pending ones above, so it is recorded
+  // even when it had no handler to run.
+  if (transaction) {
+    transaction.handlerEndTime = [[NSProcessInfo processInfo] systemUptime];
+    [_metrics recordTransaction:transaction];
   }
 }
 
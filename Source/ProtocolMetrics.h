@@ -0,0 +1,138 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Foundation/Foundation.h>
+
+// The timings of one command and its response. Times are the system uptime, in
+// seconds, at which each stage happened; the durations between them separate
+// the time spent waiting on the debugger engine and the network from the time
+// the client spent on the response.
+@interface TransactionMetrics : NSObject
+
+// The command name, e.g. "stack_get".
+@property(copy, nonatomic) NSString* command;
+@property(assign, nonatomic) NSInteger transactionID;
+
+@property(assign, nonatomic) NSUInteger commandBytes;
+@property(assign, nonatomic) NSUInteger responseBytes;
+
+// When the command was queued to be sent.
+@property(assign, nonatomic) NSTimeInterval sendTime;
+// When the first and last bytes of the response were read.
+@property(assign, nonatomic) NSTimeInterval firstByteTime;
+@property(assign, nonatomic) NSTimeInterval lastByteTime;
+// When the response was decoded, on the decode queue.
+@property(assign, nonatomic) NSTimeInterval parseStartTime;
+@property(assign, nonatomic) NSTimeInterval parseEndTime;
+// When the response handler ran, on the ProtocolClient's delegate thread.
+@property(assign, nonatomic) NSTimeInterval handlerStartTime;
+@property(assign, nonatomic) NSTimeInterval handlerEndTime;
+
+// From sending the command to the first byte of the response.
+@property(readonly, nonatomic) NSTimeInterval timeToFirstByte;
+// From the first to the last byte of the response.
+@property(readonly, nonatomic) NSTimeInterval receiveTime;
+// Decoding the response.
+@property(readonly, nonatomic) NSTimeInterval parseTime;
+// From the end of decoding until the delegate thread ran the handler.
+@property(readonly, nonatomic) NSTimeInterval queueTime;
+// Running the response handler.
+@property(readonly, nonatomic) NSTimeInterval handlerTime;
+// From sending the command to the end of the handler.
+@property(readonly, nonatomic) NSTimeInterval totalTime;
+
+@end
+
+// A histogram of durations in logarithmic buckets. Bucket 0 counts durations
+// under 1 microsecond, and bucket i counts those in [2^(i-1), 2^i) microseconds.
+// The last bucket also counts anything longer.
+@interface LatencyHistogram : NSObject
+
+@property(readonly, nonatomic) NSUInteger count;
+@property(readonly, nonatomic) NSTimeInterval sum;
+@property(readonly, nonatomic) NSTimeInterval max;
+
++ (NSUInteger)bucketCount;
+
+// The exclusive upper bound of the durations counted in |bucket|.
++ (NSTimeInterval)upperBoundOfBucket:(NSUInteger)bucket;
+
+- (NSUInteger)countInBucket:(NSUInteger)bucket;
+
+- (void)addDuration:(NSTimeInterval)duration;
+
+// Estimates the duration at |percentile|, in [0, 100], as the upper bound of
+// the bucket that holds it, but no more than |max|. Returns 0 when empty.
+- (NSTimeInterval)durationAtPercentile:(double)percentile;
+
+@end
+
+// The aggregated timings of every completed transaction of one command.
+@interface CommandMetrics : NSObject
+
+@property(readonly, nonatomic) NSString* command;
+@property(readonly, nonatomic) NSUInteger count;
+@property(readonly, nonatomic) NSUInteger commandBytes;
+@property(readonly, nonatomic) NSUInteger responseBytes;
+
+@property(readonly, nonatomic) LatencyHistogram* timeToFirstByte;
+@property(readonly, nonatomic) LatencyHistogram* receiveTime;
+@property(readonly, nonatomic) LatencyHistogram* parseTime;
+@property(readonly, nonatomic) LatencyHistogram* queueTime;
+@property(readonly, nonatomic) LatencyHistogram* handlerTime;
+@property(readonly, nonatomic) LatencyHistogram* totalTime;
+
+@end
+
+// ProtocolMetrics collects the TransactionMetrics of a ProtocolClient. The
+// ProtocolClient begins a transaction when it sends a command and records it
+// once the response has been handled. All methods must be called on the thread
+// to which the ProtocolClient delivers its responses.
+@interface ProtocolMetrics : NSObject
+
+// The names of the commands that have completed transactions, sorted.
+@property(readonly, nonatomic) NSArray<NSString*>* commands;
+
+// The slowest completed transactions by |totalTime|, slowest first. This is
+// KVO-compliant, so that it can be shown live.
+@property(readonly, nonatomic) NSArray<TransactionMetrics*>* slowestTransactions;
+
+// The number of transactions kept in |slowestTransactions|.
+@property(assign, nonatomic) NSUInteger slowestTransactionsLimit;
+
+// The number of transactions that have begun but not completed.
+@property(readonly, nonatomic) NSUInteger pendingTransactionCount;
+
+// Returns the metrics for |command|, or nil if none have completed.
+- (CommandMetrics*)metricsForCommand:(NSString*)command;
+
+// Starts timing the |command| string being sent as |transactionID|.
+- (void)beginTransaction:(NSInteger)transactionID command:(NSString*)command;
+
+// Removes and returns the transaction begun as |transactionID|, or nil.
+- (TransactionMetrics*)takeTransaction:(NSInteger)transactionID;
+
+// Adds a completed |transaction| to the metrics for its command.
+- (void)recordTransaction:(TransactionMetrics*)transaction;
+
+// Drops the transactions that have begun but not completed, as when the
+// connection is closed.
+- (void)removePendingTransactions;
+
+// Clears all metrics.
+- (void)reset;
+
+@end
@@ -0,0 +1,251 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "ProtocolMetrics.h"
+
+#include <math.h>
+
+// Bucket 25 begins at 2^24 microseconds, about 17 seconds.
+static const NSUInteger kBucketCount = 26;
+
+static const NSUInteger kDefaultSlowestTransactionsLimit = 20;
+
+@implementation TransactionMetrics
+
+- (NSTimeInterval)timeToFirstByte {
+  return self.firstByteTime - self.sendTime;
+}
+
+- (NSTimeInterval)receiveTime {
+  return self.lastByteTime - self.firstByteTime;
+}
+
+- (NSTimeInterval)parseTime {
+  return self.parseEndTime - self.parseStartTime;
+}
+
+- (NSTimeInterval)queueTime {
+  return self.handlerStartTime - self.parseEndTime;
+}
+
+- (NSTimeInterval)handlerTime {
+  return self.handlerEndTime - self.handlerStartTime;
+}
+
+- (NSTimeInterval)totalTime {
+  return self.handlerEndTime - self.sendTime;
+}
+
+- (NSString*)description {
+  return [NSString stringWithFormat:@"<%@ %p> %@ -i %ld: %.3f ms "
+                                    @"(first byte %.3f, receive %.3f, parse %.3f, "
+                                    @"queue %.3f, handler %.3f)",
+      [self className], self, self.command, self.transactionID, self.totalTime * 1000,
+      self.timeToFirstByte * 1000, self.receiveTime * 1000, self.parseTime * 1000,
+      self.queueTime * 1000, self.handlerTime * 1000];
+}
+
+@end
+
+@implementation LatencyHistogram {
+  NSUInteger _buckets[kBucketCount];
+}
+
++ (NSUInteger)bucketCount {
+  return kBucketCount;
+}
+
++ (NSTimeInterval)upperBoundOfBucket:(NSUInteger)bucket {
+  if (bucket >= kBucketCount - 1)
+    return HUGE_VAL;
+  return ldexp(1e-6, (int)bucket);
+}
+
+- (NSUInteger)countInBucket:(NSUInteger)bucket {
+  return bucket < kBucketCount ? _buckets[bucket] : 0;
+}
+
+- (void)addDuration:(NSTimeInterval)duration {
+  duration = MAX(duration, 0);
+
+  NSUInteger bucket = 0;
+  double microseconds = duration * 1e6;
+  if (microseconds >= 1)
+    bucket = MIN((NSUInteger)ilogb(microseconds) + 1, kBucketCount - 1);
+  ++_buckets[bucket];
+
+  ++_count;
+  _sum += duration;
+  _max = MAX(_max, duration);
+}
+
+- (NSTimeInterval)durationAtPercentile:(double)percentile {
+  if (_count == 0)
+    return 0;
+
+  // Nearest rank: the smallest bucket that holds at least |percentile| of the
+  // durations.
+  NSUInteger rank = (NSUInteger)ceil(percentile * _count / 100);
+  rank = MIN(MAX(rank, (NSUInteger)1), _count);
+  NSUInteger seen = 0;
+  for (NSUInteger i = 0; i < kBucketCount; ++i) {
+    seen += _buckets[i];
+    if (seen >= rank)
+      return MIN([LatencyHistogram upperBoundOfBucket:i], _max);
+  }
+  return _max;
+}
+
+@end
+
+@implementation CommandMetrics
+
+- (instancetype)initWithCommand:(NSString*)command {
+  if ((self = [super init])) {
+    _command = [command copy];
+    _timeToFirstByte = [[LatencyHistogram alloc] init];
+    _receiveTime = [[LatencyHistogram alloc] init];
+    _parseTime = [[LatencyHistogram alloc] init];
+    _queueTime = [[LatencyHistogram alloc] init];
+    _handlerTime = [[LatencyHistogram alloc] init];
+    _totalTime = [[LatencyHistogram alloc] init];
+  }
+  return self;
+}
+
+- (void)addTransaction:(TransactionMetrics*)transaction {
+  ++_count;
+  _commandBytes += transaction.commandBytes;
+  _responseBytes += transaction.responseBytes;
+  [_timeToFirstByte addDuration:transaction.timeToFirstByte];
+  [_receiveTime addDuration:transaction.receiveTime];
+  [_parseTime addDuration:transaction.parseTime];
+  [_queueTime addDuration:transaction.queueTime];
+  [_handlerTime addDuration:transaction.handlerTime];
+  [_totalTime addDuration:transaction.totalTime];
+}
+
+@end
+
+@implementation ProtocolMetrics {
+  // The transactions that have been sent but not yet recorded.
+  NSMutableDictionary<NSNumber*, TransactionMetrics*>* _pending;
+
+  NSMutableDictionary<NSString*, CommandMetrics*>* _commands;
+
+  // The slowest transactions, sorted by descending |totalTime|.
+  NSMutableArray<TransactionMetrics*>* _slowest;
+}
+
+- (instancetype)init {
+  if ((self = [super init])) {
+    _pending = [[NSMutableDictionary alloc] init];
+    _commands = [[NSMutableDictionary alloc] init];
+    _slowest = [[NSMutableArray alloc] init];
+    _slowestTransactionsLimit = kDefaultSlowestTransactionsLimit;
+  }
+  return self;
+}
+
+- (NSArray<NSString*>*)commands {
+  return [[_commands allKeys] sortedArrayUsingSelector:@selector(compare:)];
+}
+
+- (NSArray<TransactionMetrics*>*)slowestTransactions {
+  return [_slowest copy];
+}
+
+- (NSUInteger)pendingTransactionCount {
+  return _pending.count;
+}
+
+- (void)setSlowestTransactionsLimit:(NSUInteger)limit {
+  _slowestTransactionsLimit = limit;
+  if (_slowest.count <= limit)
+    return;
+
+  [self willChangeValueForKey:@"slowestTransactions"];
+  [_slowest removeObjectsInRange:NSMakeRange(limit, _slowest.count - limit)];
+  [self didChangeValueForKey:@"slowestTransactions"];
+}
+
+- (CommandMetrics*)metricsForCommand:(NSString*)command {
+  return [_commands objectForKey:command];
+}
+
+- (void)beginTransaction:(NSInteger)transactionID command:(NSString*)command {
+  TransactionMetrics* transaction = [[TransactionMetrics alloc] init];
+  transaction.sendTime = [[NSProcessInfo processInfo] systemUptime];
+
+  NSRange space = [command rangeOfString:@" "];
+  transaction.command =
+      space.location == NSNotFound ? command : [command substringToIndex:space.location];
+  transaction.transactionID = transactionID;
+  // The command is sent NUL-terminated.
+  transaction.commandBytes = [command lengthOfBytesUsingEncoding:NSUTF8StringEncoding] + 1;
+
+  [_pending setObject:transaction forKey:@(transactionID)];
+}
+
+- (TransactionMetrics*)takeTransaction:(NSInteger)transactionID {
+  TransactionMetrics* transaction = [_pending objectForKey:@(transactionID)];
+  [_pending removeObjectForKey:@(transactionID)];
+  return transaction;
+}
+
+- (void)recordTransaction:(TransactionMetrics*)transaction {
+  CommandMetrics* metrics = [_commands objectForKey:transaction.command];
+  if (!metrics) {
+    metrics = [[CommandMetrics alloc] initWithCommand:transaction.command];
+    [_commands setObject:metrics forKey:transaction.command];
+  }
+  [metrics addTransaction:transaction];
+
+  NSUInteger index =
+      [_slowest indexOfObject:transaction
+                inSortedRange:NSMakeRange(0, _slowest.count)
+                      options:NSBinarySearchingInsertionIndex | NSBinarySearchingLastEqual
+              usingComparator:^NSComparisonResult(TransactionMetrics* a, TransactionMetrics* b) {
+                if (a.totalTime > b.totalTime)
+                  return NSOrderedAscending;
+                if (a.totalTime < b.totalTime)
+                  return NSOrderedDescending;
+                return NSOrderedSame;
+              }];
+  if (index >= _slowestTransactionsLimit)
+    return;
+
+  [self willChangeValueForKey:@"slowestTransactions"];
+  [_slowest insertObject:transaction atIndex:index];
+  if (_slowest.count > _slowestTransactionsLimit)
+    [_slowest removeLastObject];
+  [self didChangeValueForKey:@"slowestTransactions"];
+}
+
+- (void)removePendingTransactions {
+  [_pending removeAllObjects];
+}
+
+- (void)reset {
+  [_pending removeAllObjects];
+  [_commands removeAllObjects];
+
+  [self willChangeValueForKey:@"slowestTransactions"];
+  [_slowest removeAllObjects];
+  [self didChangeValueForKey:@"slowestTransactions"];
+}
+
+@end
@@ -0,0 +1,77 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Foundation/Foundation.h>
+
+@class StackFrame;
+@class VariableNode;
+
+// ProtocolResponse is a decoded DBGp response packet. Rather than building a
+// DOM, the packet is normally decoded in a single streaming pass, which
+// produces the model objects for the elements that the debugger uses:
+//
+//   <stack>     stack_get
+//   <context>   context_names
+//   <property>  context_get, property_get, eval
+//   text        source
+//
+// Anything else is available through the root element's |attributes|, or
+// through the |document|, which is built on demand.
+@interface ProtocolResponse : NSObject
+
+// The raw bytes of the packet.
+@property(readonly, nonatomic) NSData* data;
+
+// The name of the root element, either "response" or "init".
+@property(readonly, nonatomic) NSString* name;
+
+// The attributes of the root element.
+@property(readonly, nonatomic) NSDictionary<NSString*, NSString*>* attributes;
+
+// Helpers for attributes of the root element.
+@property(readonly, nonatomic) NSString* command;
+@property(readonly, nonatomic) NSInteger transactionID;
+
+// If the engine responded with an <error>, its code and message. The code is
+// 0 if there is no error.
+@property(readonly, nonatomic) NSInteger errorCode;
+@property(readonly, nonatomic) NSString* errorMessage;
+
+// The frames of a stack_get response, in order.
+@property(readonly, nonatomic) NSArray<StackFrame*>* stackFrames;
+
+// The context IDs of a context_names response.
+@property(readonly, nonatomic) NSArray<NSNumber*>* contextIDs;
+
+// The top-level <property> elements of the response, with their children.
+@property(readonly, nonatomic) NSArray<VariableNode*>* properties;
+
+// The decoded text content of the root element, e.g. for a source response.
+@property(readonly, nonatomic) NSString* value;
+
+// The packet parsed as an XML document. This is expensive and is only built
+// the first time it is accessed.
+@property(readonly, nonatomic) NSXMLDocument* document;
+
+// Decodes |data| with a streaming parser. Returns nil and sets |error| if the
+// data are not well-formed.
++ (instancetype)responseWithData:(NSData*)data error:(NSError**)error;
+
+// Decodes |data| by building a DOM, which tolerates malformed XML. This is
+// slower than |+responseWithData:error:| and is used as a fallback.
++ (instancetype)responseWithDocumentData:(NSData*)data error:(NSError**)error;
+
+@end
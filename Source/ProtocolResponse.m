@@ -0,0 +1,330 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "ProtocolResponse.h"
+
+#include <string.h>
+
+#import "NSXMLElementAdditions.h"
+#import "StackFrame.h"
+#import "VariableNode.h"
+
+@interface ProtocolResponse ()
+@property(copy, nonatomic) NSString* name;
+@property(copy, nonatomic) NSDictionary<NSString*, NSString*>* attributes;
+@property(assign, nonatomic) NSInteger errorCode;
+@property(copy, nonatomic) NSString* errorMessage;
+@property(copy, nonatomic) NSArray<StackFrame*>* stackFrames;
+@property(copy, nonatomic) NSArray<NSNumber*>* contextIDs;
+@property(copy, nonatomic) NSArray<VariableNode*>* properties;
+@property(copy, nonatomic) NSString* value;
+- (instancetype)initWithData:(NSData*)data;
+@end
+
+// Parsing Helpers /////////////////////////////////////////////////////////////
+
+// Creates a StackFrame from the attributes of a <stack> element.
+static StackFrame* StackFrameFromAttributes(NSDictionary<NSString*, NSString*>* attributes) {
+  StackFrame* frame = [[StackFrame alloc] init];
+  frame.index = [attributes[@"level"] intValue];
+  frame.filename = attributes[@"filename"];
+  frame.lineNumber = [attributes[@"lineno"] intValue];
+  frame.function = attributes[@"where"];
+  return frame;
+}
+
+// Returns the attributes of |element| as a dictionary.
+static NSDictionary<NSString*, NSString*>* AttributesOfElement(NSXMLElement* element) {
+  NSMutableDictionary<NSString*, NSString*>* attributes = [NSMutableDictionary dictionary];
+  for (NSXMLNode* attribute in [element attributes]) {
+    attributes[[attribute name]] = [attribute stringValue];
+  }
+  return attributes;
+}
+
+// Returns a view of |data| without the leading XML declaration. Xdebug declares
+// its packets as iso-8859-1 even though they contain UTF-8, so the declaration
+// must not be honored. The result does not copy the bytes of |data|, so it
+// must not outlive it.
+static NSData* DataWithoutXMLDeclaration(NSData* data) {
+  const char* bytes = data.bytes;
+  if (data.length < 5 || memcmp(bytes, "<?xml", 5) != 0)
+    return data;
+
+  const char* end = memmem(bytes, data.length, "?>", 2);
+  if (!end)
+    return data;
+
+  size_t offset = end + 2 - bytes;
+  return [NSData dataWithBytesNoCopy:(void*)(bytes + offset)
+                              length:data.length - offset
+                        freeWhenDone:NO];
+}
+
+// Parses |data| into a DOM. The packet is decoded as a string first, for the
+// same reason as in |DataWithoutXMLDeclaration()|.
+static NSXMLDocument* DocumentFromData(NSData* data, NSError** error) {
+  NSString* string = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+  if (!string)
+    string = [[NSString alloc] initWithData:data encoding:NSISOLatin1StringEncoding];
+  return [[NSXMLDocument alloc] initWithXMLString:string
+                                          options:NSXMLDocumentTidyXML
+                                            error:error];
+}
+
+// Streaming Parser ////////////////////////////////////////////////////////////
+
+// The state of a <property> element whose children are being parsed. The text
+// of a base64-encoded property is collected as bytes in |encodedText|, so that
+// it can be decoded later without being converted to a string first.
+@interface ProtocolResponsePropertyBuilder : NSObject
+- (instancetype)initWithAttributes:(NSDictionary<NSString*, NSString*>*)attributes;
+@property(readonly, nonatomic) NSDictionary<NSString*, NSString*>* attributes;
+@property(readonly, nonatomic) NSMutableString* text;
+@property(readonly, nonatomic) NSMutableData* encodedText;
+@property(readonly, nonatomic) NSMutableArray<VariableNode*>* children;
+- (VariableNode*)node;
+@end
+
+@implementation ProtocolResponsePropertyBuilder
+- (instancetype)initWithAttributes:(NSDictionary<NSString*, NSString*>*)attributes {
+  if ((self = [super init])) {
+    _attributes = [attributes copy];
+    if ([attributes[@"encoding"] isEqualToString:@"base64"])
+      _encodedText = [[NSMutableData alloc] init];
+    else
+      _text = [[NSMutableString alloc] init];
+    _children = [[NSMutableArray alloc] init];
+  }
+  return self;
+}
+
+- (VariableNode*)node {
+  if (_encodedText) {
+    return [[VariableNode alloc] initWithAttributes:_attributes
+                                       encodedValue:[[EncodedValue alloc] initWithData:_encodedText]
+                                           children:_children];
+  }
+  return [[VariableNode alloc] initWithAttributes:_attributes
+                                      textContent:_text
+                                         children:_children];
+}
+@end
+
+// The NSXMLParser delegate that fills in a ProtocolResponse as the elements
+// of the packet are encountered.
+@interface ProtocolResponseParser : NSObject<NSXMLParserDelegate>
+- (instancetype)initWithResponse:(ProtocolResponse*)response;
+- (void)finish;
+@end
+
+@implementation ProtocolResponseParser {
+  ProtocolResponse* _response;
+
+  NSMutableArray<StackFrame*>* _stackFrames;
+  NSMutableArray<NSNumber*>* _contextIDs;
+  NSMutableArray<VariableNode*>* _properties;
+
+  // The <property> elements that are currently open, innermost last.
+  NSMutableArray<ProtocolResponsePropertyBuilder*>* _propertyStack;
+
+  // For each open element, the string or data that collects its text
+  // content, or NSNull if the text is not needed.
+  NSMutableArray* _textStack;
+
+  NSMutableString* _rootText;
+  NSMutableString* _errorMessage;
+}
+
+- (instancetype)initWithResponse:(ProtocolResponse*)response {
+  if ((self = [super init])) {
+    _response = response;
+    _stackFrames = [[NSMutableArray alloc] init];
+    _contextIDs = [[NSMutableArray alloc] init];
+    _properties = [[NSMutableArray alloc] init];
+    _propertyStack = [[NSMutableArray alloc] init];
+    _textStack = [[NSMutableArray alloc] init];
+  }
+  return self;
+}
+
+- (void)finish {
+  _response.stackFrames = _stackFrames;
+  _response.contextIDs = _contextIDs;
+  _response.properties = _properties;
+  _response.errorMessage = _errorMessage;
+  _response.value = DecodedElementValue(_rootText,
+                                        _response.attributes[@"encoding"],
+                                        _response.attributes[@"children"]);
+}
+
+- (void)parser:(NSXMLParser*)parser
+    didStartElement:(NSString*)elementName
+       namespaceURI:(NSString*)namespaceURI
+      qualifiedName:(NSString*)qualifiedName
+         attributes:(NSDictionary<NSString*, NSString*>*)attributes {
+  id text = [NSNull null];
+
+  if (_textStack.count == 0) {
+    _response.name = elementName;
+    _response.attributes = attributes;
+    _rootText = [[NSMutableString alloc] init];
+    text = _rootText;
+  } else if ([elementName isEqualToString:@"property"]) {
+    ProtocolResponsePropertyBuilder* builder =
+        [[ProtocolResponsePropertyBuilder alloc] initWithAttributes:attributes];
+    [_propertyStack addObject:builder];
+    text = builder.encodedText ?: builder.text;
+  } else if ([elementName isEqualToString:@"stack"]) {
+    [_stackFrames addObject:StackFrameFromAttributes(attributes)];
+  } else if ([elementName isEqualToString:@"context"]) {
+    [_contextIDs addObject:@([attributes[@"id"] integerValue])];
+  } else if ([elementName isEqualToString:@"error"]) {
+    _response.errorCode = [attributes[@"code"] integerValue];
+  } else if ([elementName isEqualToString:@"message"] && _response.errorCode) {
+    _errorMessage = [[NSMutableString alloc] init];
+    text = _errorMessage;
+  }
+
+  [_textStack addObject:text];
+}
+
+- (void)parser:(NSXMLParser*)parser
+    didEndElement:(NSString*)elementName
+     namespaceURI:(NSString*)namespaceURI
+    qualifiedName:(NSString*)qualifiedName {
+  if (_textStack.count > 1 && [elementName isEqualToString:@"property"]) {
+    ProtocolResponsePropertyBuilder* builder = _propertyStack.lastObject;
+    [_propertyStack removeLastObject];
+
+    VariableNode* node = [builder node];
+    if (_propertyStack.count)
+      [_propertyStack.lastObject.children addObject:node];
+    else
+      [_properties addObject:node];
+  }
+
+  [_textStack removeLastObject];
+}
+
+- (void)parser:(NSXMLParser*)parser foundCharacters:(NSString*)string {
+  id text = _textStack.lastObject;
+  if ([text isKindOfClass:[NSMutableData class]])
+    [text appendData:[string dataUsingEncoding:NSASCIIStringEncoding allowLossyConversion:YES]];
+  else if (text != [NSNull null])
+    [text appendString:string];
+}
+
+- (void)parser:(NSXMLParser*)parser foundCDATA:(NSData*)block {
+  id text = _textStack.lastObject;
+  if ([text isKindOfClass:[NSMutableData class]]) {
+    [text appendData:block];
+  } else if (text != [NSNull null]) {
+    NSString* string = [[NSString alloc] initWithData:block encoding:NSUTF8StringEncoding];
+    if (string)
+      [text appendString:string];
+  }
+}
+
+@end
+
+// ProtocolResponse ////////////////////////////////////////////////////////////
+
+@implementation ProtocolResponse {
+  NSXMLDocument* _document;
+}
+
++ (instancetype)responseWithData:(NSData*)data error:(NSError**)error {
+  ProtocolResponse* response = [[self alloc] initWithData:data];
+  ProtocolResponseParser* delegate = [[ProtocolResponseParser alloc] initWithResponse:response];
+
+  NSXMLParser* parser = [[NSXMLParser alloc] initWithData:DataWithoutXMLDeclaration(data)];
+  parser.delegate = delegate;
+  if (![parser parse]) {
+    if (error)
+      *error = [parser parserError];
+    return nil;
+  }
+
+  [delegate finish];
+  return response;
+}
+
++ (instancetype)responseWithDocumentData:(NSData*)data error:(NSError**)error {
+  NSXMLDocument* document = DocumentFromData(data, error);
+  if (!document)
+    return nil;
+
+  ProtocolResponse* response = [[self alloc] initWithData:data];
+  response->_document = document;
+
+  NSXMLElement* root = [document rootElement];
+  response.name = [root name];
+  response.attributes = AttributesOfElement(root);
+
+  NSMutableArray<StackFrame*>* stackFrames = [NSMutableArray array];
+  NSMutableArray<NSNumber*>* contextIDs = [NSMutableArray array];
+  NSMutableArray<VariableNode*>* properties = [NSMutableArray array];
+  for (NSXMLNode* node in [root children]) {
+    if (![node isKindOfClass:[NSXMLElement class]])
+      continue;
+    NSXMLElement* child = (NSXMLElement*)node;
+    NSString* name = [child name];
+    if ([name isEqualToString:@"property"]) {
+      [properties addObject:[[VariableNode alloc] initWithXMLNode:child]];
+    } else if ([name isEqualToString:@"stack"]) {
+      [stackFrames addObject:StackFrameFromAttributes(AttributesOfElement(child))];
+    } else if ([name isEqualToString:@"context"]) {
+      [contextIDs addObject:@([[[child attributeForName:@"id"] stringValue] integerValue])];
+    } else if ([name isEqualToString:@"error"]) {
+      response.errorCode = [[[child attributeForName:@"code"] stringValue] integerValue];
+      response.errorMessage = [[[child elementsForName:@"message"] firstObject] stringValue];
+    }
+  }
+  response.stackFrames = stackFrames;
+  response.contextIDs = contextIDs;
+  response.properties = properties;
+  response.value = [root base64DecodedValue];
+
+  return response;
+}
+
+- (instancetype)initWithData:(NSData*)data {
+  if ((self = [super init])) {
+    _data = data;
+  }
+  return self;
+}
+
+- (NSString*)command {
+  return self.attributes[@"command"];
+}
+
+- (NSInteger)transactionID {
+  return [self.attributes[@"transaction_id"] integerValue];
+}
+
+- (NSXMLDocument*)document {
+  if (!_document)
+    _document = DocumentFromData(_data, NULL);
+  return _document;
+}
+
+- (NSString*)description {
+  return [NSString stringWithFormat:@"<ProtocolResponse %p : %@ %@>", self, self.name, self.attributes];
+}
+
+@end
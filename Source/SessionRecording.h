@@ -0,0 +1,92 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "LoggingController.h"
+
+// A session recording is the DBGp byte stream of one connection, saved so that
+// it can be replayed against the client by a SessionReplayer. The file is an
+// append-only sequence of records that can be memory-mapped and read in place:
+//
+//   file:    "MGDBPREC", uint32 version, uint32 reserved
+//   record:  uint32 length, uint32 direction, uint64 timestamp,
+//            int64 last read transaction ID, int64 last written transaction ID,
+//            |length| bytes of message, padded to a multiple of 8 bytes
+//
+// Integers are stored in host byte order. The timestamp is in nanoseconds
+// since the recording started. The direction has the same meaning as in a
+// LogEntry. The transaction IDs are the last ones read and written when the
+// message was sent, or when its bytes arrived. A received message is recorded
+// before it is decoded, so that the records keep the order and timing of the
+// wire, and its last read ID is that of the response before it. (A LogEntry
+// for the same message has its own transaction ID.)
+
+// The error domain for recordings that cannot be read.
+extern NSString* const kSessionRecordingErrorDomain;
+
+// SessionRecorder appends messages to a recording file. Messages are written
+// on a background queue, so recording does not block the caller.
+@interface SessionRecorder : NSObject
+
+// The path of the recording file.
+@property(readonly, nonatomic) NSString* path;
+
+// Creates the file at |path|, replacing any existing file. Returns nil and sets
+// |error| if the file cannot be created.
+- (instancetype)initWithPath:(NSString*)path error:(NSError**)error;
+
+// Appends a message that was sent or received, with the transaction IDs at the
+// time it was sent or arrived.
+- (void)recordMessage:(NSData*)message
+               direction:(LogEntryDirection)direction
+   lastReadTransactionID:(NSInteger)lastReadTransactionID
+lastWrittenTransactionID:(NSInteger)lastWrittenTransactionID;
+
+// Waits for pending messages to be written and closes the file. Further
+// messages are ignored.
+- (void)close;
+
+@end
+
+// A single message in a SessionRecording.
+@interface SessionRecord : NSObject
+
+@property(readonly, nonatomic) LogEntryDirection direction;
+
+// The time the message was recorded, in seconds since the recording started.
+@property(readonly, nonatomic) NSTimeInterval timestamp;
+
+@property(readonly, nonatomic) NSInteger lastReadTransactionID;
+@property(readonly, nonatomic) NSInteger lastWrittenTransactionID;
+
+// The bytes of the message, which point into the mapped file.
+@property(readonly, nonatomic) NSData* message;
+
+@end
+
+// SessionRecording is a read-only, memory-mapped view of a recording file.
+@interface SessionRecording : NSObject
+
+// The records in the file, oldest first.
+@property(readonly, nonatomic) NSArray<SessionRecord*>* records;
+
+// Maps the recording at |path|. Returns nil and sets |error| if the file cannot
+// be read or is not a recording. A truncated final record, as left by a
+// session that did not close its recorder, is ignored.
++ (instancetype)recordingAtPath:(NSString*)path error:(NSError**)error;
+
+@end
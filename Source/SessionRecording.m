@@ -0,0 +1,219 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "SessionRecording.h"
+
+#include <fcntl.h>
+#include <mach/mach_time.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+NSString* const kSessionRecordingErrorDomain = @"org.bluestatic.MacGDBp.SessionRecording";
+
+static const char kMagic[8] = { 'M', 'G', 'D', 'B', 'P', 'R', 'E', 'C' };
+static const uint32_t kVersion = 1;
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+} FileHeader;
+
+typedef struct {
+  uint32_t length;
+  uint32_t direction;
+  uint64_t timestamp;
+  int64_t lastReadTransactionID;
+  int64_t lastWrittenTransactionID;
+} RecordHeader;
+
+// Records and their messages start on 8-byte boundaries.
+static size_t PaddedLength(size_t length) {
+  return (length + 7) & ~(size_t)7;
+}
+
+// Returns an error for the failed system call on |path| that set errno.
+static NSError* FileError(NSString* path) {
+  return [NSError errorWithDomain:NSPOSIXErrorDomain
+                             code:errno
+                         userInfo:@{ NSFilePathErrorKey : path }];
+}
+
+static NSError* InvalidRecordingError(NSString* path) {
+  return [NSError errorWithDomain:kSessionRecordingErrorDomain
+                             code:1
+                         userInfo:@{
+    NSLocalizedDescriptionKey : [NSString stringWithFormat:@"%@ is not a session recording.", path],
+    NSFilePathErrorKey : path,
+  }];
+}
+
+// Returns the current time in nanoseconds.
+static uint64_t Now(void) {
+  static mach_timebase_info_data_t timebase;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    mach_timebase_info(&timebase);
+  });
+  return mach_absolute_time() * timebase.numer / timebase.denom;
+}
+
+@implementation SessionRecorder {
+  int _fd;
+  uint64_t _startTime;
+
+  // The serial queue on which the file is written.
+  dispatch_queue_t _queue;
+}
+
+- (instancetype)initWithPath:(NSString*)path error:(NSError**)error {
+  if ((self = [super init])) {
+    _path = [path copy];
+    _fd = open([path fileSystemRepresentation], O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (_fd < 0) {
+      if (error)
+        *error = FileError(path);
+      return nil;
+    }
+
+    FileHeader header = { .version = kVersion };
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    ssize_t written = write(_fd, &header, sizeof(header));
+    if (written != sizeof(header)) {
+      // A short write does not set errno.
+      if (written >= 0)
+        errno = EIO;
+      if (error)
+        *error = FileError(path);
+      return nil;
+    }
+
+    _startTime = Now();
+    _queue = dispatch_queue_create("org.bluestatic.MacGDBp.SessionRecorder", DISPATCH_QUEUE_SERIAL);
+  }
+  return self;
+}
+
+- (void)dealloc {
+  if (_fd >= 0)
+    close(_fd);
+}
+
+- (void)recordMessage:(NSData*)message
+               direction:(LogEntryDirection)direction
+   lastReadTransactionID:(NSInteger)lastReadTransactionID
+lastWrittenTransactionID:(NSInteger)lastWrittenTransactionID {
+  RecordHeader header = {
+    .length = (uint32_t)message.length,
+    .direction = direction,
+    .timestamp = Now() - _startTime,
+    .lastReadTransactionID = lastReadTransactionID,
+    .lastWrittenTransactionID = lastWrittenTransactionID,
+  };
+  message = [message copy];
+  dispatch_async(_queue, ^{
+    if (self->_fd < 0)
+      return;
+    static const uint8_t kPadding[8] = {0};
+    struct iovec parts[] = {
+      { (void*)&header, sizeof(header) },
+      { (void*)message.bytes, message.length },
+      { (void*)kPadding, PaddedLength(message.length) - message.length },
+    };
+    // A short write leaves a truncated record, which readers ignore, so there
+    // is nothing to retry.
+    if (writev(self->_fd, parts, 3) < 0)
+      NSLog(@"Failed to write to session recording %@: %s", self->_path, strerror(errno));
+  });
+}
+
+- (void)close {
+  dispatch_sync(_queue, ^{
+    if (self->_fd >= 0) {
+      close(self->_fd);
+      self->_fd = -1;
+    }
+  });
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////
+
+@interface SessionRecord ()
+- (instancetype)initWithHeader:(const RecordHeader*)header message:(NSData*)message;
+@end
+
+@implementation SessionRecord
+
+- (instancetype)initWithHeader:(const RecordHeader*)header message:(NSData*)message {
+  if ((self = [super init])) {
+    _direction = header->direction;
+    _timestamp = header->timestamp / (NSTimeInterval)NSEC_PER_SEC;
+    _lastReadTransactionID = header->lastReadTransactionID;
+    _lastWrittenTransactionID = header->lastWrittenTransactionID;
+    _message = message;
+  }
+  return self;
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////
+
+@implementation SessionRecording
+
++ (instancetype)recordingAtPath:(NSString*)path error:(NSError**)error {
+  NSData* data = [NSData dataWithContentsOfFile:path
+                                        options:NSDataReadingMappedAlways
+                                          error:error];
+  if (!data)
+    return nil;
+
+  const FileHeader* fileHeader = data.bytes;
+  if (data.length < sizeof(FileHeader) ||
+      memcmp(fileHeader->magic, kMagic, sizeof(kMagic)) != 0 ||
+      fileHeader->version != kVersion) {
+    if (error)
+      *error = InvalidRecordingError(path);
+    return nil;
+  }
+
+  NSMutableArray<SessionRecord*>* records = [NSMutableArray array];
+  const uint8_t* bytes = data.bytes;
+  size_t offset = sizeof(FileHeader);
+  while (offset + sizeof(RecordHeader) <= data.length) {
+    const RecordHeader* header = (const RecordHeader*)(bytes + offset);
+    size_t messageOffset = offset + sizeof(RecordHeader);
+    if (header->length > data.length - messageOffset)
+      break;
+
+    // The message refers to the mapped bytes, and it keeps the mapping alive.
+    NSData* message = [[NSData alloc] initWithBytesNoCopy:(void*)(bytes + messageOffset)
+                                                   length:header->length
+                                              deallocator:^(void* unused, NSUInteger length) {
+      (void)data;
+    }];
+    [records addObject:[[SessionRecord alloc] initWithHeader:header message:message]];
+    offset = messageOffset + PaddedLength(header->length);
+  }
+
+  SessionRecording* recording = [[self alloc] init];
+  recording->_records = records;
+  return recording;
+}
+
+@end
@@ -0,0 +1,74 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Foundation/Foundation.h>
+
+@class LocalSourceFile;
+
+// Whether the local copy of a file has the same contents as the source that the
+// debugger engine returns for it.
+typedef enum _LocalFileMatch {
+  kLocalFileUnchecked = 0,
+  kLocalFileMatches,
+  kLocalFileDiffers
+} LocalFileMatch;
+
+// SourceCache holds the source code of files fetched from the debugger engine,
+// keyed by file URI, for the duration of a connection. Files with identical
+// contents share a single string. When the total size of the cached sources
+// exceeds the capacity, the least recently used files are evicted. It also
+// remembers which files have a matching local copy, so that their source only
+// needs to be fetched and compared once per connection, or again after the
+// local copy changes on disk.
+@interface SourceCache : NSObject
+
+// The maximum number of bytes of source to hold.
+@property(readonly, nonatomic) NSUInteger capacity;
+
+// The number of bytes of source currently held.
+@property(readonly, nonatomic) NSUInteger size;
+
+// The number of lookups that did and did not find a cached source.
+@property(readonly, nonatomic) NSUInteger hits;
+@property(readonly, nonatomic) NSUInteger misses;
+
+// Creates a cache that holds up to |capacity| bytes.
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+// Returns the cached source for |fileURI|, or nil.
+- (NSString*)sourceForFile:(NSString*)fileURI;
+
+// Caches |source| for |fileURI|. Returns the string that is stored, which may
+// be an existing string with the same contents.
+- (NSString*)setSource:(NSString*)source forFile:(NSString*)fileURI;
+
+// Returns whether the local copy of |fileURI| has been found to match the
+// engine's source, and sets |localFile| to the copy if it matches. What is known
+// about a copy is forgotten once its modification date or size changes on disk.
+- (LocalFileMatch)localFileMatchForFile:(NSString*)fileURI
+                           matchingFile:(LocalSourceFile**)localFile;
+
+// Records whether |localFile|, the local copy of |fileURI|, matches the engine's
+// source.
+- (void)setLocalFile:(LocalSourceFile*)localFile
+             matches:(BOOL)matches
+             forFile:(NSString*)fileURI;
+
+// Empties the cache, including what is known about local copies. The counters
+// are not reset.
+- (void)removeAllSources;
+
+@end
@@ -0,0 +1,140 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "SourceCache.h"
+
+#import "LocalSourceFile.h"
+
+// Returns the number of bytes used to store |source|.
+static NSUInteger SourceCost(NSString* source) {
+  return source.length * sizeof(unichar);
+}
+
+@implementation SourceCache {
+  // Map of file URI to its source.
+  NSMutableDictionary<NSString*, NSString*>* _sources;
+
+  // The file URIs in |_sources|, least recently used first.
+  NSMutableArray<NSString*>* _recentFiles;
+
+  // The distinct sources in the cache, counted by the number of files that
+  // have them. Lookups hash the contents, so identical files share a string.
+  NSCountedSet<NSString*>* _contents;
+
+  // Map of file URI to whether its local copy matches, for files that have
+  // been compared.
+  NSMutableDictionary<NSString*, NSNumber*>* _localFileMatches;
+
+  // Map of file URI to the local copy that was compared, which is checked for
+  // changes on disk before its match is used.
+  NSMutableDictionary<NSString*, LocalSourceFile*>* _localFiles;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+  if ((self = [super init])) {
+    _capacity = capacity;
+    _sources = [[NSMutableDictionary alloc] init];
+    _recentFiles = [[NSMutableArray alloc] init];
+    _contents = [[NSCountedSet alloc] init];
+    _localFileMatches = [[NSMutableDictionary alloc] init];
+    _localFiles = [[NSMutableDictionary alloc] init];
+  }
+  return self;
+}
+
+- (NSString*)sourceForFile:(NSString*)fileURI {
+  NSString* source = _sources[fileURI];
+  if (!source) {
+    ++_misses;
+    return nil;
+  }
+
+  ++_hits;
+  [_recentFiles removeObject:fileURI];
+  [_recentFiles addObject:fileURI];
+  return source;
+}
+
+- (NSString*)setSource:(NSString*)source forFile:(NSString*)fileURI {
+  [self removeSourceForFile:fileURI];
+
+  NSString* shared = [_contents member:source];
+  if (shared) {
+    source = shared;
+  } else {
+    source = [source copy];
+    _size += SourceCost(source);
+  }
+  [_contents addObject:source];
+  _sources[fileURI] = source;
+  [_recentFiles addObject:fileURI];
+
+  // Evict the least recently used files, but always keep the newest one.
+  while (_size > _capacity && _recentFiles.count > 1)
+    [self removeSourceForFile:_recentFiles.firstObject];
+
+  return source;
+}
+
+- (LocalFileMatch)localFileMatchForFile:(NSString*)fileURI
+                           matchingFile:(LocalSourceFile**)localFile {
+  LocalSourceFile* file = _localFiles[fileURI];
+  if (!file)
+    return kLocalFileUnchecked;
+
+  if ([file isModified]) {
+    [_localFiles removeObjectForKey:fileURI];
+    [_localFileMatches removeObjectForKey:fileURI];
+    return kLocalFileUnchecked;
+  }
+
+  LocalFileMatch match = [_localFileMatches[fileURI] intValue];
+  if (match == kLocalFileMatches && localFile)
+    *localFile = file;
+  return match;
+}
+
+- (void)setLocalFile:(LocalSourceFile*)localFile
+             matches:(BOOL)matches
+             forFile:(NSString*)fileURI {
+  _localFiles[fileURI] = localFile;
+  _localFileMatches[fileURI] = @(matches ? kLocalFileMatches : kLocalFileDiffers);
+}
+
+- (void)removeAllSources {
+  [_localFileMatches removeAllObjects];
+  [_localFiles removeAllObjects];
+  [_sources removeAllObjects];
+  [_recentFiles removeAllObjects];
+  [_contents removeAllObjects];
+  _size = 0;
+}
+
+// Private /////////////////////////////////////////////////////////////////////
+
+- (void)removeSourceForFile:(NSString*)fileURI {
+  NSString* source = _sources[fileURI];
+  if (!source)
+    return;
+
+  [_sources removeObjectForKey:fileURI];
+  [_recentFiles removeObject:fileURI];
+  [_contents removeObject:source];
+  if ([_contents countForObject:source] == 0)
+    _size -= SourceCost(source);
+}
+
+@end
@@ -16,6 +16,7 @@
 
 #import <Cocoa/Cocoa.h>
 
+@class LocalSourceFile;
 @class VariableNode;
 
 @interface StackFrame : NSObject
@@ -36,10 +37,17 @@
 @property(copy, nonatomic) NSString* filename;
 
 /**
- * Cached, highlighted version of the source
+ * Cached, highlighted version of the source. If the frame has a |localFile|,
+ * this is its decoded contents.
  */
 @property(copy, nonatomic) NSString* source;
 
+/**
+ * The local copy of the file, which is used instead of fetching the source
+ * from the debugger engine.
+ */
+@property(strong, nonatomic) LocalSourceFile* localFile;
+
 /**
  * Line number of the source the frame points to
  */
@@ -16,8 +16,20 @@
 
 #import "StackFrame.h"
 
+#import "LocalSourceFile.h"
+
 @implementation StackFrame
 
++ (NSSet<NSString*>*)keyPathsForValuesAffectingSource {
+  return [NSSet setWithObject:@"localFile"];
+}
+
+- (NSString*)source {
+  if (!_source)
+    return _localFile.string;
+  return _source;
+}
+
 - (BOOL)isEqual:(id)object {
   if (![object isKindOfClass:[StackFrame class]])
     return NO;
@@ -0,0 +1,70 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "BSHighlightCache.h"
+
+@interface BSHighlightCacheTest : XCTestCase
+@end
+
+@implementation BSHighlightCacheTest
+
+- (void)testHit {
+  BSHighlightCache* cache = [[BSHighlightCache alloc] initWithCapacity:2];
+  NSString* source = @"<?php echo 1;";
+  NSAttributedString* text = [[NSAttributedString alloc] initWithString:source];
+  XCTAssertNil([cache textForSource:source atPath:@"/a.php"]);
+
+  [cache setText:text forSource:source atPath:@"/a.php"];
+  XCTAssertEqualObjects(text, [cache textForSource:source atPath:@"/a.php"]);
+  XCTAssertEqualObjects(text, [cache textForSource:[NSMutableString stringWithString:source]
+                                            atPath:@"/a.php"]);
+  XCTAssertNil([cache textForSource:source atPath:@"/b.php"]);
+}
+
+- (void)testChangedSourceMisses {
+  BSHighlightCache* cache = [[BSHighlightCache alloc] initWithCapacity:2];
+  NSAttributedString* text = [[NSAttributedString alloc] initWithString:@"<?php echo 1;"];
+  [cache setText:text forSource:@"<?php echo 1;" atPath:@"/a.php"];
+  XCTAssertNil([cache textForSource:@"<?php echo 2;" atPath:@"/a.php"]);
+  // The stale entry is dropped.
+  XCTAssertNil([cache textForSource:@"<?php echo 1;" atPath:@"/a.php"]);
+}
+
+- (void)testEvictsLeastRecentlyUsed {
+  BSHighlightCache* cache = [[BSHighlightCache alloc] initWithCapacity:2];
+  for (NSString* source in @[ @"a", @"b" ]) {
+    [cache setText:[[NSAttributedString alloc] initWithString:source]
+         forSource:source
+            atPath:[NSString stringWithFormat:@"/%@.php", source]];
+  }
+  XCTAssertNotNil([cache textForSource:@"a" atPath:@"/a.php"]);
+
+  [cache setText:[[NSAttributedString alloc] initWithString:@"c"] forSource:@"c" atPath:@"/c.php"];
+  XCTAssertNotNil([cache textForSource:@"a" atPath:@"/a.php"]);
+  XCTAssertNil([cache textForSource:@"b" atPath:@"/b.php"]);
+  XCTAssertNotNil([cache textForSource:@"c" atPath:@"/c.php"]);
+}
+
+- (void)testIgnoresUntitledSource {
+  BSHighlightCache* cache = [[BSHighlightCache alloc] initWithCapacity:2];
+  NSAttributedString* text = [[NSAttributedString alloc] initWithString:@"x"];
+  [cache setText:text forSource:@"x" atPath:nil];
+  XCTAssertNil([cache textForSource:@"x" atPath:nil]);
+}
+
+@end
@@ -0,0 +1,168 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "BSLineIndex.h"
+
+@interface BSLineIndexTest : XCTestCase
+@end
+
+@implementation BSLineIndexTest
+
+- (void)testEmpty {
+  BSLineIndex* index = [[BSLineIndex alloc] initWithString:@""];
+  XCTAssertEqual(0u, index.lineCount);
+  XCTAssertEqual((NSUInteger)NSNotFound, [index characterIndexForLine:1]);
+  XCTAssertEqual((NSUInteger)NSNotFound, [index lineForCharacterIndex:0]);
+  XCTAssertEqual((NSUInteger)NSNotFound, [index rangeOfLine:1].location);
+}
+
+- (void)testLines {
+  BSLineIndex* index = [[BSLineIndex alloc] initWithString:@"<?php\r\necho 1;\n\n}"];
+  XCTAssertEqual(4u, index.lineCount);
+  XCTAssertEqual(0u, [index characterIndexForLine:1]);
+  XCTAssertEqual(7u, [index characterIndexForLine:2]);
+  XCTAssertEqual(15u, [index characterIndexForLine:3]);
+  XCTAssertEqual(16u, [index characterIndexForLine:4]);
+  XCTAssertEqual((NSUInteger)NSNotFound, [index characterIndexForLine:0]);
+  XCTAssertEqual((NSUInteger)NSNotFound, [index characterIndexForLine:5]);
+
+  XCTAssertTrue(NSEqualRanges(NSMakeRange(0, 7), [index rangeOfLine:1]));
+  XCTAssertTrue(NSEqualRanges(NSMakeRange(7, 8), [index rangeOfLine:2]));
+  XCTAssertTrue(NSEqualRanges(NSMakeRange(16, 1), [index rangeOfLine:4]));
+
+  XCTAssertEqual(1u, [index lineForCharacterIndex:0]);
+  XCTAssertEqual(1u, [index lineForCharacterIndex:6]);
+  XCTAssertEqual(2u, [index lineForCharacterIndex:7]);
+  XCTAssertEqual(3u, [index lineForCharacterIndex:15]);
+  XCTAssertEqual(4u, [index lineForCharacterIndex:16]);
+  XCTAssertEqual(4u, [index lineForCharacterIndex:100]);
+}
+
+- (void)testTrailingTerminator {
+  BSLineIndex* index = [[BSLineIndex alloc] initWithString:@"a\nb\n"];
+  XCTAssertEqual(3u, index.lineCount);
+  XCTAssertEqual(4u, [index characterIndexForLine:3]);
+  XCTAssertTrue(NSEqualRanges(NSMakeRange(4, 0), [index rangeOfLine:3]));
+  XCTAssertEqual(3u, [index lineForCharacterIndex:4]);
+}
+
+- (void)testUnicodeTerminators {
+  NSString* string = [NSString stringWithFormat:@"a%Cb%Cc%Cd\re", (unichar)0x2028, (unichar)0x2029, (unichar)0x85];
+  BSLineIndex* index = [[BSLineIndex alloc] initWithString:string];
+  XCTAssertEqual(5u, index.lineCount);
+  XCTAssertEqual(8u, [index characterIndexForLine:5]);
+}
+
+// Applies an edit to |string| and |index|, and checks the index against one
+// built from scratch.
+- (void)replaceCharactersInRange:(NSRange)range
+                      withString:(NSString*)replacement
+                        inString:(NSMutableString*)string
+                           index:(BSLineIndex*)index {
+  [string replaceCharactersInRange:range withString:replacement];
+  [index updateForEditedRange:NSMakeRange(range.location, replacement.length)
+               changeInLength:(NSInteger)replacement.length - (NSInteger)range.length
+                       string:string];
+
+  BSLineIndex* expected = [[BSLineIndex alloc] initWithString:string];
+  XCTAssertEqual(expected.lineCount, index.lineCount, @"%@", string);
+  for (NSUInteger line = 1; line <= expected.lineCount; ++line) {
+    XCTAssertEqual([expected characterIndexForLine:line], [index characterIndexForLine:line],
+                   @"line %lu of %@", line, string);
+  }
+}
+
+- (void)testUpdate {
+  NSMutableString* string = [NSMutableString stringWithString:@"one\ntwo\nthree"];
+  BSLineIndex* index = [[BSLineIndex alloc] initWithString:string];
+
+  // Insert a line.
+  [self replaceCharactersInRange:NSMakeRange(4, 0) withString:@"1.5\n" inString:string index:index];
+  XCTAssertEqual(4u, index.lineCount);
+  // Join two lines.
+  [self replaceCharactersInRange:NSMakeRange(7, 1) withString:@" " inString:string index:index];
+  XCTAssertEqual(3u, index.lineCount);
+  // Add a trailing terminator, then remove it.
+  [self replaceCharactersInRange:NSMakeRange(string.length, 0) withString:@"\n" inString:string index:index];
+  XCTAssertEqual(4u, index.lineCount);
+  [self replaceCharactersInRange:NSMakeRange(string.length - 1, 1) withString:@"" inString:string index:index];
+  XCTAssertEqual(3u, index.lineCount);
+  // Clear it, then replace everything.
+  [self replaceCharactersInRange:NSMakeRange(0, string.length) withString:@"" inString:string index:index];
+  XCTAssertEqual(0u, index.lineCount);
+  [self replaceCharactersInRange:NSMakeRange(0, 0) withString:@"a\nb" inString:string index:index];
+  XCTAssertEqual(2u, index.lineCount);
+}
+
+- (void)testUpdateCRLF {
+  NSMutableString* string = [NSMutableString stringWithString:@"a\rb\r\nc"];
+  BSLineIndex* index = [[BSLineIndex alloc] initWithString:string];
+  XCTAssertEqual(3u, index.lineCount);
+
+  // Complete a CRLF by inserting after the CR.
+  [self replaceCharactersInRange:NSMakeRange(2, 1) withString:@"\n" inString:string index:index];
+  XCTAssertEqual(3u, index.lineCount);
+  // Split a CRLF.
+  [self replaceCharactersInRange:NSMakeRange(2, 0) withString:@"x" inString:string index:index];
+  XCTAssertEqual(4u, index.lineCount);
+  // Remove the LF of a CRLF.
+  [self replaceCharactersInRange:NSMakeRange(5, 1) withString:@"" inString:string index:index];
+  XCTAssertEqual(4u, index.lineCount);
+}
+
+- (void)testUpdateRandom {
+  NSArray<NSString*>* pieces = @[ @"a", @"bc", @"\n", @"\r", @"\r\n", @"\n\n" ];
+  NSMutableString* string = [NSMutableString string];
+  BSLineIndex* index = [[BSLineIndex alloc] initWithString:string];
+  srandom(42);
+  for (NSUInteger i = 0; i < 500; ++i) {
+    NSUInteger location = random() % (string.length + 1);
+    NSUInteger length = random() % (string.length - location + 1) / 2;
+    NSString* replacement = pieces[random() % pieces.count];
+    [self replaceCharactersInRange:NSMakeRange(location, length)
+                        withString:replacement
+                          inString:string
+                             index:index];
+  }
+}
+
+- (void)testPerformanceBuild {
+  NSMutableString* source = [NSMutableString string];
+  for (NSUInteger i = 0; i < 20000; ++i)
+    [source appendFormat:@"$line%lu = %lu;\n", i, i];
+
+  [self measureBlock:^{
+    XCTAssertEqual(20001u, [[BSLineIndex alloc] initWithString:source].lineCount);
+  }];
+}
+
+- (void)testPerformanceLookup {
+  NSMutableString* source = [NSMutableString string];
+  for (NSUInteger i = 0; i < 20000; ++i)
+    [source appendFormat:@"$line%lu = %lu;\n", i, i];
+  BSLineIndex* index = [[BSLineIndex alloc] initWithString:source];
+
+  [self measureBlock:^{
+    for (NSUInteger line = 1; line <= index.lineCount; ++line) {
+      NSUInteger character = [index characterIndexForLine:line];
+      XCTAssertEqual(line, [index lineForCharacterIndex:character]);
+    }
+  }];
+}
+
+@end
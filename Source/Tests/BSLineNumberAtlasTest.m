@@ -0,0 +1,109 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "BSLineNumberAtlas.h"
+
+// The number of line numbers visible in one frame of a tall source view.
+static const NSUInteger kLinesPerFrame = 80;
+
+@interface BSLineNumberAtlasTest : XCTestCase
+@end
+
+@implementation BSLineNumberAtlasTest {
+  NSDictionary* _attributes;
+  NSBitmapImageRep* _bitmap;
+}
+
+- (void)setUp {
+  [super setUp];
+  _attributes = @{
+    NSFontAttributeName            : [NSFont userFixedPitchFontOfSize:11],
+    NSForegroundColorAttributeName : [NSColor grayColor],
+  };
+  _bitmap = [[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL
+                                                    pixelsWide:60
+                                                    pixelsHigh:kLinesPerFrame * 14
+                                                 bitsPerSample:8
+                                               samplesPerPixel:4
+                                                      hasAlpha:YES
+                                                      isPlanar:NO
+                                                colorSpaceName:NSCalibratedRGBColorSpace
+                                                   bytesPerRow:0
+                                                  bitsPerPixel:0];
+  [NSGraphicsContext saveGraphicsState];
+  [NSGraphicsContext setCurrentContext:[NSGraphicsContext graphicsContextWithBitmapImageRep:_bitmap]];
+}
+
+- (void)tearDown {
+  [NSGraphicsContext restoreGraphicsState];
+  [super tearDown];
+}
+
+- (void)testSizeOfNumber {
+  BSLineNumberAtlas* atlas = [[BSLineNumberAtlas alloc] initWithAttributes:_attributes scale:2];
+  NSSize digit = atlas.digitSize;
+  XCTAssertGreaterThan(digit.width, 0);
+  XCTAssertTrue(NSEqualSizes(digit, [atlas sizeOfNumber:0]));
+  XCTAssertTrue(NSEqualSizes(digit, [atlas sizeOfNumber:9]));
+  XCTAssertEqual(2 * digit.width, [atlas sizeOfNumber:10].width);
+  XCTAssertEqual(5 * digit.width, [atlas sizeOfNumber:20000].width);
+}
+
+- (void)testDrawsRightAligned {
+  BSLineNumberAtlas* atlas = [[BSLineNumberAtlas alloc] initWithAttributes:_attributes scale:1];
+  [atlas drawNumber:8 inRect:NSMakeRect(0, 0, 60, 14)];
+  [[NSGraphicsContext currentContext] flushGraphics];
+
+  // The digit is drawn in the rightmost cell, and nothing to the left of it,
+  // allowing a pixel for antialiasing.
+  NSUInteger cellStart = 60 - atlas.digitSize.width - 1;
+  BOOL inked = NO;
+  for (NSUInteger x = 0; x < 60; ++x) {
+    for (NSUInteger y = 0; y < 14; ++y) {
+      if ([[_bitmap colorAtX:x y:_bitmap.pixelsHigh - 1 - y] alphaComponent] > 0) {
+        XCTAssertGreaterThanOrEqual(x, cellStart);
+        inked = YES;
+      }
+    }
+  }
+  XCTAssertTrue(inked);
+}
+
+- (void)testPerformanceDrawFrame {
+  BSLineNumberAtlas* atlas = [[BSLineNumberAtlas alloc] initWithAttributes:_attributes scale:2];
+  [self measureBlock:^{
+    for (NSUInteger i = 0; i < kLinesPerFrame; ++i)
+      [atlas drawNumber:20000 + i inRect:NSMakeRect(0, i * 14, 60, 14)];
+  }];
+}
+
+// The cost of a frame drawn by laying out a string per line, as the ruler did
+// before it used the atlas.
+- (void)testPerformanceDrawFrameWithStrings {
+  NSDictionary* attributes = _attributes;
+  [self measureBlock:^{
+    for (NSUInteger i = 0; i < kLinesPerFrame; ++i) {
+      NSString* format = [NSString stringWithFormat:@"%lu", 20000 + i];
+      NSAttributedString* string = [[NSAttributedString alloc] initWithString:format
+                                                                   attributes:attributes];
+      [string drawInRect:NSMakeRect(0, i * 14, 60, 14)];
+    }
+  }];
+}
+
+@end
@@ -0,0 +1,137 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "BSPHPHighlighter.h"
+#import "ResponseFixtures.h"
+
+@interface BSPHPHighlighterTest : XCTestCase
+@end
+
+@implementation BSPHPHighlighterTest
+
+// Returns the runs of |highlighter| as "<type>:<text>" strings, where the type
+// is one of HDKSC.
+- (NSArray<NSString*>*)describeRuns:(BSPHPHighlighter*)highlighter {
+  NSMutableArray<NSString*>* runs = [NSMutableArray array];
+  for (NSUInteger i = 0; i < highlighter.runCount; ++i) {
+    BSPHPHighlightRun run = [highlighter runAtIndex:i];
+    [runs addObject:[NSString stringWithFormat:@"%c:%@",
+        "HDKSC"[run.type], [highlighter.source substringWithRange:run.range]]];
+  }
+  return runs;
+}
+
+- (void)testTokens {
+  BSPHPHighlighter* highlighter = [[BSPHPHighlighter alloc] initWithSource:
+      @"<b><?php\n"
+      @"// Comment\n"
+      @"$a = 'it\\'s' . \"x $b y\";\n"
+      @"/* Block */ function F() { return 0x1F; }\n"
+      @"?>\n"
+      @"<i>"];
+  NSArray<NSString*>* expected = @[
+    @"H:<b>",
+    @"D:<?php\n",
+    @"C:// Comment\n",
+    @"D:$a ",
+    @"K:= ",
+    @"S:'it\\'s' ",
+    @"K:. ",
+    @"S:\"x ",
+    @"D:$b",
+    @"S: y\"",
+    @"K:;\n",
+    @"C:/* Block */ ",
+    @"K:function ",
+    @"D:F",
+    @"K:() { return ",
+    @"D:0x1F",
+    @"K:; }\n",
+    @"D:?>",
+    @"H:\n<i>",
+  ];
+  XCTAssertEqualObjects(expected, [self describeRuns:highlighter]);
+}
+
+- (void)testHeredoc {
+  BSPHPHighlighter* highlighter = [[BSPHPHighlighter alloc] initWithSource:
+      @"<?php $a = <<<EOT\n  EOTX\n  EOT;\n$b = <<<'NOW'\nraw\nNOW;"];
+  NSArray<NSString*>* expected = @[
+    @"D:<?php $a ",
+    @"K:= ",
+    @"S:<<<EOT\n  EOTX\n  EOT",
+    @"K:;\n",
+    @"D:$b ",
+    @"K:= ",
+    @"S:<<<'NOW'\nraw\nNOW",
+    @"K:;",
+  ];
+  XCTAssertEqualObjects(expected, [self describeRuns:highlighter]);
+}
+
+- (void)testCommentEndsAtCloseTag {
+  BSPHPHighlighter* highlighter = [[BSPHPHighlighter alloc] initWithSource:@"<?php # a ?> b"];
+  NSArray<NSString*>* expected = @[ @"D:<?php ", @"C:# a ", @"D:?>", @"H: b" ];
+  XCTAssertEqualObjects(expected, [self describeRuns:highlighter]);
+}
+
+- (void)testRunsCoverSource {
+  NSString* source = ReadTestScript(@"Cyrillic-array-key.php");
+  BSPHPHighlighter* highlighter = [[BSPHPHighlighter alloc] initWithSource:source];
+  NSUInteger location = 0;
+  for (NSUInteger i = 0; i < highlighter.runCount; ++i) {
+    BSPHPHighlightRun run = [highlighter runAtIndex:i];
+    XCTAssertEqual(location, run.range.location);
+    location = NSMaxRange(run.range);
+  }
+  XCTAssertEqual(source.length, location);
+
+  XCTAssertEqual(0u, [highlighter indexOfRunContainingLocation:0]);
+  XCTAssertEqual(highlighter.runCount - 1, [highlighter indexOfRunContainingLocation:source.length - 1]);
+  XCTAssertEqual(highlighter.runCount, [highlighter indexOfRunContainingLocation:source.length]);
+}
+
+// Builds a PHP file of several thousand lines from the dev/tests scripts.
+- (NSString*)largeSource {
+  NSMutableString* source = [NSMutableString string];
+  NSArray* scripts = @[ @"bug-207.php", @"Cyrillic-array-key.php", @"exception.php",
+                        @"long_array.php", @"space name.php", @"static.php" ];
+  while ([[source componentsSeparatedByString:@"\n"] count] < 5000) {
+    for (NSString* script in scripts)
+      [source appendString:ReadTestScript(script)];
+  }
+  return source;
+}
+
+- (void)testPerformanceTokenize {
+  NSString* source = [self largeSource];
+  [self measureBlock:^{
+    XCTAssertGreaterThan([[BSPHPHighlighter alloc] initWithSource:source].runCount, 0u);
+  }];
+}
+
+- (void)testPerformanceApply {
+  NSString* source = [self largeSource];
+  BSPHPHighlighter* highlighter = [[BSPHPHighlighter alloc] initWithSource:source];
+  [self measureBlock:^{
+    NSTextStorage* storage = [[NSTextStorage alloc] initWithString:source];
+    [highlighter applyRuns:NSMakeRange(0, highlighter.runCount) toTextStorage:storage];
+  }];
+}
+
+@end
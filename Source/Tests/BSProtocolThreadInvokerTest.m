@@ -0,0 +1,199 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "BSProtocolThreadInvoker.h"
+
+// The number of messages sent by each performance test. The messages per second
+// are this divided by the measured time.
+static const NSUInteger kPerformanceMessageCount = 20000;
+
+@protocol InvokerTestDelegate
+- (void)receivedMessage:(NSUInteger)index;
+@end
+
+@interface InvokerTestTarget : NSObject<InvokerTestDelegate>
+@property(readonly, nonatomic) NSMutableArray<NSNumber*>* received;
+// Called with each message after it has been recorded.
+@property(copy, nonatomic) void (^handler)(NSUInteger index);
+@end
+
+@implementation InvokerTestTarget
+
+- (instancetype)init {
+  if ((self = [super init])) {
+    _received = [[NSMutableArray alloc] init];
+  }
+  return self;
+}
+
+- (void)receivedMessage:(NSUInteger)index {
+  [_received addObject:@(index)];
+  if (self.handler)
+    self.handler(index);
+}
+
+@end
+
+@interface BSProtocolThreadInvokerTest : XCTestCase
+@end
+
+@implementation BSProtocolThreadInvokerTest {
+  InvokerTestTarget* _target;
+}
+
+- (void)setUp {
+  [super setUp];
+  _target = [[InvokerTestTarget alloc] init];
+}
+
+- (BSProtocolThreadInvoker*)invokerBatching:(BOOL)batches {
+  BSProtocolThreadInvoker* invoker =
+      [[BSProtocolThreadInvoker alloc] initWithObject:_target
+                                             protocol:@protocol(InvokerTestDelegate)
+                                               thread:[NSThread currentThread]];
+  invoker.batchesMessages = batches;
+  // Let the invoker install its run loop observer.
+  [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+  return invoker;
+}
+
+// Sends |count| messages, numbered from |first|, from a background thread,
+// either as blocks or as forwarded messages.
+- (void)sendMessages:(NSUInteger)count
+           fromIndex:(NSUInteger)first
+           toInvoker:(BSProtocolThreadInvoker*)invoker
+            asBlocks:(BOOL)asBlocks {
+  dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    for (NSUInteger i = first; i < first + count; ++i) {
+      if (asBlocks) {
+        [invoker invokeBlock:^(id<InvokerTestDelegate> target) {
+          [target receivedMessage:i];
+        }];
+      } else {
+        [(id<InvokerTestDelegate>)invoker receivedMessage:i];
+      }
+    }
+  });
+}
+
+// Runs the run loop until |count| messages have been received.
+- (void)waitForMessages:(NSUInteger)count {
+  NSDate* deadline = [NSDate dateWithTimeIntervalSinceNow:10];
+  while (_target.received.count < count && [deadline timeIntervalSinceNow] > 0) {
+    [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode
+                             beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+  }
+  XCTAssertEqual(count, _target.received.count);
+}
+
+- (void)checkOrderFromSeveralThreadsBatching:(BOOL)batches {
+  BSProtocolThreadInvoker* invoker = [self invokerBatching:batches];
+  for (NSUInteger thread = 0; thread < 4; ++thread) {
+    [self sendMessages:500
+             fromIndex:thread * 1000
+             toInvoker:invoker
+              asBlocks:thread % 2 == 0];
+  }
+  [self waitForMessages:2000];
+
+  // The messages of each thread arrive in the order they were sent.
+  NSUInteger next[4] = { 0, 1000, 2000, 3000 };
+  for (NSNumber* index in _target.received) {
+    NSUInteger thread = index.unsignedIntegerValue / 1000;
+    XCTAssertEqual(next[thread], index.unsignedIntegerValue);
+    ++next[thread];
+  }
+}
+
+- (void)testOrderFromSeveralThreads {
+  [self checkOrderFromSeveralThreadsBatching:NO];
+}
+
+- (void)testBatchedOrderFromSeveralThreads {
+  [self checkOrderFromSeveralThreadsBatching:YES];
+}
+
+- (void)testBatchDeliveredInOnePass {
+  BSProtocolThreadInvoker* invoker = [self invokerBatching:YES];
+  for (NSUInteger i = 0; i < 100; ++i) {
+    [invoker invokeBlock:^(id<InvokerTestDelegate> target) {
+      [target receivedMessage:i];
+    }];
+  }
+  [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode
+                           beforeDate:[NSDate dateWithTimeIntervalSinceNow:1]];
+  XCTAssertEqual(100u, _target.received.count);
+}
+
+- (void)checkReentrancyBatching:(BOOL)batches {
+  BSProtocolThreadInvoker* invoker = [self invokerBatching:batches];
+
+  // The first message runs a nested run loop, during which no other message
+  // may be delivered.
+  __block NSUInteger receivedWhileNested = NSNotFound;
+  InvokerTestTarget* target = _target;
+  _target.handler = ^(NSUInteger index) {
+    if (index != 0)
+      return;
+    NSUInteger before = target.received.count;
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+    receivedWhileNested = target.received.count - before;
+  };
+
+  for (NSUInteger i = 0; i < 10; ++i)
+    [(id<InvokerTestDelegate>)invoker receivedMessage:i];
+  [self waitForMessages:10];
+
+  XCTAssertEqual(0u, receivedWhileNested);
+  XCTAssertEqualObjects((@[ @0, @1, @2, @3, @4, @5, @6, @7, @8, @9 ]), _target.received);
+  _target.handler = nil;
+}
+
+- (void)testReentrancy {
+  [self checkReentrancyBatching:NO];
+}
+
+- (void)testBatchedReentrancy {
+  [self checkReentrancyBatching:YES];
+}
+
+- (void)measureMessagesBatching:(BOOL)batches asBlocks:(BOOL)asBlocks {
+  BSProtocolThreadInvoker* invoker = [self invokerBatching:batches];
+  [self measureBlock:^{
+    [self->_target.received removeAllObjects];
+    [self sendMessages:kPerformanceMessageCount
+             fromIndex:0
+             toInvoker:invoker
+              asBlocks:asBlocks];
+    [self waitForMessages:kPerformanceMessageCount];
+  }];
+}
+
+- (void)testPerformanceForwarded {
+  [self measureMessagesBatching:NO asBlocks:NO];
+}
+
+- (void)testPerformanceBatchedForwarded {
+  [self measureMessagesBatching:YES asBlocks:NO];
+}
+
+- (void)testPerformanceBatchedBlocks {
+  [self measureMessagesBatching:YES asBlocks:YES];
+}
+
+@end
@@ -0,0 +1,608 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "DebuggerBackEnd.h"
+#import "DebuggerModel.h"
+#import "FakeDebuggerEngine.h"
+#import "LocalSourceFile.h"
+#import "PreferenceNames.h"
+#import "ProtocolMetrics.h"
+#import "SourceCache.h"
+#import "StackFrame.h"
+#import "VariableNode.h"
+
+@interface DebuggerBackEndTest : XCTestCase
+@end
+
+@implementation DebuggerBackEndTest {
+  DebuggerModel* _model;
+  DebuggerBackEnd* _backEnd;
+  FakeDebuggerEngine* _engine;
+}
+
+- (void)setUp {
+  [super setUp];
+  uint16_t port = 19000 + arc4random_uniform(1000);
+  _model = [[DebuggerModel alloc] init];
+  _backEnd = [[DebuggerBackEnd alloc] initWithModel:_model port:port autoAttach:YES];
+  _engine = [[FakeDebuggerEngine alloc] initWithPort:port];
+
+  [self keyValueObservingExpectationForObject:_model keyPath:@"connected" expectedValue:@YES];
+  [_engine connect];
+  [self waitForExpectationsWithTimeout:5 handler:nil];
+}
+
+- (void)tearDown {
+  _backEnd.autoAttach = NO;
+  [_engine disconnect];
+  [super tearDown];
+}
+
+// Steps the debugger and waits for the model's stack to be rebuilt.
+- (void)stepAndWaitForStack {
+  [self keyValueObservingExpectationForObject:_model keyPath:@"stack" handler:nil];
+  [_backEnd stepIn];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+}
+
+// Waits for the variables of all three contexts of the top frame to load.
+- (void)waitForTopFrameVariables {
+  StackFrame* frame = _model.stack.firstObject;
+  if (frame.variables.count == 3)
+    return;
+  [self keyValueObservingExpectationForObject:frame
+                                      keyPath:@"variables"
+                                      handler:^BOOL(id object, NSDictionary* change) {
+    return frame.variables.count == 3;
+  }];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+}
+
+// Waits until |predicate| returns YES.
+- (void)waitForPredicate:(BOOL (^)(void))predicate {
+  [self expectationForPredicate:[NSPredicate predicateWithBlock:^BOOL(id object, NSDictionary* bindings) {
+    return predicate();
+  }] evaluatedWithObject:self handler:nil];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+}
+
+// Steps, and then expands $n and the first element of each of its nested
+// arrays, |levels| deep, the way the outline view restores the variables that
+// were expanded before. Returns the number of property_get commands it took,
+// including those that reload what was expanded before the step.
+- (NSUInteger)stepAndExpandNestedArrays:(NSUInteger)levels {
+  NSMutableSet<NSString*>* expanded = [NSMutableSet set];
+  NSString* fullName = @"$n";
+  for (NSUInteger i = 0; i < levels; ++i) {
+    [expanded addObject:fullName];
+    fullName = [fullName stringByAppendingString:@"[0]"];
+  }
+  _backEnd.expandedVariables = expanded;
+
+  NSUInteger propertyGets = [_engine countOfCommand:@"property_get"];
+  [self stepAndWaitForStack];
+  StackFrame* frame = _model.stack.firstObject;
+  [self waitForPredicate:^BOOL{
+    return frame.variables.count == 4;
+  }];
+
+  VariableNode* node = frame.variables[1];
+  for (NSUInteger i = 0; i < levels; ++i) {
+    [_backEnd loadVariableNode:node forStackFrame:frame expandedDescendants:expanded];
+    [self waitForPredicate:^BOOL{
+      return node.childrenLoaded;
+    }];
+    node = node.children[0];
+  }
+  return [_engine countOfCommand:@"property_get"] - propertyGets;
+}
+
+- (void)assertStackOfDepth:(NSUInteger)depth {
+  XCTAssertEqual(depth, _model.stackDepth);
+  for (NSUInteger i = 0; i < MIN(depth, _model.stackDepth); ++i) {
+    StackFrame* frame = _model.stack[i];
+    XCTAssertEqual(i, frame.index);
+    XCTAssertEqualObjects(([NSString stringWithFormat:@"file:///var/www/app/frame%lu.php", i]), frame.filename);
+    XCTAssertEqual(i + 1, frame.lineNumber);
+    XCTAssertEqualObjects(([NSString stringWithFormat:@"Frame%lu", i]), frame.function);
+  }
+}
+
+- (void)testStackInOneRequest {
+  _engine.stackDepth = 5;
+  [self stepAndWaitForStack];
+  [self assertStackOfDepth:5];
+  XCTAssertEqual(0u, [_engine countOfCommand:@"stack_depth"]);
+  XCTAssertEqual(1u, [_engine countOfCommand:@"stack_get"]);
+}
+
+- (void)testStackPerFrame {
+  _backEnd.fetchesStackInOneRequest = NO;
+  _engine.stackDepth = 5;
+  [self stepAndWaitForStack];
+  [self assertStackOfDepth:5];
+  XCTAssertEqual(1u, [_engine countOfCommand:@"stack_depth"]);
+  XCTAssertEqual(5u, [_engine countOfCommand:@"stack_get"]);
+}
+
+- (void)testPrefetchTopFrameVariables {
+  _engine.stackDepth = 3;
+  [self stepAndWaitForStack];
+  [self waitForTopFrameVariables];
+
+  // The variables were requested along with the stack, before the frame was
+  // selected. The source is requested once the stack arrives.
+  NSArray<NSString*>* expected = @[
+    @"step_into", @"stack_get", @"context_names", @"source", @"context_get", @"context_get", @"context_get"
+  ];
+  XCTAssertEqualObjects(expected, _engine.commands);
+
+  StackFrame* frame = _model.stack.firstObject;
+  XCTAssertTrue(frame.loaded);
+  XCTAssertEqualObjects(@"$d0c0", frame.variables[0].name);
+  XCTAssertEqualObjects(@"$d0c2", frame.variables[2].name);
+
+  // Selecting the frame does not fetch it again.
+  [_backEnd loadStackFrame:frame];
+  XCTAssertEqual(expected.count, _engine.commands.count);
+
+  // The context names are cached, so the next step takes a single round-trip.
+  [self stepAndWaitForStack];
+  [self waitForTopFrameVariables];
+  XCTAssertEqual(1u, [_engine countOfCommand:@"context_names"]);
+  XCTAssertEqual(6u, [_engine countOfCommand:@"context_get"]);
+
+  // Other frames use the cached context names too.
+  StackFrame* caller = _model.stack[1];
+  XCTAssertFalse(caller.loaded);
+  [self keyValueObservingExpectationForObject:caller
+                                      keyPath:@"variables"
+                                      handler:^BOOL(id object, NSDictionary* change) {
+    return caller.variables.count == 3;
+  }];
+  [_backEnd loadStackFrame:caller];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+  XCTAssertEqual(1u, [_engine countOfCommand:@"context_names"]);
+  XCTAssertEqualObjects(@"$d1c1", caller.variables[1].name);
+}
+
+- (void)testSourceCache {
+  _engine.stackDepth = 2;
+  [self stepAndWaitForStack];
+  StackFrame* frame = _model.stack.firstObject;
+  if (!frame.source) {
+    [self keyValueObservingExpectationForObject:frame keyPath:@"source" handler:nil];
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+  }
+  XCTAssertEqualObjects(@"<?php\n// file:///var/www/app/frame0.php\n", frame.source);
+
+  // Stepping within the same file uses the cached source.
+  [self stepAndWaitForStack];
+  XCTAssertEqual(frame.source, _model.stack.firstObject.source);
+  XCTAssertEqual(1u, [_engine countOfCommand:@"source"]);
+  XCTAssertEqual(1u, _backEnd.sourceCache.hits);
+  XCTAssertEqual(1u, _backEnd.sourceCache.misses);
+}
+
+// Maps the engine's /var/www/app to a temporary directory holding frame0.php
+// with |contents|, and returns that file's path.
+- (NSString*)useLocalFrameFileWithContents:(NSString*)contents {
+  NSString* directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+  [[NSFileManager defaultManager] createDirectoryAtPath:directory
+                            withIntermediateDirectories:YES
+                                             attributes:nil
+                                                  error:NULL];
+  NSString* path = [directory stringByAppendingPathComponent:@"frame0.php"];
+  [contents writeToFile:path atomically:NO encoding:NSUTF8StringEncoding error:NULL];
+
+  [[NSUserDefaults standardUserDefaults] setObject:@[ @{ @"remote" : @"/var/www/app", @"local" : directory } ]
+                                            forKey:kPrefPathReplacements];
+  [self addTeardownBlock:^{
+    [[NSUserDefaults standardUserDefaults] removeObjectForKey:kPrefPathReplacements];
+    [[NSFileManager defaultManager] removeItemAtPath:directory error:NULL];
+  }];
+  return path;
+}
+
+- (void)testMatchingLocalFile {
+  NSString* path = [self useLocalFrameFileWithContents:@"<?php\n// file:///var/www/app/frame0.php\n"];
+  [self stepAndWaitForStack];
+  StackFrame* frame = _model.stack.firstObject;
+  [self waitForPredicate:^BOOL{
+    return frame.localFile != nil;
+  }];
+  XCTAssertEqualObjects(path, frame.localFile.path);
+  XCTAssertEqual(1u, [_engine countOfCommand:@"source"]);
+
+  // Once the local copy is known to match, it is used without a fetch.
+  [self stepAndWaitForStack];
+  XCTAssertEqualObjects(path, _model.stack.firstObject.localFile.path);
+  XCTAssertEqual(1u, [_engine countOfCommand:@"source"]);
+}
+
+- (void)testModifiedLocalFileIsRechecked {
+  NSString* contents = @"<?php\n// file:///var/www/app/frame0.php\n";
+  NSString* path = [self useLocalFrameFileWithContents:contents];
+  [self stepAndWaitForStack];
+  StackFrame* frame = _model.stack.firstObject;
+  [self waitForPredicate:^BOOL{
+    return frame.localFile != nil;
+  }];
+
+  // Editing the matching copy makes it stale, so the engine's source is used.
+  [@"<?php\n// Edited.\n" writeToFile:path atomically:NO encoding:NSUTF8StringEncoding error:NULL];
+  [self stepAndWaitForStack];
+  frame = _model.stack.firstObject;
+  [self waitForPredicate:^BOOL{
+    return frame.source != nil;
+  }];
+  XCTAssertNil(frame.localFile);
+  XCTAssertEqual(2u, [_engine countOfCommand:@"source"]);
+
+  // Reverting it is compared against the cached source without a fetch.
+  [contents writeToFile:path atomically:NO encoding:NSUTF8StringEncoding error:NULL];
+  [self stepAndWaitForStack];
+  XCTAssertEqualObjects(path, _model.stack.firstObject.localFile.path);
+  XCTAssertEqual(2u, [_engine countOfCommand:@"source"]);
+}
+
+- (void)testDifferentLocalFile {
+  [self useLocalFrameFileWithContents:@"<?php\n// A stale checkout.\n"];
+  [self stepAndWaitForStack];
+  StackFrame* frame = _model.stack.firstObject;
+  [self waitForPredicate:^BOOL{
+    return frame.source != nil;
+  }];
+  XCTAssertNil(frame.localFile);
+  XCTAssertEqualObjects(@"<?php\n// file:///var/www/app/frame0.php\n", frame.source);
+
+  [self stepAndWaitForStack];
+  XCTAssertNil(_model.stack.firstObject.localFile);
+  XCTAssertEqual(1u, [_engine countOfCommand:@"source"]);
+}
+
+- (void)testMetrics {
+  ProtocolMetrics* metrics = [[ProtocolMetrics alloc] init];
+  _backEnd.metrics = metrics;
+  _engine.roundTripTime = 0.050;
+  [self stepAndWaitForStack];
+
+  // The round trip is counted as waiting for the first byte, not as the
+  // client's time to parse and handle the response.
+  CommandMetrics* stack = [metrics metricsForCommand:@"stack_get"];
+  XCTAssertGreaterThanOrEqual(stack.count, 1u);
+  XCTAssertGreaterThan(stack.responseBytes, 0u);
+  XCTAssertGreaterThanOrEqual(stack.timeToFirstByte.sum, stack.count * 0.050);
+  XCTAssertLessThan(stack.parseTime.max, 0.050);
+  XCTAssertLessThan(stack.handlerTime.max, 0.050);
+  XCTAssertNotNil([metrics metricsForCommand:@"step_into"]);
+
+  NSArray<TransactionMetrics*>* slowest = metrics.slowestTransactions;
+  XCTAssertGreaterThan(slowest.count, 0u);
+  XCTAssertGreaterThanOrEqual(slowest.firstObject.totalTime, slowest.lastObject.totalTime);
+}
+
+- (void)testLoadVariablePages {
+  _engine.arrayLength = 1000;
+  [self stepAndWaitForStack];
+  StackFrame* frame = _model.stack.firstObject;
+  [self keyValueObservingExpectationForObject:frame
+                                      keyPath:@"variables"
+                                      handler:^BOOL(id object, NSDictionary* change) {
+    return frame.variables.count == 4;
+  }];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+
+  VariableNode* array = frame.variables[1];
+  XCTAssertEqualObjects(@"$a", array.name);
+  XCTAssertEqual(1000u, array.childCount);
+  XCTAssertEqual(1000u, array.children.count);
+  XCTAssertEqualObjects(@"$a[31]", array.children[31].fullName);
+  XCTAssertTrue(array.children[500].isPlaceholder);
+
+  // The first page came with the context, so expanding it fetches nothing.
+  [_backEnd loadVariableNode:array forStackFrame:frame];
+  XCTAssertEqual(0u, [_engine countOfCommand:@"property_get"]);
+
+  // Showing a placeholder fetches only its page, once.
+  NSUInteger page = [array pageForChildAtIndex:500];
+  [self keyValueObservingExpectationForObject:array keyPath:@"children" handler:nil];
+  [_backEnd loadPage:page ofVariableNode:array forStackFrame:frame];
+  [_backEnd loadPage:page ofVariableNode:array forStackFrame:frame];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+  XCTAssertEqualObjects(@"$a[500]", array.children[500].fullName);
+  XCTAssertTrue(array.children[400].isPlaceholder);
+  XCTAssertEqual(1u, [_engine countOfCommand:@"property_get"]);
+}
+
+- (void)testFailedPageCanBeRequestedAgain {
+  _engine.arrayLength = 1000;
+  [self stepAndWaitForStack];
+  StackFrame* frame = _model.stack.firstObject;
+  [self waitForPredicate:^BOOL{
+    return frame.variables.count == 4;
+  }];
+  VariableNode* array = frame.variables[1];
+  NSUInteger page = [array pageForChildAtIndex:500];
+
+  // The property went away, so the page stays a placeholder and the error is
+  // reported.
+  _engine.missingProperty = @"$a";
+  [_backEnd loadPage:page ofVariableNode:array forStackFrame:frame];
+  [self waitForPredicate:^BOOL{
+    return self->_model.lastError != nil;
+  }];
+  XCTAssertEqualObjects(@"can not get property", _model.lastError);
+  XCTAssertTrue([array needsPage:page]);
+  XCTAssertTrue(array.children[500].isPlaceholder);
+
+  _engine.missingProperty = nil;
+  [_backEnd loadPage:page ofVariableNode:array forStackFrame:frame];
+  [self waitForPredicate:^BOOL{
+    return !array.children[500].isPlaceholder;
+  }];
+  XCTAssertEqual(2u, [_engine countOfCommand:@"property_get"]);
+}
+
+- (void)testFailedSubtreeCanBeRequestedAgain {
+  _engine.nestingLevels = 3;
+  [self stepAndWaitForStack];
+  StackFrame* frame = _model.stack.firstObject;
+  [self waitForPredicate:^BOOL{
+    return frame.variables.count == 4;
+  }];
+  VariableNode* node = frame.variables[1];
+  NSSet<NSString*>* expanded = [NSSet setWithObjects:@"$n", @"$n[0]", nil];
+
+  _engine.missingProperty = @"$n";
+  [_backEnd loadVariableNode:node forStackFrame:frame expandedDescendants:expanded];
+  [self waitForPredicate:^BOOL{
+    return self->_model.lastError != nil;
+  }];
+  XCTAssertTrue([node needsPage:0]);
+
+  _engine.missingProperty = nil;
+  [_backEnd loadVariableNode:node forStackFrame:frame expandedDescendants:expanded];
+  [self waitForPredicate:^BOOL{
+    return node.childrenLoaded;
+  }];
+}
+
+- (void)testFailedPrefetchIsNotReported {
+  _engine.nestingLevels = 4;
+  _engine.supportsMaxDepth = NO;
+  _engine.roundTripTime = 0.1;
+  [self stepAndWaitForStack];
+  StackFrame* frame = _model.stack.firstObject;
+  [self waitForPredicate:^BOOL{
+    return frame.variables.count == 4;
+  }];
+  VariableNode* node = frame.variables[1];
+  NSSet<NSString*>* expanded = [NSSet setWithObjects:@"$n", @"$n[0]", @"$n[0][0]", nil];
+
+  // The descendants are prefetched once $n arrives, and went away. $n[0] is
+  // expanded while its prefetch is in flight.
+  _engine.missingProperty = @"$n[0]";
+  [_backEnd loadVariableNode:node forStackFrame:frame expandedDescendants:expanded];
+  [self waitForPredicate:^BOOL{
+    return node.childrenLoaded;
+  }];
+  VariableNode* child = node.children[0];
+  [_backEnd loadVariableNode:child forStackFrame:frame expandedDescendants:expanded];
+  XCTAssertFalse([child needsPage:0]);
+  [self waitForPredicate:^BOOL{
+    return [child needsPage:0];
+  }];
+  XCTAssertNil(_model.lastError);
+
+  _engine.missingProperty = nil;
+  [_backEnd loadVariableNode:child forStackFrame:frame expandedDescendants:expanded];
+  [self waitForPredicate:^BOOL{
+    return child.childrenLoaded;
+  }];
+}
+
+- (void)testStepReusesVariables {
+  _engine.arrayLength = 1000;
+  _backEnd.expandedVariables = [NSSet setWithObject:@"$a"];
+  [self stepAndWaitForStack];
+  StackFrame* frame = _model.stack.firstObject;
+  [self keyValueObservingExpectationForObject:frame
+                                      keyPath:@"variables"
+                                      handler:^BOOL(id object, NSDictionary* change) {
+    return frame.variables.count == 4;
+  }];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+
+  VariableNode* scalar = frame.variables[0];
+  VariableNode* array = frame.variables[1];
+  NSUInteger page = [array pageForChildAtIndex:500];
+  [self keyValueObservingExpectationForObject:array keyPath:@"children" handler:nil];
+  [_backEnd loadPage:page ofVariableNode:array forStackFrame:frame];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+  VariableNode* element = array.children[500];
+
+  // After the step, the page that was loaded is fetched again, and the
+  // variables whose values are the same are reused.
+  [self stepAndWaitForStack];
+  StackFrame* newFrame = _model.stack.firstObject;
+  XCTAssertNotEqual(frame, newFrame);
+  [self expectationForPredicate:[NSPredicate predicateWithBlock:^BOOL(id object, NSDictionary* bindings) {
+    return newFrame.variables.count == 4 && !newFrame.variables[1].children[500].isPlaceholder;
+  }] evaluatedWithObject:self handler:nil];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+
+  XCTAssertEqual(scalar, newFrame.variables[0]);
+  XCTAssertFalse(scalar.changed);
+  VariableNode* newArray = newFrame.variables[1];
+  XCTAssertNotEqual(array, newArray);
+  XCTAssertFalse(newArray.changed);
+  XCTAssertEqual(element, newArray.children[500]);
+  XCTAssertEqual(newArray, element.parent);
+  XCTAssertTrue(newArray.children[400].isPlaceholder);
+  XCTAssertEqual(2u, [_engine countOfCommand:@"property_get"]);
+}
+
+- (void)testStepDoesNotReloadCollapsedVariables {
+  _engine.arrayLength = 1000;
+  NSMutableSet<NSString*>* expanded = [NSMutableSet setWithObject:@"$a"];
+  _backEnd.expandedVariables = expanded;
+  [self stepAndWaitForStack];
+  StackFrame* frame = _model.stack.firstObject;
+  [self waitForPredicate:^BOOL{
+    return frame.variables.count == 4;
+  }];
+
+  VariableNode* array = frame.variables[1];
+  [self keyValueObservingExpectationForObject:array keyPath:@"children" handler:nil];
+  [_backEnd loadPage:[array pageForChildAtIndex:500] ofVariableNode:array forStackFrame:frame];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+
+  // Once collapsed, the array's pages are not fetched again after a step, but
+  // only when it is next expanded.
+  [expanded removeObject:@"$a"];
+  NSUInteger propertyGets = [_engine countOfCommand:@"property_get"];
+  [self stepAndWaitForStack];
+  StackFrame* newFrame = _model.stack.firstObject;
+  [self waitForPredicate:^BOOL{
+    return newFrame.variables.count == 4;
+  }];
+  VariableNode* newArray = newFrame.variables[1];
+  NSUInteger page = [newArray pageForChildAtIndex:500];
+  XCTAssertTrue([newArray needsPage:page]);
+
+  // The engine handles commands in order, so once the page fetched on
+  // expansion arrives, any reload would have been counted.
+  [_backEnd loadPage:page ofVariableNode:newArray forStackFrame:newFrame];
+  [self waitForPredicate:^BOOL{
+    return [newArray childrenOfPage:page].count > 0;
+  }];
+  XCTAssertEqual(propertyGets + 1, [_engine countOfCommand:@"property_get"]);
+}
+
+- (void)assertStepReusesVariables:(BOOL)reuses afterChangingDepth:(NSUInteger)depth {
+  [self stepAndWaitForStack];
+  StackFrame* frame = _model.stack.firstObject;
+  [self waitForTopFrameVariables];
+  VariableNode* scalar = frame.variables[0];
+
+  _engine.stackDepth = depth;
+  [self stepAndWaitForStack];
+  [self assertStackOfDepth:depth];
+  StackFrame* newFrame = _model.stack.firstObject;
+  [self waitForTopFrameVariables];
+  XCTAssertEqual(reuses, scalar == newFrame.variables[0]);
+  XCTAssertFalse(newFrame.variables[0].changed);
+}
+
+- (void)testStepInSameFrameReusesVariables {
+  [self assertStepReusesVariables:YES afterChangingDepth:1];
+}
+
+- (void)testStepIntoOtherFrameDoesNotReuseVariables {
+  [self assertStepReusesVariables:NO afterChangingDepth:2];
+}
+
+- (void)testStepOutPerFrameDoesNotReuseVariables {
+  _backEnd.fetchesStackInOneRequest = NO;
+  _engine.stackDepth = 3;
+  [self assertStepReusesVariables:NO afterChangingDepth:2];
+}
+
+- (void)testBatchedExpansion {
+  _engine.nestingLevels = 6;
+  // The first level comes with the context. The next three come in one
+  // property_get, and the last two in another.
+  XCTAssertEqual(2u, [self stepAndExpandNestedArrays:6]);
+  XCTAssertEqual(4u, [_engine countOfCommand:@"feature_set"]);
+
+  // After a step, what was expanded is reloaded in the same batches.
+  XCTAssertEqual(2u, [self stepAndExpandNestedArrays:6]);
+  XCTAssertEqual(8u, [_engine countOfCommand:@"feature_set"]);
+}
+
+- (void)testUnbatchedExpansion {
+  _engine.nestingLevels = 6;
+  _backEnd.batchesVariableExpansion = NO;
+  XCTAssertEqual(5u, [self stepAndExpandNestedArrays:6]);
+  XCTAssertEqual(0u, [_engine countOfCommand:@"feature_set"]);
+}
+
+- (void)testExpansionWithoutMaxDepth {
+  _engine.nestingLevels = 6;
+  _engine.supportsMaxDepth = NO;
+  // After the first property_get, the rest are sent together.
+  XCTAssertEqual(5u, [self stepAndExpandNestedArrays:6]);
+  XCTAssertEqual(2u, [_engine countOfCommand:@"feature_set"]);
+
+  // Having found that max_depth is ignored, the reload after the next step
+  // does not try it.
+  XCTAssertEqual(5u, [self stepAndExpandNestedArrays:6]);
+  XCTAssertEqual(2u, [_engine countOfCommand:@"feature_set"]);
+}
+
+// Simulates stepping through a deep framework stack over a slow tunnel.
+- (void)configureForPerformance {
+  _engine.stackDepth = 60;
+  _engine.roundTripTime = 0.020;
+  _engine.processingTime = 0.0005;
+}
+
+- (void)testPerformanceStackInOneRequest {
+  [self configureForPerformance];
+  [self measureBlock:^{
+    [self stepAndWaitForStack];
+  }];
+  [self assertStackOfDepth:60];
+}
+
+- (void)testPerformanceTimeToVariables {
+  [self configureForPerformance];
+  [self measureBlock:^{
+    [self stepAndWaitForStack];
+    [self waitForTopFrameVariables];
+  }];
+}
+
+- (void)testPerformanceStackPerFrame {
+  [self configureForPerformance];
+  _backEnd.fetchesStackInOneRequest = NO;
+  [self measureBlock:^{
+    [self stepAndWaitForStack];
+  }];
+  [self assertStackOfDepth:60];
+}
+
+- (void)testPerformanceBatchedExpansion {
+  [self configureForPerformance];
+  _engine.nestingLevels = 8;
+  [self measureBlock:^{
+    XCTAssertEqual(3u, [self stepAndExpandNestedArrays:8]);
+  }];
+}
+
+- (void)testPerformanceUnbatchedExpansion {
+  [self configureForPerformance];
+  _engine.nestingLevels = 8;
+  _backEnd.batchesVariableExpansion = NO;
+  [self measureBlock:^{
+    XCTAssertEqual(7u, [self stepAndExpandNestedArrays:8]);
+  }];
+}
+
+@end
@@ -0,0 +1,45 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Foundation/Foundation.h>
+
+// EngineSocket is the engine's end of a DBGp connection, for the simulated
+// engines of the tests and benchmarks. It connects to the port on which a
+// MessageQueue is listening, like Xdebug would, and then reads the commands
+// that the client sends and writes the engine's messages back. It is not
+// thread-safe: it must only be used on the serial |queue| on which it reads.
+@interface EngineSocket : NSObject
+
+// Whether the socket is connected.
+@property(readonly, nonatomic, getter=isOpen) BOOL open;
+
+// |commandHandler| is invoked on |queue| with each command that is received.
+- (instancetype)initWithPort:(uint16_t)port
+                       queue:(dispatch_queue_t)queue
+              commandHandler:(void (^)(NSString* command))commandHandler;
+
+// Connects to the port, retrying for a few seconds until the listening socket
+// is open. Returns NO if it could not connect.
+- (BOOL)open;
+
+// Closes the connection, which also happens when the client closes it.
+- (void)close;
+
+// Writes |message| with the DBGp framing. Returns the number of bytes written,
+// including the framing.
+- (NSUInteger)writeMessage:(NSData*)message;
+
+@end
@@ -0,0 +1,139 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "EngineSocket.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#import "ResponseFixtures.h"
+
+@implementation EngineSocket {
+  uint16_t _port;
+  int _socket;
+  dispatch_queue_t _queue;
+  dispatch_source_t _readSource;
+  void (^_commandHandler)(NSString*);
+
+  // Bytes read from the socket that do not yet form a whole command.
+  NSMutableData* _readBuffer;
+}
+
+- (instancetype)initWithPort:(uint16_t)port
+                       queue:(dispatch_queue_t)queue
+              commandHandler:(void (^)(NSString* command))commandHandler {
+  if ((self = [super init])) {
+    _port = port;
+    _socket = -1;
+    _queue = queue;
+    _commandHandler = [commandHandler copy];
+    _readBuffer = [[NSMutableData alloc] init];
+  }
+  return self;
+}
+
+- (BOOL)isOpen {
+  return _socket >= 0;
+}
+
+- (BOOL)open {
+  struct sockaddr_in address = {0};
+  address.sin_len = sizeof(address);
+  address.sin_family = AF_INET;
+  address.sin_port = htons(_port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  // The MessageQueue opens its listening socket asynchronously, so retry for
+  // a few seconds.
+  for (int attempt = 0; attempt < 500; ++attempt) {
+    _socket = socket(PF_INET, SOCK_STREAM, 0);
+    if (connect(_socket, (struct sockaddr*)&address, sizeof(address)) == 0)
+      break;
+    close(_socket);
+    _socket = -1;
+    usleep(10000);
+  }
+  if (_socket < 0)
+    return NO;
+
+  _readSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, _socket, 0, _queue);
+  dispatch_source_set_event_handler(_readSource, ^{
+    [self readCommands];
+  });
+  // The socket may only be closed once the source has stopped monitoring it.
+  int fd = _socket;
+  dispatch_source_set_cancel_handler(_readSource, ^{
+    close(fd);
+  });
+  dispatch_resume(_readSource);
+  return YES;
+}
+
+- (void)close {
+  // Cancelling the source closes the socket.
+  if (_readSource) {
+    dispatch_source_cancel(_readSource);
+    _readSource = nil;
+  }
+  _socket = -1;
+  [_readBuffer setLength:0];
+}
+
+- (NSUInteger)writeMessage:(NSData*)message {
+  if (_socket < 0)
+    return 0;
+  NSData* packet = MakePacket(message);
+  const uint8_t* bytes = packet.bytes;
+  size_t written = 0;
+  while (written < packet.length) {
+    ssize_t rv = write(_socket, bytes + written, packet.length - written);
+    if (rv <= 0)
+      break;
+    written += rv;
+  }
+  return written;
+}
+
+// Private /////////////////////////////////////////////////////////////////////
+
+- (void)readCommands {
+  char buffer[4096];
+  ssize_t bytesRead = read(_socket, buffer, sizeof(buffer));
+  if (bytesRead <= 0) {
+    [self close];
+    return;
+  }
+  [_readBuffer appendBytes:buffer length:bytesRead];
+
+  // Commands are terminated by a NUL byte.
+  const char* bytes = _readBuffer.bytes;
+  NSUInteger start = 0;
+  for (NSUInteger i = 0; i < _readBuffer.length; ++i) {
+    if (bytes[i] != '\0')
+      continue;
+    _commandHandler([[NSString alloc] initWithBytes:bytes + start
+                                             length:i - start
+                                           encoding:NSUTF8StringEncoding]);
+    // The handler may have closed the socket.
+    if (_socket < 0)
+      return;
+    start = i + 1;
+  }
+  [_readBuffer replaceBytesInRange:NSMakeRange(0, start) withBytes:NULL length:0];
+}
+
+@end
@@ -0,0 +1,78 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Foundation/Foundation.h>
+
+// FakeDebuggerEngine simulates an Xdebug engine for tests and benchmarks. It
+// connects to a MessageQueue listening on a port, sends the init packet, and
+// answers the commands that the DebuggerBackEnd sends. Commands are processed
+// one at a time, and each response is delayed to simulate the network.
+@interface FakeDebuggerEngine : NSObject
+
+// The simulated time for a command to reach the engine and its response to
+// come back.
+@property(assign, atomic) NSTimeInterval roundTripTime;
+
+// The simulated time for the engine to process a single command.
+@property(assign, atomic) NSTimeInterval processingTime;
+
+// The number of frames on the simulated stack. Each frame has three contexts,
+// which each contain one variable.
+@property(assign, atomic) NSUInteger stackDepth;
+
+// The number of elements in the array $a, which is added to the locals of
+// every frame when nonzero. Its elements are sent in pages of 32.
+@property(assign, atomic) NSUInteger arrayLength;
+
+// The number of nested arrays under $n, which is added to the locals of
+// every frame when nonzero. See MakeNestedProperty().
+@property(assign, atomic) NSUInteger nestingLevels;
+
+// Whether feature_set succeeds for max_depth, which sets how many levels of
+// children property_get returns. Defaults to YES.
+@property(assign, atomic) BOOL supportsMaxDepth;
+
+// The number of string variables $g0, $g1, ... in the Superglobals context of
+// every frame, for large context_get responses.
+@property(assign, atomic) NSUInteger globalsCount;
+
+// If set, property_get of this variable or any of its descendants responds
+// with error 300, as when the property no longer exists.
+@property(copy, atomic) NSString* missingProperty;
+
+// The contents sent in response to every source command. If nil, a short
+// script naming the requested file is sent.
+@property(copy, atomic) NSString* source;
+
+// The number of bytes written to the client, including the packet framing.
+@property(readonly, atomic) NSUInteger bytesWritten;
+
+// The names of the commands received, in order.
+@property(readonly, atomic) NSArray<NSString*>* commands;
+
+- (instancetype)initWithPort:(uint16_t)port;
+
+// Connects to the port asynchronously, retrying until the listening socket is
+// open, and then sends the init packet.
+- (void)connect;
+
+// Closes the connection. This must be called before the engine is released.
+- (void)disconnect;
+
+// Returns the number of times |command| has been received.
+- (NSUInteger)countOfCommand:(NSString*)command;
+
+@end
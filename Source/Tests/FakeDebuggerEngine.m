@@ -0,0 +1,204 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "FakeDebuggerEngine.h"
+
+#import "EngineSocket.h"
+#import "ResponseFixtures.h"
+
+// The number of children in each page of a property.
+static const NSUInteger kPageSize = 32;
+
+// Returns the value of the |-flag| argument in |arguments|, or nil.
+static NSString* ArgumentValue(NSArray<NSString*>* arguments, NSString* flag) {
+  NSUInteger index = [arguments indexOfObject:flag];
+  if (index == NSNotFound || index + 1 >= arguments.count)
+    return nil;
+  return arguments[index + 1];
+}
+
+@implementation FakeDebuggerEngine {
+  uint16_t _port;
+
+  // All socket I/O and command processing happens on this serial queue.
+  dispatch_queue_t _queue;
+  EngineSocket* _socket;
+
+  // Responses that have been generated but not yet delivered, oldest first.
+  NSMutableArray<NSData*>* _pendingResponses;
+
+  // When the engine will have finished processing the last received command.
+  dispatch_time_t _busyUntil;
+
+  NSMutableArray<NSString*>* _commands;
+
+  // The value of the max_depth feature.
+  NSUInteger _maxDepth;
+}
+
+- (instancetype)initWithPort:(uint16_t)port {
+  if ((self = [super init])) {
+    _port = port;
+    _queue = dispatch_queue_create("org.bluestatic.MacGDBp.FakeDebuggerEngine", DISPATCH_QUEUE_SERIAL);
+    __weak FakeDebuggerEngine* weakSelf = self;
+    _socket = [[EngineSocket alloc] initWithPort:port queue:_queue commandHandler:^(NSString* command) {
+      [weakSelf processCommand:command];
+    }];
+    _pendingResponses = [[NSMutableArray alloc] init];
+    _commands = [[NSMutableArray alloc] init];
+    _stackDepth = 1;
+    _supportsMaxDepth = YES;
+    _maxDepth = 1;
+  }
+  return self;
+}
+
+- (NSArray<NSString*>*)commands {
+  __block NSArray<NSString*>* commands;
+  dispatch_sync(_queue, ^{ commands = [self->_commands copy]; });
+  return commands;
+}
+
+- (NSUInteger)countOfCommand:(NSString*)command {
+  NSUInteger count = 0;
+  for (NSString* received in self.commands) {
+    if ([received isEqualToString:command])
+      ++count;
+  }
+  return count;
+}
+
+- (void)connect {
+  dispatch_async(_queue, ^{
+    [self openSocket];
+  });
+}
+
+- (void)disconnect {
+  dispatch_sync(_queue, ^{ [self closeSocket]; });
+}
+
+// Private /////////////////////////////////////////////////////////////////////
+
+- (void)openSocket {
+  if (![_socket open]) {
+    NSLog(@"FakeDebuggerEngine could not connect to port %d", _port);
+    return;
+  }
+
+  _busyUntil = dispatch_time(DISPATCH_TIME_NOW, 0);
+  NSString* init =
+      @"<?xml version=\"1.0\" encoding=\"iso-8859-1\"?>\n"
+      @"<init xmlns=\"urn:debugger_protocol_v1\" fileuri=\"file:///var/www/index.php\" "
+      @"language=\"PHP\" protocol_version=\"1.0\" appid=\"1\" idekey=\"macgdbp\"></init>";
+  [self enqueueResponse:[init dataUsingEncoding:NSUTF8StringEncoding]];
+}
+
+- (void)closeSocket {
+  [_socket close];
+  [_pendingResponses removeAllObjects];
+}
+
+- (void)processCommand:(NSString*)command {
+  NSArray<NSString*>* arguments = [command componentsSeparatedByString:@" "];
+  NSString* name = arguments.firstObject;
+  NSInteger transactionID = [ArgumentValue(arguments, @"-i") integerValue];
+  [_commands addObject:name];
+
+  NSString* attributes = @"";
+  NSMutableString* body = [NSMutableString string];
+  if ([name isEqualToString:@"run"] || [name hasPrefix:@"step_"]) {
+    attributes = @" status=\"break\" reason=\"ok\"";
+  } else if ([name isEqualToString:@"stack_depth"]) {
+    attributes = [NSString stringWithFormat:@" depth=\"%lu\"", self.stackDepth];
+  } else if ([name isEqualToString:@"stack_get"]) {
+    NSString* depth = ArgumentValue(arguments, @"-d");
+    NSUInteger first = depth ? [depth integerValue] : 0;
+    NSUInteger last = depth ? first + 1 : self.stackDepth;
+    for (NSUInteger i = first; i < last; ++i) {
+      [body appendString:MakeStackElement(i,
+          [NSString stringWithFormat:@"file:///var/www/app/frame%lu.php", i],
+          i + 1,
+          [NSString stringWithFormat:@"Frame%lu", i])];
+    }
+  } else if ([name isEqualToString:@"source"]) {
+    NSString* source = self.source ?: [NSString stringWithFormat:@"<?php\n// %@\n", ArgumentValue(arguments, @"-f")];
+    attributes = @" encoding=\"base64\"";
+    [body appendString:[[source dataUsingEncoding:NSUTF8StringEncoding] base64EncodedStringWithOptions:0]];
+  } else if ([name isEqualToString:@"context_names"]) {
+    [body appendString:@"<context name=\"Locals\" id=\"0\"></context>"
+                       @"<context name=\"Superglobals\" id=\"1\"></context>"
+                       @"<context name=\"User defined constants\" id=\"2\"></context>"];
+  } else if ([name isEqualToString:@"context_get"]) {
+    // Each context has a single variable, named for the frame and context.
+    NSString* variable = [NSString stringWithFormat:@"$d%@c%@",
+        ArgumentValue(arguments, @"-d"), ArgumentValue(arguments, @"-c")];
+    [body appendFormat:@"<property name=\"%@\" fullname=\"%@\" type=\"int\"><![CDATA[1]]></property>",
+        variable, variable];
+    if (self.arrayLength && [ArgumentValue(arguments, @"-c") integerValue] == 0)
+      [body appendString:MakeArrayProperty(self.arrayLength, 0, kPageSize)];
+    if (self.nestingLevels && [ArgumentValue(arguments, @"-c") integerValue] == 0)
+      [body appendString:MakeNestedProperty(@"$n", @"$n", self.nestingLevels, _maxDepth)];
+    if ([ArgumentValue(arguments, @"-c") integerValue] == 1)
+      [body appendString:MakeStringProperties(@"$g", self.globalsCount)];
+  } else if ([name isEqualToString:@"feature_set"]) {
+    BOOL success = self.supportsMaxDepth && [ArgumentValue(arguments, @"-n") isEqualToString:@"max_depth"];
+    if (success)
+      _maxDepth = [ArgumentValue(arguments, @"-v") integerValue];
+    attributes = [NSString stringWithFormat:@" feature=\"%@\" success=\"%d\"",
+        ArgumentValue(arguments, @"-n"), success];
+  } else if ([name isEqualToString:@"property_get"]) {
+    NSString* fullName = ArgumentValue(arguments, @"-n");
+    NSString* missing = self.missingProperty;
+    if (missing && [fullName hasPrefix:missing]) {
+      [body appendString:@"<error code=\"300\"><message><![CDATA[can not get property]]></message></error>"];
+    } else if ([fullName hasPrefix:@"$n"]) {
+      // Each [0] is one level further down.
+      NSUInteger level = ([fullName length] - 2) / 3;
+      [body appendString:MakeNestedProperty(fullName, fullName, self.nestingLevels - level, _maxDepth)];
+    } else {
+      NSUInteger page = [ArgumentValue(arguments, @"-p") integerValue];
+      [body appendString:MakeArrayProperty(self.arrayLength, page, kPageSize)];
+    }
+  }
+  [self enqueueResponse:MakeResponse(name, transactionID, attributes, body)];
+}
+
+// Schedules |message| to be written once the engine has processed it and it
+// has crossed the simulated network.
+- (void)enqueueResponse:(NSData*)message {
+  dispatch_time_t now = dispatch_time(DISPATCH_TIME_NOW, 0);
+  if (_busyUntil < now)
+    _busyUntil = now;
+  _busyUntil = dispatch_time(_busyUntil, self.processingTime * NSEC_PER_SEC);
+
+  [_pendingResponses addObject:message];
+  dispatch_after(dispatch_time(_busyUntil, self.roundTripTime * NSEC_PER_SEC), _queue, ^{
+    [self writeNextResponse];
+  });
+}
+
+// Writes the oldest pending response. Since the delivery times are
+// increasing, this keeps the responses in order even if timers fire together.
+- (void)writeNextResponse {
+  if (!_socket.open || _pendingResponses.count == 0)
+    return;
+  NSData* message = _pendingResponses.firstObject;
+  [_pendingResponses removeObjectAtIndex:0];
+  _bytesWritten += [_socket writeMessage:message];
+}
+
+@end
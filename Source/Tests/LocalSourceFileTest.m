@@ -0,0 +1,82 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "LocalSourceFile.h"
+#import "ResponseFixtures.h"
+
+@interface LocalSourceFileTest : XCTestCase
+@end
+
+@implementation LocalSourceFileTest
+
+- (void)testLocalPathForRemoteURI {
+  NSArray* replacements = @[
+    @{ @"remote" : @"/var/www", @"local" : @"/Users/dev/Sites" },
+  ];
+  XCTAssertEqualObjects(@"/Users/dev/Sites/app/index.php",
+      [LocalSourceFile localPathForRemoteURI:@"file:///var/www/app/index.php" replacements:replacements]);
+  XCTAssertEqualObjects(@"/srv/index.php",
+      [LocalSourceFile localPathForRemoteURI:@"file:///srv/index.php" replacements:replacements]);
+  XCTAssertEqualObjects(@"/var/www/space name.php",
+      [LocalSourceFile localPathForRemoteURI:@"file:///var/www/space%20name.php" replacements:@[]]);
+  XCTAssertNil([LocalSourceFile localPathForRemoteURI:@"dbgp://1" replacements:replacements]);
+}
+
+- (void)testReadsFile {
+  NSString* path = [[@__FILE__ stringByDeletingLastPathComponent]
+      stringByAppendingPathComponent:@"../../dev/tests/Cyrillic-array-key.php"];
+  LocalSourceFile* file = [LocalSourceFile fileAtPath:path error:NULL];
+  XCTAssertNotNil(file);
+  XCTAssertEqualObjects(ReadTestScript(@"Cyrillic-array-key.php"), file.string);
+  XCTAssertEqual([file.string lengthOfBytesUsingEncoding:NSUTF8StringEncoding], file.size);
+  XCTAssertNotNil(file.modificationDate);
+  XCTAssertFalse([file isModified]);
+}
+
+- (void)testIsModified {
+  NSString* path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+  [@"<?php echo 1;" writeToFile:path atomically:NO encoding:NSUTF8StringEncoding error:NULL];
+  LocalSourceFile* file = [LocalSourceFile fileAtPath:path error:NULL];
+  XCTAssertFalse([file isModified]);
+
+  [@"<?php echo 10;" writeToFile:path atomically:NO encoding:NSUTF8StringEncoding error:NULL];
+  XCTAssertTrue([file isModified]);
+  XCTAssertEqualObjects(@"<?php echo 1;", file.string);
+
+  [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+  XCTAssertTrue([file isModified]);
+}
+
+- (void)testFileForRemoteURI {
+  NSString* script = [[@__FILE__ stringByDeletingLastPathComponent]
+      stringByAppendingPathComponent:@"../../dev/tests/static.php"];
+  NSString* uri = [[NSURL fileURLWithPath:[script stringByStandardizingPath]] absoluteString];
+  LocalSourceFile* file = [LocalSourceFile fileForRemoteURI:uri];
+  XCTAssertNotNil(file);
+  XCTAssertEqualObjects(ReadTestScript(@"static.php"), file.string);
+
+  XCTAssertNil([LocalSourceFile fileForRemoteURI:@"file:///nonexistent/index.php"]);
+}
+
+- (void)testMissingFile {
+  NSError* error = nil;
+  XCTAssertNil([LocalSourceFile fileAtPath:@"/nonexistent/index.php" error:&error]);
+  XCTAssertNotNil(error);
+}
+
+@end
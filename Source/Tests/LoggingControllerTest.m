@@ -0,0 +1,155 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "LoggingController.h"
+#import "PreferenceNames.h"
+
+static LogEntry* MakeEntry(NSString* contents) {
+  return [LogEntry newReceiveEntryWithData:[contents dataUsingEncoding:NSUTF8StringEncoding]];
+}
+
+// Creates a log that captures whole messages, regardless of the preference.
+static LoggingController* MakeLog(NSUInteger capacity, NSUInteger byteBudget) {
+  LoggingController* log = [[LoggingController alloc] initWithCapacity:capacity byteBudget:byteBudget];
+  log.captureLevel = kLogCaptureFull;
+  return log;
+}
+
+static NSArray* Contents(LoggingController* log) {
+  return [log.logEntries valueForKey:@"contents"];
+}
+
+@interface LoggingControllerTest : XCTestCase
+@end
+
+@implementation LoggingControllerTest {
+  NSUInteger _updates;
+}
+
+- (void)observeValueForKeyPath:(NSString*)keyPath
+                      ofObject:(id)object
+                        change:(NSDictionary*)change
+                       context:(void*)context {
+  ++_updates;
+}
+
+- (void)testOverwritesOldestEntries {
+  LoggingController* log = MakeLog(3, 1024);
+  for (NSString* contents in @[ @"a", @"b", @"c", @"d", @"e" ])
+    [log recordEntry:MakeEntry(contents)];
+  XCTAssertEqualObjects((@[ @"c", @"d", @"e" ]), Contents(log));
+  XCTAssertEqual(3u, log.byteCount);
+
+  [log removeAllEntries];
+  XCTAssertEqual(0u, log.logEntries.count);
+  XCTAssertEqual(0u, log.byteCount);
+  [log recordEntry:MakeEntry(@"f")];
+  XCTAssertEqualObjects((@[ @"f" ]), Contents(log));
+}
+
+- (void)testByteBudget {
+  LoggingController* log = MakeLog(100, 10);
+  [log recordEntry:MakeEntry(@"aaaa")];
+  [log recordEntry:MakeEntry(@"bbbb")];
+  [log recordEntry:MakeEntry(@"cccc")];
+  XCTAssertEqualObjects((@[ @"bbbb", @"cccc" ]), Contents(log));
+  XCTAssertEqual(8u, log.byteCount);
+
+  log.byteBudget = 4;
+  XCTAssertEqualObjects((@[ @"cccc" ]), Contents(log));
+
+  // The newest entry is kept even if it alone exceeds the budget.
+  [log recordEntry:MakeEntry(@"dddddddd")];
+  XCTAssertEqualObjects((@[ @"dddddddd" ]), Contents(log));
+  XCTAssertEqual(8u, log.byteCount);
+}
+
+- (void)testCoalescesUpdates {
+  LoggingController* log = [[LoggingController alloc] init];
+  log.captureLevel = kLogCaptureFull;
+  [log addObserver:self forKeyPath:@"logEntries" options:0 context:NULL];
+
+  for (int i = 0; i < 100; ++i)
+    [log recordEntry:MakeEntry(@"<response/>")];
+  XCTAssertEqual(0u, _updates);
+
+  [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+  XCTAssertEqual(1u, _updates);
+  XCTAssertEqual(100u, log.logEntries.count);
+
+  [log removeObserver:self forKeyPath:@"logEntries"];
+}
+
+- (void)testCaptureLevel {
+  LoggingController* log = MakeLog(10, 1024);
+  // Nothing is captured until the window is shown.
+  XCTAssertEqual(kLogCaptureOff, log.activeCaptureLevel);
+
+  [log recordEntry:MakeEntry(@"a")];
+  log.captureLevel = kLogCaptureOff;
+  XCTAssertEqual(0u, log.logEntries.count);
+  [log recordEntry:MakeEntry(@"b")];
+  XCTAssertEqual(0u, log.logEntries.count);
+  XCTAssertEqual(0u, log.byteCount);
+}
+
+- (void)testCaptureHeaders {
+  LoggingController* log = [[LoggingController alloc] initWithCapacity:10 byteBudget:1024];
+  log.captureLevel = kLogCaptureHeaders;
+
+  [log recordEntry:[LogEntry newSendEntry:@"eval -i 4 -- ZWNobyAxOw=="]];
+  [log recordEntry:MakeEntry(@"<?xml version=\"1.0\"?>\n"
+                             @"<response command=\"eval\" transaction_id=\"4\">"
+                             @"<property type=\"int\"><![CDATA[1]]></property></response>")];
+  [log recordEntry:[LogEntry newSendEntry:@"run -i 5"]];
+  XCTAssertEqualObjects((@[ @"eval -i 4",
+                            @"<?xml version=\"1.0\"?>\n<response command=\"eval\" transaction_id=\"4\">",
+                            @"run -i 5" ]),
+                        Contents(log));
+}
+
+- (void)testCaptureLevelFollowsPreference {
+  NSUserDefaults* defaults = [NSUserDefaults standardUserDefaults];
+  id saved = [defaults objectForKey:kPrefLogCaptureLevel];
+  [self addTeardownBlock:^{
+    [defaults setObject:saved forKey:kPrefLogCaptureLevel];
+  }];
+
+  LoggingController* log = MakeLog(10, 1024);
+  [log recordEntry:MakeEntry(@"a")];
+  [defaults setInteger:kLogCaptureHeaders forKey:kPrefLogCaptureLevel];
+  XCTAssertEqual(kLogCaptureHeaders, log.captureLevel);
+  [defaults setInteger:kLogCaptureOff forKey:kPrefLogCaptureLevel];
+  XCTAssertEqual(kLogCaptureOff, log.captureLevel);
+  XCTAssertEqual(0u, log.logEntries.count);
+}
+
+- (void)testSummary {
+  LogEntry* entry = MakeEntry(@"<?xml version=\"1.0\"?>\n<response command=\"run\"/>");
+  XCTAssertEqualObjects(@"<?xml version=\"1.0\"?> <response command=\"run\"/>", entry.summary);
+
+  // A long message is cut short without splitting a character.
+  NSMutableString* contents = [NSMutableString stringWithString:@"a"];
+  for (int i = 0; i < 200; ++i)
+    [contents appendString:@"é"];
+  entry = MakeEntry(contents);
+  XCTAssertEqual(128u, entry.summary.length);
+  XCTAssertEqualObjects(contents, entry.contents);
+}
+
+@end
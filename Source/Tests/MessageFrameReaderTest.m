@@ -0,0 +1,128 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <XCTest/XCTest.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#import "MessageFrameReader.h"
+#import "ResponseFixtures.h"
+
+@interface MessageFrameReaderTest : XCTestCase
+@end
+
+@implementation MessageFrameReaderTest
+
+- (void)testSinglePacket {
+  MessageFrameReader* reader = [[MessageFrameReader alloc] init];
+  NSData* message = [@"<response/>" dataUsingEncoding:NSUTF8StringEncoding];
+  NSData* packet = MakePacket(message);
+  [reader appendBytes:packet.bytes length:packet.length];
+  XCTAssertEqualObjects(message, [reader nextMessage]);
+  XCTAssertNil([reader nextMessage]);
+}
+
+- (void)testMultiplePacketsInOneRead {
+  MessageFrameReader* reader = [[MessageFrameReader alloc] init];
+  NSData* first = [@"<response transaction_id=\"1\"/>" dataUsingEncoding:NSUTF8StringEncoding];
+  NSData* second = [@"<response transaction_id=\"2\"/>" dataUsingEncoding:NSUTF8StringEncoding];
+  NSMutableData* stream = [NSMutableData dataWithData:MakePacket(first)];
+  [stream appendData:MakePacket(second)];
+  [reader appendBytes:stream.bytes length:stream.length];
+  XCTAssertEqualObjects(first, [reader nextMessage]);
+  XCTAssertEqualObjects(second, [reader nextMessage]);
+  XCTAssertNil([reader nextMessage]);
+}
+
+- (void)testPartialMessage {
+  MessageFrameReader* reader = [[MessageFrameReader alloc] init];
+  XCTAssertFalse([reader hasPartialMessage]);
+
+  NSData* message = [@"<response/>" dataUsingEncoding:NSUTF8StringEncoding];
+  NSData* packet = MakePacket(message);
+  NSMutableData* stream = [NSMutableData dataWithData:packet];
+  [stream appendData:[packet subdataWithRange:NSMakeRange(0, 4)]];
+  [reader appendBytes:stream.bytes length:stream.length];
+  XCTAssertEqualObjects(message, [reader nextMessage]);
+  XCTAssertTrue([reader hasPartialMessage]);
+  XCTAssertNil([reader nextMessage]);
+  XCTAssertTrue([reader hasPartialMessage]);
+
+  NSData* rest = [packet subdataWithRange:NSMakeRange(4, packet.length - 4)];
+  [reader appendBytes:rest.bytes length:rest.length];
+  XCTAssertEqualObjects(message, [reader nextMessage]);
+  XCTAssertFalse([reader hasPartialMessage]);
+}
+
+- (void)testByteAtATime {
+  // This splits both the header and the multi-byte UTF-8 sequences.
+  NSData* message = [@"<response>Привет</response>" dataUsingEncoding:NSUTF8StringEncoding];
+  NSData* packet = MakePacket(message);
+  MessageFrameReader* reader = [[MessageFrameReader alloc] init];
+  const uint8_t* bytes = packet.bytes;
+  for (NSUInteger i = 0; i < packet.length - 1; ++i) {
+    [reader appendBytes:bytes + i length:1];
+    XCTAssertNil([reader nextMessage]);
+  }
+  [reader appendBytes:bytes + packet.length - 1 length:1];
+  NSData* result = [reader nextMessage];
+  XCTAssertEqualObjects(message, result);
+  XCTAssertEqualObjects(@"<response>Привет</response>",
+                        [[NSString alloc] initWithData:result encoding:NSUTF8StringEncoding]);
+}
+
+- (void)testLargePacketFromFileDescriptor {
+  NSData* message = MakeContextGetResponse(20000);
+  XCTAssertEqualObjects(message, [self readPacket:MakePacket(message)]);
+}
+
+- (void)testPerformanceLargePacket {
+  // Roughly 4 MB on the wire.
+  NSData* packet = MakePacket(MakeContextGetResponse(50000));
+  [self measureBlock:^{
+    XCTAssertNotNil([self readPacket:packet]);
+  }];
+}
+
+// Writes |packet| into one end of a socket pair and reads it from the other
+// using the MessageFrameReader.
+- (NSData*)readPacket:(NSData*)packet {
+  int fds[2];
+  XCTAssertEqual(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+
+  dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    const uint8_t* bytes = packet.bytes;
+    size_t written = 0;
+    while (written < packet.length) {
+      ssize_t rv = write(fds[1], bytes + written, packet.length - written);
+      if (rv <= 0)
+        break;
+      written += rv;
+    }
+    close(fds[1]);
+  });
+
+  MessageFrameReader* reader = [[MessageFrameReader alloc] init];
+  NSData* message = nil;
+  while (!message && [reader readFromFileDescriptor:fds[0]] > 0) {
+    message = [reader nextMessage];
+  }
+  close(fds[0]);
+  return message;
+}
+
+@end
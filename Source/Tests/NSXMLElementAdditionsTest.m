@@ -0,0 +1,96 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "NSXMLElementAdditions.h"
+
+@interface NSXMLElementAdditionsTest : XCTestCase
+@end
+
+// Returns |length| bytes of pseudo-random data.
+static NSData* MakeData(NSUInteger length) {
+  NSMutableData* data = [NSMutableData dataWithLength:length];
+  uint8_t* bytes = data.mutableBytes;
+  uint32_t seed = (uint32_t)length + 1;
+  for (NSUInteger i = 0; i < length; ++i) {
+    seed = seed * 1103515245 + 12345;
+    bytes[i] = seed >> 16;
+  }
+  return data;
+}
+
+@implementation NSXMLElementAdditionsTest
+
+- (void)testBase64MatchesFoundation {
+  for (NSUInteger length = 0; length < 100; ++length) {
+    NSData* data = MakeData(length);
+    NSData* encoded = [data base64EncodedDataWithOptions:0];
+    XCTAssertEqualObjects(data, Base64DecodedData(encoded.bytes, encoded.length), @"length %lu", length);
+  }
+}
+
+- (void)testBase64Padding {
+  XCTAssertEqualObjects([@"ab" dataUsingEncoding:NSASCIIStringEncoding],
+                        Base64DecodedData("YWI=", 4));
+  XCTAssertEqualObjects([@"ab" dataUsingEncoding:NSASCIIStringEncoding],
+                        Base64DecodedData("YWI", 3));
+  XCTAssertEqualObjects([@"a" dataUsingEncoding:NSASCIIStringEncoding],
+                        Base64DecodedData("YQ==", 4));
+  XCTAssertEqualObjects([NSData data], Base64DecodedData("", 0));
+}
+
+- (void)testBase64Invalid {
+  XCTAssertNil(Base64DecodedData("YWJj", 1));
+  XCTAssertNil(Base64DecodedData("YW=j", 4));
+  XCTAssertNil(Base64DecodedData("YWJjYWJjYWJjYWJj*WJj", 20));
+  XCTAssertNil(Base64DecodedData("YWJjYWJjYWJjYW\nj", 16));
+  XCTAssertEqualObjects(@"<< Failed to base64-decode data >>",
+                        DecodedElementValue(@"YW=j", @"base64", nil));
+}
+
+- (void)testEncodedValue {
+  NSString* string = @"Ünïcödé values are decoded once";
+  NSData* encoded = [[string dataUsingEncoding:NSUTF8StringEncoding] base64EncodedDataWithOptions:0];
+
+  EncodedValue* value = [[EncodedValue alloc] initWithData:encoded];
+  XCTAssertFalse(value.isDecoded);
+  XCTAssertEqualObjects(string, value.value);
+  XCTAssertTrue(value.isDecoded);
+  XCTAssertEqualObjects(string, value.value);
+
+  NSString* text = [[NSString alloc] initWithData:encoded encoding:NSASCIIStringEncoding];
+  XCTAssertEqualObjects(string, [[EncodedValue alloc] initWithString:text].value);
+  XCTAssertEqualObjects(@"", [[EncodedValue alloc] initWithString:@""].value);
+}
+
+- (void)testPerformanceBase64Decode {
+  NSData* encoded = [MakeData(1 << 20) base64EncodedDataWithOptions:0];
+  [self measureBlock:^{
+    for (int i = 0; i < 10; ++i)
+      XCTAssertNotNil(Base64DecodedData(encoded.bytes, encoded.length));
+  }];
+}
+
+- (void)testPerformanceBase64DecodeFoundation {
+  NSData* encoded = [MakeData(1 << 20) base64EncodedDataWithOptions:0];
+  [self measureBlock:^{
+    for (int i = 0; i < 10; ++i)
+      XCTAssertNotNil([[NSData alloc] initWithBase64EncodedData:encoded options:0]);
+  }];
+}
+
+@end
@@ -0,0 +1,130 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "ProtocolMetrics.h"
+
+// Completes a transaction of |command| that took |total| seconds, of which
+// |firstByte| were spent waiting for the response.
+static void RecordTransaction(ProtocolMetrics* metrics,
+                              NSInteger transactionID,
+                              NSString* command,
+                              NSTimeInterval firstByte,
+                              NSTimeInterval total) {
+  [metrics beginTransaction:transactionID command:command];
+  TransactionMetrics* transaction = [metrics takeTransaction:transactionID];
+  NSTimeInterval start = transaction.sendTime;
+  transaction.responseBytes = 100;
+  transaction.firstByteTime = start + firstByte;
+  transaction.lastByteTime = start + firstByte;
+  transaction.parseStartTime = start + firstByte;
+  transaction.parseEndTime = start + firstByte;
+  transaction.handlerStartTime = start + firstByte;
+  transaction.handlerEndTime = start + total;
+  [metrics recordTransaction:transaction];
+}
+
+@interface ProtocolMetricsTest : XCTestCase
+@end
+
+@implementation ProtocolMetricsTest
+
+- (void)testHistogramBuckets {
+  LatencyHistogram* histogram = [[LatencyHistogram alloc] init];
+  [histogram addDuration:0.0000005];
+  [histogram addDuration:0.0000015];
+  [histogram addDuration:0.0015];
+  [histogram addDuration:-1];
+  [histogram addDuration:1e6];
+
+  XCTAssertEqual(5u, histogram.count);
+  XCTAssertEqual(2u, [histogram countInBucket:0]);
+  XCTAssertEqual(1u, [histogram countInBucket:1]);
+  // 1500 microseconds is in [1024, 2048).
+  XCTAssertEqual(1u, [histogram countInBucket:11]);
+  XCTAssertEqual(1u, [histogram countInBucket:[LatencyHistogram bucketCount] - 1]);
+  XCTAssertEqualWithAccuracy(1e6, histogram.max, 1e-9);
+}
+
+- (void)testHistogramPercentiles {
+  LatencyHistogram* histogram = [[LatencyHistogram alloc] init];
+  XCTAssertEqual(0.0, [histogram durationAtPercentile:50]);
+
+  for (int i = 0; i < 90; ++i)
+    [histogram addDuration:0.0001];
+  for (int i = 0; i < 10; ++i)
+    [histogram addDuration:0.1];
+
+  // 100 microseconds is in [64, 128).
+  XCTAssertEqualWithAccuracy(0.000128, [histogram durationAtPercentile:50], 1e-9);
+  XCTAssertEqualWithAccuracy(0.000128, [histogram durationAtPercentile:90], 1e-9);
+  // The bound of the last occupied bucket is capped at the maximum.
+  XCTAssertEqualWithAccuracy(0.1, [histogram durationAtPercentile:99], 1e-9);
+  XCTAssertEqualWithAccuracy(0.1, [histogram durationAtPercentile:100], 1e-9);
+}
+
+- (void)testPerCommand {
+  ProtocolMetrics* metrics = [[ProtocolMetrics alloc] init];
+  RecordTransaction(metrics, 1, @"stack_get -i 1", 0.010, 0.012);
+  RecordTransaction(metrics, 2, @"stack_get -i 2", 0.020, 0.021);
+  RecordTransaction(metrics, 3, @"context_get -d 0 -i 3", 0.001, 0.050);
+
+  XCTAssertEqualObjects((@[ @"context_get", @"stack_get" ]), metrics.commands);
+  XCTAssertNil([metrics metricsForCommand:@"source"]);
+
+  CommandMetrics* stack = [metrics metricsForCommand:@"stack_get"];
+  XCTAssertEqual(2u, stack.count);
+  XCTAssertEqual(2 * strlen("stack_get -i 1") + 2, stack.commandBytes);
+  XCTAssertEqual(200u, stack.responseBytes);
+  XCTAssertEqualWithAccuracy(0.030, stack.timeToFirstByte.sum, 1e-6);
+  XCTAssertEqualWithAccuracy(0.003, stack.handlerTime.sum, 1e-6);
+
+  CommandMetrics* context = [metrics metricsForCommand:@"context_get"];
+  XCTAssertEqual(1u, context.count);
+  XCTAssertEqualWithAccuracy(0.049, context.handlerTime.max, 1e-6);
+}
+
+- (void)testSlowestTransactions {
+  ProtocolMetrics* metrics = [[ProtocolMetrics alloc] init];
+  metrics.slowestTransactionsLimit = 3;
+
+  NSTimeInterval totals[] = { 0.005, 0.050, 0.001, 0.020, 0.010 };
+  for (NSInteger i = 0; i < 5; ++i)
+    RecordTransaction(metrics, i, @"property_get", 0, totals[i]);
+
+  NSArray* transactionIDs = [metrics.slowestTransactions valueForKey:@"transactionID"];
+  XCTAssertEqualObjects((@[ @1, @3, @4 ]), transactionIDs);
+
+  metrics.slowestTransactionsLimit = 1;
+  XCTAssertEqual(1u, metrics.slowestTransactions.count);
+  XCTAssertEqual(1, metrics.slowestTransactions.firstObject.transactionID);
+
+  [metrics reset];
+  XCTAssertEqual(0u, metrics.slowestTransactions.count);
+  XCTAssertEqual(0u, metrics.commands.count);
+}
+
+- (void)testUnknownTransaction {
+  ProtocolMetrics* metrics = [[ProtocolMetrics alloc] init];
+  [metrics beginTransaction:7 command:@"stack_get -i 7"];
+  XCTAssertNil([metrics takeTransaction:8]);
+
+  [metrics removePendingTransactions];
+  XCTAssertNil([metrics takeTransaction:7]);
+}
+
+@end
@@ -0,0 +1,170 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "ProtocolResponse.h"
+#import "ResponseFixtures.h"
+#import "StackFrame.h"
+#import "VariableNode.h"
+
+@interface ProtocolResponseTest : XCTestCase
+@end
+
+@implementation ProtocolResponseTest
+
+// Decodes |data| with both the streaming parser and the DOM, and checks that
+// the results are the same. Returns the streamed response.
+- (ProtocolResponse*)decode:(NSData*)data {
+  NSError* error = nil;
+  ProtocolResponse* streamed = [ProtocolResponse responseWithData:data error:&error];
+  XCTAssertNotNil(streamed, @"%@", error);
+  ProtocolResponse* document = [ProtocolResponse responseWithDocumentData:data error:&error];
+  XCTAssertNotNil(document, @"%@", error);
+
+  XCTAssertEqualObjects(document.name, streamed.name);
+  XCTAssertEqualObjects(document.command, streamed.command);
+  XCTAssertEqual(document.transactionID, streamed.transactionID);
+  XCTAssertEqual(document.errorCode, streamed.errorCode);
+  XCTAssertEqualObjects(document.errorMessage, streamed.errorMessage);
+  XCTAssertEqualObjects(document.contextIDs, streamed.contextIDs);
+  XCTAssertEqualObjects(document.value, streamed.value);
+
+  XCTAssertEqual(document.stackFrames.count, streamed.stackFrames.count);
+  for (NSUInteger i = 0; i < MIN(document.stackFrames.count, streamed.stackFrames.count); ++i) {
+    XCTAssertEqual(document.stackFrames[i].index, streamed.stackFrames[i].index);
+    XCTAssertEqualObjects(document.stackFrames[i].filename, streamed.stackFrames[i].filename);
+    XCTAssertEqual(document.stackFrames[i].lineNumber, streamed.stackFrames[i].lineNumber);
+    XCTAssertEqualObjects(document.stackFrames[i].function, streamed.stackFrames[i].function);
+  }
+
+  [self assertNodes:document.properties equalNodes:streamed.properties];
+  return streamed;
+}
+
+- (void)assertNodes:(NSArray<VariableNode*>*)expected equalNodes:(NSArray<VariableNode*>*)actual {
+  XCTAssertEqual(expected.count, actual.count);
+  for (NSUInteger i = 0; i < MIN(expected.count, actual.count); ++i) {
+    XCTAssertEqualObjects(expected[i].name, actual[i].name);
+    XCTAssertEqualObjects(expected[i].fullName, actual[i].fullName);
+    XCTAssertEqualObjects(expected[i].type, actual[i].type);
+    XCTAssertEqualObjects(expected[i].value, actual[i].value);
+    XCTAssertEqual(expected[i].childCount, actual[i].childCount);
+    [self assertNodes:expected[i].children equalNodes:actual[i].children];
+  }
+}
+
+- (void)testStackGet {
+  ProtocolResponse* response = [self decode:MakeStackGetResponse(2, @"file:///dev/tests/exception.php", 11, @"Something")];
+  XCTAssertEqualObjects(@"response", response.name);
+  XCTAssertEqualObjects(@"stack_get", response.command);
+  XCTAssertEqual(7, response.transactionID);
+  XCTAssertEqual(1u, response.stackFrames.count);
+
+  StackFrame* frame = response.stackFrames.firstObject;
+  XCTAssertEqual(2u, frame.index);
+  XCTAssertEqualObjects(@"file:///dev/tests/exception.php", frame.filename);
+  XCTAssertEqual(11u, frame.lineNumber);
+  XCTAssertEqualObjects(@"Something", frame.function);
+}
+
+- (void)testContextNames {
+  ProtocolResponse* response = [self decode:MakeContextNamesResponse()];
+  XCTAssertEqualObjects((@[ @0, @1, @2 ]), response.contextIDs);
+}
+
+- (void)testContextGet {
+  ProtocolResponse* response = [self decode:MakeContextGetResponse(100)];
+  XCTAssertEqual(1u, response.properties.count);
+
+  VariableNode* array = response.properties.firstObject;
+  XCTAssertEqualObjects(@"$a", array.name);
+  XCTAssertEqual(100u, array.childCount);
+  XCTAssertEqual(100u, array.children.count);
+  XCTAssertFalse([array isLeaf]);
+
+  VariableNode* element = array.children[42];
+  XCTAssertEqualObjects(@"$a[42]", element.fullName);
+  XCTAssertEqualObjects(@"42", element.value);
+  XCTAssertTrue([element isLeaf]);
+}
+
+- (void)testCyrillicKey {
+  NSString* key = @"LФЯЄԠ PЇPSЏԠ DФLФЯ SЇҬ ДԠЇԐҐ";
+  ProtocolResponse* response = [self decode:MakeCyrillicContextGetResponse()];
+  XCTAssertEqual(2u, response.properties.count);
+
+  VariableNode* element = [response.properties.firstObject children].firstObject;
+  XCTAssertEqualObjects(key, element.name);
+  XCTAssertEqualObjects(key, element.value);
+
+  XCTAssertEqualObjects(@"uninitialized", response.properties[1].type);
+}
+
+- (void)testPropertyGetPage {
+  ProtocolResponse* response = [self decode:MakePropertyGetResponse(100, 3, 32)];
+  VariableNode* parent = response.properties.firstObject;
+  XCTAssertEqual(100u, parent.childCount);
+  XCTAssertEqual(4u, [parent childrenOfPage:3].count);
+  XCTAssertEqualObjects(@"96", [[parent childrenOfPage:3].firstObject value]);
+
+  // The children that were not in the page are placeholders.
+  XCTAssertEqual(100u, parent.children.count);
+  XCTAssertTrue([parent.children[95] isPlaceholder]);
+  XCTAssertEqualObjects(@"$a[96]", parent.children[96].fullName);
+}
+
+- (void)testSource {
+  NSString* source = ReadTestScript(@"Cyrillic-array-key.php");
+  XCTAssertNotNil(source);
+  ProtocolResponse* response = [self decode:MakeSourceResponse(source)];
+  XCTAssertEqualObjects(source, response.value);
+}
+
+- (void)testError {
+  ProtocolResponse* response = [self decode:MakeErrorResponse(@"property_get", 300, @"can not get property")];
+  XCTAssertEqual(300, response.errorCode);
+  XCTAssertEqualObjects(@"can not get property", response.errorMessage);
+  XCTAssertEqual(0u, response.properties.count);
+}
+
+- (void)testMalformed {
+  NSData* data = [@"<response command=\"status\" transaction_id=\"3\" status=\"break\">"
+      dataUsingEncoding:NSUTF8StringEncoding];
+  NSError* error = nil;
+  XCTAssertNil([ProtocolResponse responseWithData:data error:&error]);
+  XCTAssertNotNil(error);
+
+  ProtocolResponse* response = [ProtocolResponse responseWithDocumentData:data error:NULL];
+  XCTAssertEqual(3, response.transactionID);
+  XCTAssertEqualObjects(@"break", response.attributes[@"status"]);
+}
+
+- (void)testPerformanceStreaming {
+  NSData* data = MakeContextGetResponse(50000);
+  [self measureBlock:^{
+    XCTAssertNotNil([ProtocolResponse responseWithData:data error:NULL]);
+  }];
+}
+
+- (void)testPerformanceDocument {
+  NSData* data = MakeContextGetResponse(50000);
+  [self measureBlock:^{
+    XCTAssertNotNil([ProtocolResponse responseWithDocumentData:data error:NULL]);
+  }];
+}
+
+@end
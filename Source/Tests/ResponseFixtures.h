@@ -0,0 +1,77 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Foundation/Foundation.h>
+
+// These functions create DBGp response messages shaped like those that Xdebug
+// sends for the scripts in dev/tests/. Like Xdebug, they declare the messages
+// to be iso-8859-1 but encode them as UTF-8.
+
+// Wraps |message| in the DBGp framing.
+NSData* MakePacket(NSData* message);
+
+// A response to |command| with the given |transactionID|. The |attributes| are
+// added to the root element, which contains |body|.
+NSData* MakeResponse(NSString* command, NSInteger transactionID, NSString* attributes, NSString* body);
+
+// A <stack> element for a single frame.
+NSString* MakeStackElement(NSInteger level, NSString* filename, NSInteger lineno, NSString* where);
+
+// A stack_get response for a single frame.
+NSData* MakeStackGetResponse(NSInteger level, NSString* filename, NSInteger lineno, NSString* where);
+
+// A context_names response with the Locals, Superglobals and User defined
+// constants contexts.
+NSData* MakeContextNamesResponse(void);
+
+// A context_get response like dev/tests/long_array.php, with |count| elements
+// in the array $a.
+NSData* MakeContextGetResponse(NSUInteger count);
+
+// A context_get response with the array $objects of |count| Item objects, each
+// with an int $id and a string $name. This has 3 * |count| + 1 properties.
+NSData* MakeObjectTreeContextGetResponse(NSUInteger count);
+
+// A context_get response like dev/tests/Cyrillic-array-key.php.
+NSData* MakeCyrillicContextGetResponse(void);
+
+// A <property> element for one page of the array $a with |numchildren|
+// elements, starting at |page| * |pagesize|.
+NSString* MakeArrayProperty(NSUInteger numchildren, NSUInteger page, NSUInteger pagesize);
+
+// A <property> element for |fullName|, which is the root of |levels| nested
+// arrays: its first element is the next array, e.g. $n[0], and its second is
+// an int. The children are included |depth| levels deep.
+NSString* MakeNestedProperty(NSString* name, NSString* fullName, NSUInteger levels, NSUInteger depth);
+
+// |count| <property> elements for the strings |prefix|0, |prefix|1, ..., whose
+// values are each 64 characters long.
+NSString* MakeStringProperties(NSString* prefix, NSUInteger count);
+
+// A property_get response for one page of an array with |numchildren|
+// elements, starting at |page| * |pagesize|.
+NSData* MakePropertyGetResponse(NSUInteger numchildren, NSUInteger page, NSUInteger pagesize);
+
+// A source response with the base64-encoded |source|.
+NSData* MakeSourceResponse(NSString* source);
+
+// An error response to |command|.
+NSData* MakeErrorResponse(NSString* command, NSInteger code, NSString* message);
+
+// Returns the contents of the named script in dev/tests/, which is found
+// relative to this file's location in the source tree. This is for the unit
+// tests, which run where they were built.
+NSString* ReadTestScript(NSString* name);
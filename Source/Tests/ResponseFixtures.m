@@ -0,0 +1,168 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "ResponseFixtures.h"
+
+static NSString* const kXMLDeclaration = @"<?xml version=\"1.0\" encoding=\"iso-8859-1\"?>\n";
+
+static NSString* Base64(NSString* string) {
+  return [[string dataUsingEncoding:NSUTF8StringEncoding] base64EncodedStringWithOptions:0];
+}
+
+// Appends the int elements of $a that are in [start, end).
+static void AppendIntProperties(NSMutableString* xml, NSUInteger start, NSUInteger end) {
+  for (NSUInteger i = start; i < end; ++i) {
+    NSString* value = Base64([NSString stringWithFormat:@"%lu", i]);
+    [xml appendFormat:@"<property name=\"%lu\" fullname=\"$a[%lu]\" type=\"int\" encoding=\"base64\"><![CDATA[%@]]></property>",
+        i, i, value];
+  }
+}
+
+NSData* MakePacket(NSData* message) {
+  NSMutableData* packet = [NSMutableData data];
+  NSString* header = [NSString stringWithFormat:@"%lu", message.length];
+  [packet appendData:[header dataUsingEncoding:NSASCIIStringEncoding]];
+  [packet appendBytes:"" length:1];
+  [packet appendData:message];
+  [packet appendBytes:"" length:1];
+  return packet;
+}
+
+NSData* MakeResponse(NSString* command, NSInteger transactionID, NSString* attributes, NSString* body) {
+  NSString* xml = [NSString stringWithFormat:
+      @"%@<response xmlns=\"urn:debugger_protocol_v1\" xmlns:xdebug=\"http://xdebug.org/dbgp/xdebug\" "
+      @"command=\"%@\" transaction_id=\"%ld\"%@>%@</response>",
+      kXMLDeclaration, command, transactionID, attributes, body];
+  return [xml dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+NSString* MakeStackElement(NSInteger level, NSString* filename, NSInteger lineno, NSString* where) {
+  return [NSString stringWithFormat:
+      @"<stack where=\"%@\" level=\"%ld\" type=\"file\" filename=\"%@\" lineno=\"%ld\"></stack>",
+      where, level, filename, lineno];
+}
+
+NSData* MakeStackGetResponse(NSInteger level, NSString* filename, NSInteger lineno, NSString* where) {
+  return MakeResponse(@"stack_get", 7, @"", MakeStackElement(level, filename, lineno, where));
+}
+
+NSData* MakeContextNamesResponse(void) {
+  return MakeResponse(@"context_names", 7, @"",
+      @"<context name=\"Locals\" id=\"0\"></context>"
+      @"<context name=\"Superglobals\" id=\"1\"></context>"
+      @"<context name=\"User defined constants\" id=\"2\"></context>");
+}
+
+NSData* MakeContextGetResponse(NSUInteger count) {
+  NSMutableString* body = [NSMutableString string];
+  [body appendFormat:@"<property name=\"$a\" fullname=\"$a\" type=\"array\" children=\"1\" numchildren=\"%lu\" page=\"0\" pagesize=\"%lu\">",
+      count, count];
+  AppendIntProperties(body, 0, count);
+  [body appendString:@"</property>"];
+  return MakeResponse(@"context_get", 7, @" context=\"0\"", body);
+}
+
+NSData* MakeObjectTreeContextGetResponse(NSUInteger count) {
+  NSMutableString* body = [NSMutableString string];
+  [body appendFormat:@"<property name=\"$objects\" fullname=\"$objects\" type=\"array\" children=\"1\" numchildren=\"%lu\" page=\"0\" pagesize=\"%lu\">",
+      count, count];
+  for (NSUInteger i = 0; i < count; ++i) {
+    NSString* name = [NSString stringWithFormat:@"Item %lu", i];
+    [body appendFormat:
+        @"<property name=\"%lu\" fullname=\"$objects[%lu]\" type=\"object\" classname=\"Item\" children=\"1\" numchildren=\"2\" page=\"0\" pagesize=\"32\">"
+        @"<property name=\"id\" fullname=\"$objects[%lu]-&gt;id\" facet=\"public\" type=\"int\"><![CDATA[%lu]]></property>"
+        @"<property name=\"name\" fullname=\"$objects[%lu]-&gt;name\" facet=\"public\" type=\"string\" size=\"%lu\" encoding=\"base64\"><![CDATA[%@]]></property>"
+        @"</property>",
+        i, i, i, i, i, name.length, Base64(name)];
+  }
+  [body appendString:@"</property>"];
+  return MakeResponse(@"context_get", 7, @" context=\"0\"", body);
+}
+
+NSData* MakeCyrillicContextGetResponse(void) {
+  NSString* key = @"LФЯЄԠ PЇPSЏԠ DФLФЯ SЇҬ ДԠЇԐҐ";
+  NSString* body = [NSString stringWithFormat:
+      @"<property name=\"$a\" fullname=\"$a\" type=\"array\" children=\"1\" numchildren=\"1\" page=\"0\" pagesize=\"32\">"
+      @"<property name=\"%@\" fullname=\"$a['%@']\" type=\"string\" size=\"%lu\" encoding=\"base64\"><![CDATA[%@]]></property>"
+      @"</property>"
+      @"<property name=\"$k\" fullname=\"$k\" type=\"uninitialized\"></property>",
+      key, key, [key lengthOfBytesUsingEncoding:NSUTF8StringEncoding], Base64(key)];
+  return MakeResponse(@"context_get", 7, @" context=\"0\"", body);
+}
+
+NSString* MakeArrayProperty(NSUInteger numchildren, NSUInteger page, NSUInteger pagesize) {
+  NSMutableString* xml = [NSMutableString string];
+  [xml appendFormat:@"<property name=\"$a\" fullname=\"$a\" type=\"array\" children=\"1\" numchildren=\"%lu\" page=\"%lu\" pagesize=\"%lu\">",
+      numchildren, page, pagesize];
+  NSUInteger start = MIN(page * pagesize, numchildren);
+  AppendIntProperties(xml, start, MIN(start + pagesize, numchildren));
+  [xml appendString:@"</property>"];
+  return xml;
+}
+
+NSString* MakeStringProperties(NSString* prefix, NSUInteger count) {
+  NSMutableString* xml = [NSMutableString string];
+  for (NSUInteger i = 0; i < count; ++i) {
+    NSString* value = [[NSString stringWithFormat:@"%lu", i] stringByPaddingToLength:64
+                                                                         withString:@"."
+                                                                    startingAtIndex:0];
+    [xml appendFormat:@"<property name=\"%@%lu\" fullname=\"%@%lu\" type=\"string\" size=\"64\" encoding=\"base64\"><![CDATA[%@]]></property>",
+        prefix, i, prefix, i, Base64(value)];
+  }
+  return xml;
+}
+
+NSString* MakeNestedProperty(NSString* name, NSString* fullName, NSUInteger levels, NSUInteger depth) {
+  if (levels == 0) {
+    return [NSString stringWithFormat:@"<property name=\"%@\" fullname=\"%@\" type=\"int\"><![CDATA[0]]></property>",
+        name, fullName];
+  }
+
+  NSMutableString* xml = [NSMutableString string];
+  [xml appendFormat:@"<property name=\"%@\" fullname=\"%@\" type=\"array\" children=\"1\" numchildren=\"2\" page=\"0\" pagesize=\"32\">",
+      name, fullName];
+  if (depth > 0) {
+    [xml appendString:MakeNestedProperty(@"0", [fullName stringByAppendingString:@"[0]"], levels - 1, depth - 1)];
+    [xml appendFormat:@"<property name=\"1\" fullname=\"%@[1]\" type=\"int\"><![CDATA[1]]></property>", fullName];
+  }
+  [xml appendString:@"</property>"];
+  return xml;
+}
+
+NSData* MakePropertyGetResponse(NSUInteger numchildren, NSUInteger page, NSUInteger pagesize) {
+  return MakeResponse(@"property_get", 7, @"", MakeArrayProperty(numchildren, page, pagesize));
+}
+
+NSData* MakeSourceResponse(NSString* source) {
+  return MakeResponse(@"source", 7, @" encoding=\"base64\"",
+                      [NSString stringWithFormat:@"<![CDATA[%@]]>", Base64(source)]);
+}
+
+NSData* MakeErrorResponse(NSString* command, NSInteger code, NSString* message) {
+  NSString* body = [NSString stringWithFormat:
+      @"<error code=\"%ld\"><message><![CDATA[%@]]></message></error>", code, message];
+  return MakeResponse(command, 7, @"", body);
+}
+
+NSString* ReadTestScript(NSString* name) {
+  NSString* tests = [[[[@__FILE__ stringByDeletingLastPathComponent]
+      stringByDeletingLastPathComponent]
+      stringByDeletingLastPathComponent]
+      stringByAppendingPathComponent:@"dev/tests"];
+  return [NSString stringWithContentsOfFile:[tests stringByAppendingPathComponent:name]
+                                   encoding:NSUTF8StringEncoding
+                                      error:NULL];
+}
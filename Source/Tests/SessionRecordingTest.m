@@ -0,0 +1,241 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "DebuggerBackEnd.h"
+#import "DebuggerModel.h"
+#import "FakeDebuggerEngine.h"
+#import "SessionRecording.h"
+#import "SessionReplayer.h"
+#import "StackFrame.h"
+
+static NSData* Data(NSString* string) {
+  return [string dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+@interface SessionRecordingTest : XCTestCase
+@end
+
+@implementation SessionRecordingTest {
+  NSString* _directory;
+}
+
+- (void)setUp {
+  [super setUp];
+  _directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+  [[NSFileManager defaultManager] createDirectoryAtPath:_directory
+                            withIntermediateDirectories:YES
+                                             attributes:nil
+                                                  error:NULL];
+}
+
+- (void)tearDown {
+  [[NSFileManager defaultManager] removeItemAtPath:_directory error:NULL];
+  [super tearDown];
+}
+
+- (NSString*)recordMessages:(NSArray<NSString*>*)messages {
+  NSString* path = [_directory stringByAppendingPathComponent:@"test.dbgprec"];
+  SessionRecorder* recorder = [[SessionRecorder alloc] initWithPath:path error:NULL];
+  for (NSUInteger i = 0; i < messages.count; ++i) {
+    [recorder recordMessage:Data(messages[i])
+                   direction:(i % 2 ? kLogEntryReceiving : kLogEntrySending)
+       lastReadTransactionID:i / 2
+    lastWrittenTransactionID:(i + 1) / 2];
+  }
+  [recorder close];
+  return path;
+}
+
+- (void)testRoundTrip {
+  NSString* path = [self recordMessages:@[ @"run -i 0", @"<response transaction_id=\"0\"/>", @"" ]];
+
+  NSError* error = nil;
+  SessionRecording* recording = [SessionRecording recordingAtPath:path error:&error];
+  XCTAssertNil(error);
+  XCTAssertEqual(3u, recording.records.count);
+
+  SessionRecord* record = recording.records[1];
+  XCTAssertEqual(kLogEntryReceiving, record.direction);
+  XCTAssertEqualObjects(Data(@"<response transaction_id=\"0\"/>"), record.message);
+  XCTAssertEqual(0, record.lastReadTransactionID);
+  XCTAssertEqual(1, record.lastWrittenTransactionID);
+  XCTAssertLessThanOrEqual(recording.records[0].timestamp, record.timestamp);
+
+  record = recording.records[2];
+  XCTAssertEqual(kLogEntrySending, record.direction);
+  XCTAssertEqual(0u, record.message.length);
+}
+
+- (void)testIgnoresTruncatedRecord {
+  NSString* path = [self recordMessages:@[ @"run -i 0", @"<response transaction_id=\"0\"/>" ]];
+  NSData* data = [NSData dataWithContentsOfFile:path];
+  [[data subdataWithRange:NSMakeRange(0, data.length - 4)] writeToFile:path atomically:NO];
+
+  SessionRecording* recording = [SessionRecording recordingAtPath:path error:NULL];
+  XCTAssertEqual(1u, recording.records.count);
+  XCTAssertEqualObjects(Data(@"run -i 0"), recording.records[0].message);
+}
+
+- (void)testRejectsOtherFiles {
+  NSString* path = [_directory stringByAppendingPathComponent:@"test.txt"];
+  [Data(@"<?php echo 1;") writeToFile:path atomically:NO];
+
+  NSError* error = nil;
+  XCTAssertNil([SessionRecording recordingAtPath:path error:&error]);
+  XCTAssertEqualObjects(kSessionRecordingErrorDomain, error.domain);
+}
+
+// Records a session in which |backEnd| steps once with the FakeDebuggerEngine
+// on |port|.
+- (SessionRecording*)recordSessionWithModel:(DebuggerModel*)model
+                                    backEnd:(DebuggerBackEnd*)backEnd
+                                       port:(uint16_t)port {
+  backEnd.recordingDirectory = _directory;
+  FakeDebuggerEngine* engine = [[FakeDebuggerEngine alloc] initWithPort:port];
+  engine.stackDepth = 3;
+  [self stepWithModel:model backEnd:backEnd connect:^{ [engine connect]; }];
+
+  [self keyValueObservingExpectationForObject:model keyPath:@"connected" expectedValue:@NO];
+  [engine disconnect];
+  [self waitForExpectationsWithTimeout:5 handler:nil];
+  backEnd.recordingDirectory = nil;
+
+  NSArray<NSString*>* files = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:_directory error:NULL];
+  XCTAssertEqual(1u, files.count);
+  NSString* path = [_directory stringByAppendingPathComponent:files.firstObject];
+  return [SessionRecording recordingAtPath:path error:NULL];
+}
+
+// Replays |recording| to |backEnd|, which should build the same model as when
+// it was recorded.
+- (void)replayRecording:(SessionRecording*)recording
+              withModel:(DebuggerModel*)model
+                backEnd:(DebuggerBackEnd*)backEnd
+                   port:(uint16_t)port {
+  SessionReplayer* replayer = [[SessionReplayer alloc] initWithRecording:recording port:port];
+  [self stepWithModel:model backEnd:backEnd connect:^{ [replayer connect]; }];
+  XCTAssertEqual(3u, model.stackDepth);
+  XCTAssertEqualObjects(@"file:///var/www/app/frame2.php", model.stack[2].filename);
+  [self expectationForPredicate:[NSPredicate predicateWithFormat:@"finished == YES"]
+            evaluatedWithObject:replayer
+                        handler:nil];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+  XCTAssertFalse(replayer.failed);
+  XCTAssertNil(replayer.awaitedCommand);
+
+  backEnd.autoAttach = NO;
+  [replayer disconnect];
+}
+
+// Records a session with the FakeDebuggerEngine and replays it to a new
+// DebuggerBackEnd, which should build the same model.
+- (void)testRecordAndReplay {
+  uint16_t port = 19000 + arc4random_uniform(1000);
+  DebuggerModel* model = [[DebuggerModel alloc] init];
+  DebuggerBackEnd* backEnd = [[DebuggerBackEnd alloc] initWithModel:model port:port autoAttach:YES];
+  SessionRecording* recording = [self recordSessionWithModel:model backEnd:backEnd port:port];
+  // The engine speaks first, with the init packet.
+  XCTAssertEqual(kLogEntryReceiving, recording.records.firstObject.direction);
+
+  [self replayRecording:recording withModel:model backEnd:backEnd port:port];
+}
+
+// Replays a session whose transaction IDs are not those the client sends.
+- (void)testReplayMapsTransactionIDs {
+  uint16_t port = 19000 + arc4random_uniform(1000);
+  DebuggerModel* model = [[DebuggerModel alloc] init];
+  DebuggerBackEnd* backEnd = [[DebuggerBackEnd alloc] initWithModel:model port:port autoAttach:YES];
+  SessionRecording* recording = [self recordSessionWithModel:model backEnd:backEnd port:port];
+
+  // Re-record the session with every transaction ID offset by 100.
+  NSRegularExpression* pattern =
+      [NSRegularExpression regularExpressionWithPattern:@"(-i |transaction_id=\")([0-9]+)"
+                                                options:0
+                                                  error:NULL];
+  NSString* path = [_directory stringByAppendingPathComponent:@"offset.dbgprec"];
+  SessionRecorder* recorder = [[SessionRecorder alloc] initWithPath:path error:NULL];
+  for (SessionRecord* record in recording.records) {
+    NSMutableString* message = [[NSMutableString alloc] initWithData:record.message
+                                                            encoding:NSUTF8StringEncoding];
+    for (NSTextCheckingResult* match in [[pattern matchesInString:message
+                                                          options:0
+                                                            range:NSMakeRange(0, message.length)]
+                                            reverseObjectEnumerator]) {
+      NSRange range = [match rangeAtIndex:2];
+      NSInteger transactionID = [[message substringWithRange:range] integerValue];
+      [message replaceCharactersInRange:range
+                             withString:[NSString stringWithFormat:@"%ld", transactionID + 100]];
+    }
+    [recorder recordMessage:Data(message)
+                   direction:record.direction
+       lastReadTransactionID:record.lastReadTransactionID + 100
+    lastWrittenTransactionID:record.lastWrittenTransactionID + 100];
+  }
+  [recorder close];
+
+  [self replayRecording:[SessionRecording recordingAtPath:path error:NULL]
+              withModel:model
+                backEnd:backEnd
+                   port:port];
+}
+
+// A client that sends other commands than the recording fails the replay.
+- (void)testReplayFailsWhenCommandsDiverge {
+  uint16_t port = 19000 + arc4random_uniform(1000);
+  DebuggerModel* model = [[DebuggerModel alloc] init];
+  DebuggerBackEnd* backEnd = [[DebuggerBackEnd alloc] initWithModel:model port:port autoAttach:YES];
+  SessionRecording* recording = [self recordSessionWithModel:model backEnd:backEnd port:port];
+
+  // Fetching the stack frame by frame sends stack_depth instead of stack_get.
+  backEnd.fetchesStackInOneRequest = NO;
+  SessionReplayer* replayer = [[SessionReplayer alloc] initWithRecording:recording port:port];
+  [self keyValueObservingExpectationForObject:model keyPath:@"connected" expectedValue:@YES];
+  [replayer connect];
+  [self waitForExpectationsWithTimeout:5 handler:nil];
+  [backEnd stepIn];
+  [self expectationForPredicate:[NSPredicate predicateWithFormat:@"failed == YES"]
+            evaluatedWithObject:replayer
+                        handler:nil];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+  XCTAssertFalse(replayer.finished);
+
+  backEnd.autoAttach = NO;
+  [replayer disconnect];
+}
+
+// Connects an engine with |connect|, steps, and waits for the variables of the
+// top frame to load.
+- (void)stepWithModel:(DebuggerModel*)model
+              backEnd:(DebuggerBackEnd*)backEnd
+              connect:(void (^)(void))connect {
+  [self keyValueObservingExpectationForObject:model keyPath:@"connected" expectedValue:@YES];
+  connect();
+  [self waitForExpectationsWithTimeout:5 handler:nil];
+
+  [self keyValueObservingExpectationForObject:model keyPath:@"stack" handler:nil];
+  [backEnd stepIn];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+
+  StackFrame* frame = model.stack.firstObject;
+  [self expectationForPredicate:[NSPredicate predicateWithBlock:^BOOL(id object, NSDictionary* bindings) {
+    return frame.variables.count == 3;
+  }] evaluatedWithObject:self handler:nil];
+  [self waitForExpectationsWithTimeout:10 handler:nil];
+}
+
+@end
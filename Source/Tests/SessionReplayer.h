@@ -0,0 +1,57 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <Foundation/Foundation.h>
+
+@class SessionRecording;
+
+// SessionReplayer plays the engine's side of a SessionRecording back to a
+// client. It connects to the port on which a MessageQueue is listening, like
+// Xdebug would, and then writes the recorded engine messages in order. Before
+// each message that was recorded after a command, it waits for the client to
+// send its next command, so the client sees the same conversation as it did
+// when the session was recorded. The client's transaction IDs need not match
+// the recording: each recorded response is rewritten to carry the ID of the
+// command that the client sent in its place. Apart from its ID, each command
+// must be the same as the recorded one; once they differ, the replay fails and
+// stops.
+@interface SessionReplayer : NSObject
+
+// Whether the recorded delays between messages are reproduced. If NO, each
+// message is written as soon as the commands before it have been received.
+// Defaults to NO.
+@property(assign, atomic) BOOL preservesTiming;
+
+// Whether the replay stopped because the client diverged from the recording.
+@property(readonly, atomic, getter=isFailed) BOOL failed;
+
+// Whether every recorded message has been written.
+@property(readonly, atomic, getter=isFinished) BOOL finished;
+
+// The recorded command that the replay is waiting for the client to send, or
+// nil if it is not waiting for one.
+@property(readonly, atomic, copy) NSString* awaitedCommand;
+
+- (instancetype)initWithRecording:(SessionRecording*)recording port:(uint16_t)port;
+
+// Connects to the port asynchronously, retrying until the listening socket is
+// open, and then starts the replay.
+- (void)connect;
+
+// Closes the connection. This must be called before the replayer is released.
+- (void)disconnect;
+
+@end
@@ -0,0 +1,202 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import "SessionReplayer.h"
+
+#import "EngineSocket.h"
+#import "SessionRecording.h"
+
+// Splits |command| into its transaction ID, the value of its -i argument, and
+// the rest of the command. Returns nil if it has no ID.
+static NSString* TransactionID(NSString* command, NSString** rest) {
+  NSMutableArray<NSString*>* arguments = [[command componentsSeparatedByString:@" "] mutableCopy];
+  NSUInteger index = [arguments indexOfObject:@"-i"];
+  if (index == NSNotFound || index + 1 >= arguments.count)
+    return nil;
+  NSString* transactionID = arguments[index + 1];
+  [arguments removeObjectsInRange:NSMakeRange(index, 2)];
+  *rest = [arguments componentsJoinedByString:@" "];
+  return transactionID;
+}
+
+// Returns |message| with the value of its transaction_id attribute replaced by
+// the one mapped from it in |transactionIDs|, or nil if it has an ID that is
+// not mapped. Messages without an ID, such as the init packet, are unchanged.
+static NSData* MessageWithMappedTransactionID(NSData* message,
+                                              NSDictionary<NSString*, NSString*>* transactionIDs) {
+  NSData* attribute = [@"transaction_id=\"" dataUsingEncoding:NSUTF8StringEncoding];
+  NSRange start = [message rangeOfData:attribute options:0 range:NSMakeRange(0, message.length)];
+  if (start.location == NSNotFound)
+    return message;
+
+  NSUInteger valueStart = NSMaxRange(start);
+  NSRange end = [message rangeOfData:[NSData dataWithBytes:"\"" length:1]
+                             options:0
+                               range:NSMakeRange(valueStart, message.length - valueStart)];
+  if (end.location == NSNotFound)
+    return nil;
+  NSRange valueRange = NSMakeRange(valueStart, end.location - valueStart);
+  NSString* recorded = [[NSString alloc] initWithData:[message subdataWithRange:valueRange]
+                                             encoding:NSUTF8StringEncoding];
+  NSString* mapped = recorded ? transactionIDs[recorded] : nil;
+  if (!mapped)
+    return nil;
+
+  NSMutableData* rewritten = [message mutableCopy];
+  NSData* value = [mapped dataUsingEncoding:NSUTF8StringEncoding];
+  [rewritten replaceBytesInRange:valueRange withBytes:value.bytes length:value.length];
+  return rewritten;
+}
+
+@interface SessionReplayer ()
+@property(readwrite, atomic, copy) NSString* awaitedCommand;
+@end
+
+@implementation SessionReplayer {
+  NSArray<SessionRecord*>* _records;
+  uint16_t _port;
+
+  // All socket I/O and replay happens on this serial queue.
+  dispatch_queue_t _queue;
+  EngineSocket* _socket;
+
+  // Commands received from the client that have not yet been matched against
+  // the recording, oldest first.
+  NSMutableArray<NSString*>* _commands;
+
+  // The transaction IDs of the recorded commands, mapped to those of the
+  // commands that the client sent in their place.
+  NSMutableDictionary<NSString*, NSString*>* _transactionIDs;
+
+  // The index of the next record to replay.
+  NSUInteger _nextRecord;
+
+  // Whether the next record is waiting for its recorded delay to pass.
+  BOOL _writePending;
+}
+
+- (instancetype)initWithRecording:(SessionRecording*)recording port:(uint16_t)port {
+  if ((self = [super init])) {
+    _records = recording.records;
+    _port = port;
+    _queue = dispatch_queue_create("org.bluestatic.MacGDBp.SessionReplayer", DISPATCH_QUEUE_SERIAL);
+    _commands = [[NSMutableArray alloc] init];
+    _transactionIDs = [[NSMutableDictionary alloc] init];
+    __weak SessionReplayer* weakSelf = self;
+    _socket = [[EngineSocket alloc] initWithPort:port queue:_queue commandHandler:^(NSString* command) {
+      [weakSelf receiveCommand:command];
+    }];
+  }
+  return self;
+}
+
+- (void)connect {
+  dispatch_async(_queue, ^{
+    if (![self->_socket open]) {
+      NSLog(@"SessionReplayer could not connect to port %d", self->_port);
+      return;
+    }
+    [self replay];
+  });
+}
+
+- (void)disconnect {
+  dispatch_sync(_queue, ^{ [self->_socket close]; });
+}
+
+// Private /////////////////////////////////////////////////////////////////////
+
+- (void)receiveCommand:(NSString*)command {
+  [_commands addObject:command];
+  [self replay];
+}
+
+// Replays records until one needs a command that has not been received yet,
+// or until a record must wait for its recorded delay.
+- (void)replay {
+  while (_socket.open && !_failed && !_writePending && _nextRecord < _records.count) {
+    SessionRecord* record = _records[_nextRecord];
+    if (record.direction == kLogEntrySending) {
+      NSString* recorded = [[NSString alloc] initWithData:record.message encoding:NSUTF8StringEncoding];
+      if (_commands.count == 0) {
+        self.awaitedCommand = recorded;
+        return;
+      }
+      self.awaitedCommand = nil;
+      NSString* command = _commands.firstObject;
+      [_commands removeObjectAtIndex:0];
+      if (![self mapCommand:command toRecorded:recorded]) {
+        [self failWithReason:[NSString stringWithFormat:@"received \"%@\" but the recording has \"%@\"",
+                                 command, recorded]];
+        return;
+      }
+      ++_nextRecord;
+      continue;
+    }
+
+    NSTimeInterval delay = 0;
+    if (self.preservesTiming && _nextRecord > 0)
+      delay = record.timestamp - _records[_nextRecord - 1].timestamp;
+    if (delay > 0) {
+      _writePending = YES;
+      dispatch_after(dispatch_time(DISPATCH_TIME_NOW, delay * NSEC_PER_SEC), _queue, ^{
+        self->_writePending = NO;
+        [self writeNextRecord];
+        [self replay];
+      });
+      return;
+    }
+    [self writeNextRecord];
+  }
+  if (_nextRecord == _records.count)
+    _finished = YES;
+}
+
+// Records that the client sent |command| in place of the |recorded| one.
+// Returns NO if they differ in more than their transaction IDs.
+- (BOOL)mapCommand:(NSString*)command toRecorded:(NSString*)recorded {
+  NSString* rest = nil;
+  NSString* recordedRest = nil;
+  NSString* transactionID = TransactionID(command, &rest);
+  NSString* recordedID = TransactionID(recorded, &recordedRest);
+  if (!transactionID || !recordedID || ![rest isEqualToString:recordedRest])
+    return NO;
+  _transactionIDs[recordedID] = transactionID;
+  return YES;
+}
+
+// Writes the next record, which is a message from the engine, to the client,
+// with the transaction ID of the command that it answers.
+- (void)writeNextRecord {
+  if (_failed)
+    return;
+  NSData* message = MessageWithMappedTransactionID(_records[_nextRecord].message, _transactionIDs);
+  if (!message) {
+    [self failWithReason:[NSString stringWithFormat:@"has no command for record %lu", _nextRecord]];
+    return;
+  }
+  ++_nextRecord;
+  [_socket writeMessage:message];
+}
+
+// Stops the replay, which can no longer give the client the right responses.
+- (void)failWithReason:(NSString*)reason {
+  NSLog(@"SessionReplayer %@", reason);
+  self.awaitedCommand = nil;
+  _failed = YES;
+}
+
+@end
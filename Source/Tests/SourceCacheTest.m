@@ -0,0 +1,112 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "LocalSourceFile.h"
+#import "SourceCache.h"
+
+@interface SourceCacheTest : XCTestCase
+@end
+
+@implementation SourceCacheTest
+
+- (void)testHitsAndMisses {
+  SourceCache* cache = [[SourceCache alloc] initWithCapacity:1024];
+  XCTAssertNil([cache sourceForFile:@"file:///a.php"]);
+  [cache setSource:@"<?php echo 1;" forFile:@"file:///a.php"];
+  XCTAssertEqualObjects(@"<?php echo 1;", [cache sourceForFile:@"file:///a.php"]);
+  XCTAssertEqual(1u, cache.hits);
+  XCTAssertEqual(1u, cache.misses);
+
+  [cache removeAllSources];
+  XCTAssertNil([cache sourceForFile:@"file:///a.php"]);
+  XCTAssertEqual(0u, cache.size);
+  XCTAssertEqual(2u, cache.misses);
+}
+
+- (void)testLocalFileMatches {
+  NSString* directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+  [[NSFileManager defaultManager] createDirectoryAtPath:directory
+                            withIntermediateDirectories:YES
+                                             attributes:nil
+                                                  error:NULL];
+  [self addTeardownBlock:^{
+    [[NSFileManager defaultManager] removeItemAtPath:directory error:NULL];
+  }];
+  NSString* pathA = [directory stringByAppendingPathComponent:@"a.php"];
+  NSString* pathB = [directory stringByAppendingPathComponent:@"b.php"];
+  [@"<?php echo 1;" writeToFile:pathA atomically:NO encoding:NSUTF8StringEncoding error:NULL];
+  [@"<?php echo 2;" writeToFile:pathB atomically:NO encoding:NSUTF8StringEncoding error:NULL];
+  LocalSourceFile* fileA = [LocalSourceFile fileAtPath:pathA error:NULL];
+  LocalSourceFile* fileB = [LocalSourceFile fileAtPath:pathB error:NULL];
+
+  SourceCache* cache = [[SourceCache alloc] initWithCapacity:1024];
+  LocalSourceFile* localFile = nil;
+  XCTAssertEqual(kLocalFileUnchecked, [cache localFileMatchForFile:@"file:///a.php" matchingFile:&localFile]);
+
+  [cache setLocalFile:fileA matches:YES forFile:@"file:///a.php"];
+  [cache setLocalFile:fileB matches:NO forFile:@"file:///b.php"];
+  XCTAssertEqual(kLocalFileMatches, [cache localFileMatchForFile:@"file:///a.php" matchingFile:&localFile]);
+  XCTAssertEqual(fileA, localFile);
+  localFile = nil;
+  XCTAssertEqual(kLocalFileDiffers, [cache localFileMatchForFile:@"file:///b.php" matchingFile:&localFile]);
+  XCTAssertNil(localFile);
+  XCTAssertEqual(0u, cache.size);
+
+  // A local copy that changes on disk has to be compared again.
+  [@"<?php echo 22;" writeToFile:pathB atomically:NO encoding:NSUTF8StringEncoding error:NULL];
+  XCTAssertEqual(kLocalFileUnchecked, [cache localFileMatchForFile:@"file:///b.php" matchingFile:&localFile]);
+
+  [cache removeAllSources];
+  XCTAssertEqual(kLocalFileUnchecked, [cache localFileMatchForFile:@"file:///a.php" matchingFile:&localFile]);
+}
+
+- (void)testIdenticalContentsAreShared {
+  SourceCache* cache = [[SourceCache alloc] initWithCapacity:1024];
+  NSString* a = [cache setSource:[NSMutableString stringWithString:@"<?php echo 1;"] forFile:@"file:///a.php"];
+  NSString* b = [cache setSource:[NSMutableString stringWithString:@"<?php echo 1;"] forFile:@"file:///b.php"];
+  XCTAssertEqual(a, b);
+  XCTAssertEqual(a.length * sizeof(unichar), cache.size);
+
+  // The shared contents are counted until the last file is removed.
+  [cache setSource:@"<?php echo 2;" forFile:@"file:///a.php"];
+  XCTAssertEqual(2 * a.length * sizeof(unichar), cache.size);
+  [cache setSource:@"<?php echo 2;" forFile:@"file:///b.php"];
+  XCTAssertEqual(a.length * sizeof(unichar), cache.size);
+}
+
+- (void)testEvictsLeastRecentlyUsed {
+  // Each source is 10 characters, or 20 bytes.
+  SourceCache* cache = [[SourceCache alloc] initWithCapacity:50];
+  [cache setSource:@"aaaaaaaaaa" forFile:@"file:///a.php"];
+  [cache setSource:@"bbbbbbbbbb" forFile:@"file:///b.php"];
+  XCTAssertNotNil([cache sourceForFile:@"file:///a.php"]);
+
+  [cache setSource:@"cccccccccc" forFile:@"file:///c.php"];
+  XCTAssertEqual(40u, cache.size);
+  XCTAssertNotNil([cache sourceForFile:@"file:///a.php"]);
+  XCTAssertNil([cache sourceForFile:@"file:///b.php"]);
+  XCTAssertNotNil([cache sourceForFile:@"file:///c.php"]);
+}
+
+- (void)testKeepsSourceLargerThanCapacity {
+  SourceCache* cache = [[SourceCache alloc] initWithCapacity:4];
+  [cache setSource:@"aaaaaaaaaa" forFile:@"file:///a.php"];
+  XCTAssertNotNil([cache sourceForFile:@"file:///a.php"]);
+}
+
+@end
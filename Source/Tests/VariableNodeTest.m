@@ -0,0 +1,398 @@
+/*
+ * MacGDBp
+ * Copyright (c) 2026, Blue Static <https://www.bluestatic.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU
+ * General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if not,
+ * write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "ProtocolResponse.h"
+#import "ResponseFixtures.h"
+#import "VariableNode.h"
+
+@interface VariableNodeTest : XCTestCase
+@end
+
+// Returns the int elements of $a that are in [start, end).
+static NSArray<VariableNode*>* MakeElements(NSUInteger start, NSUInteger end) {
+  NSMutableArray<VariableNode*>* elements = [NSMutableArray array];
+  for (NSUInteger i = start; i < end; ++i) {
+    NSString* name = [NSString stringWithFormat:@"%lu", i];
+    NSDictionary* attributes = @{
+      @"name" : name,
+      @"fullname" : [NSString stringWithFormat:@"$a[%lu]", i],
+      @"type" : @"int",
+    };
+    [elements addObject:[[VariableNode alloc] initWithAttributes:attributes
+                                                     textContent:name
+                                                        children:@[]]];
+  }
+  return elements;
+}
+
+// Returns the array $a with |count| elements, of which the first page of
+// |pageSize| was received as |elements|.
+static VariableNode* MakeArrayWithElements(NSUInteger count,
+                                           NSUInteger pageSize,
+                                           NSArray<VariableNode*>* elements) {
+  NSDictionary* attributes = @{
+    @"name" : @"$a",
+    @"fullname" : @"$a",
+    @"type" : @"array",
+    @"children" : @"1",
+    @"numchildren" : [NSString stringWithFormat:@"%lu", count],
+    @"page" : @"0",
+    @"pagesize" : [NSString stringWithFormat:@"%lu", pageSize],
+  };
+  return [[VariableNode alloc] initWithAttributes:attributes
+                                      textContent:nil
+                                         children:elements];
+}
+
+// Returns the array $a with |count| elements, of which the first page of
+// |pageSize| was received.
+static VariableNode* MakeArray(NSUInteger count, NSUInteger pageSize) {
+  return MakeArrayWithElements(count, pageSize, MakeElements(0, MIN(count, pageSize)));
+}
+
+// Returns the first page of |pageSize| children of an object $a, which starts
+// with its CLASSNAME property followed by elements.
+static NSArray<VariableNode*>* MakeFirstPageWithClassName(NSUInteger pageSize) {
+  NSDictionary* attributes = @{ @"name" : @"CLASSNAME", @"type" : @"string" };
+  VariableNode* className = [[VariableNode alloc] initWithAttributes:attributes
+                                                         textContent:@"Foo"
+                                                            children:@[]];
+  return [@[ className ] arrayByAddingObjectsFromArray:MakeElements(0, pageSize - 1)];
+}
+
+@implementation VariableNodeTest
+
+- (void)testPlaceholders {
+  VariableNode* array = MakeArray(100, 32);
+  XCTAssertEqual(32u, array.pageSize);
+  XCTAssertFalse([array childrenLoaded]);
+  XCTAssertEqualObjects(@"…", array.value);
+  XCTAssertEqual(32u, [array childrenOfPage:0].count);
+  XCTAssertEqual(0u, [array childrenOfPage:1].count);
+
+  XCTAssertEqual(100u, array.children.count);
+  XCTAssertEqualObjects(@"$a[31]", array.children[31].fullName);
+  VariableNode* placeholder = array.children[32];
+  XCTAssertTrue(placeholder.isPlaceholder);
+  XCTAssertTrue([placeholder isLeaf]);
+  XCTAssertEqual(array, placeholder.parent);
+  XCTAssertEqual(32u, placeholder.indexInParent);
+  XCTAssertEqual(1u, [array pageForChildAtIndex:placeholder.indexInParent]);
+  XCTAssertEqual(3u, [array pageForChildAtIndex:99]);
+}
+
+- (void)testSetPage {
+  VariableNode* array = MakeArray(100, 32);
+  XCTAssertFalse([array needsPage:0]);
+  XCTAssertTrue([array needsPage:3]);
+  [array setPageRequested:3];
+  XCTAssertFalse([array needsPage:3]);
+
+  // Pages received before the children are built are placed when they are.
+  [array setChildren:MakeElements(96, 100) forPage:3];
+  XCTAssertEqualObjects(@"$a[96]", array.children[96].fullName);
+  XCTAssertTrue(array.children[95].isPlaceholder);
+
+  // Once built, only the page's children are replaced.
+  NSArray<VariableNode*>* before = array.children;
+  [self keyValueObservingExpectationForObject:array
+                                      keyPath:@"children"
+                                      handler:^BOOL(id object, NSDictionary* change) {
+    NSIndexSet* indexes = change[NSKeyValueChangeIndexesKey];
+    return [change[NSKeyValueChangeKindKey] integerValue] == NSKeyValueChangeReplacement &&
+        [indexes isEqualToIndexSet:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(32, 32)]];
+  }];
+  [array setChildren:MakeElements(32, 64) forPage:1];
+  [self waitForExpectationsWithTimeout:0 handler:nil];
+  XCTAssertEqual(before[0], array.children[0]);
+  XCTAssertEqualObjects(@"$a[63]", array.children[63].fullName);
+  XCTAssertFalse([array childrenLoaded]);
+
+  [array setChildren:MakeElements(64, 96) forPage:2];
+  XCTAssertTrue([array childrenLoaded]);
+  XCTAssertTrue([array.value hasPrefix:@"(\n\t0\t=>\t0\n"]);
+}
+
+- (void)testCancelPageRequest {
+  VariableNode* array = MakeArray(100, 32);
+  [array setPageRequested:1];
+  [array cancelPageRequest:1];
+  XCTAssertTrue([array needsPage:1]);
+}
+
+- (void)testHiddenClassName {
+  // The first page holds CLASSNAME and the first 31 elements.
+  VariableNode* object = MakeArrayWithElements(65, 32, MakeFirstPageWithClassName(32));
+  XCTAssertEqual(64u, object.childCount);
+  XCTAssertEqual(64u, object.children.count);
+  [object setChildren:MakeElements(31, 63) forPage:1];
+
+  XCTAssertEqual(31u, [object childrenOfPage:0].count);
+  XCTAssertEqualObjects(@"$a[30]", [object childrenOfPage:0].lastObject.fullName);
+  XCTAssertEqual(32u, [object childrenOfPage:1].count);
+  XCTAssertEqualObjects(@"$a[31]", [object childrenOfPage:1].firstObject.fullName);
+  XCTAssertEqual(2u, [object pageForChildAtIndex:63]);
+
+  // A later page that arrives before the first is moved back into place when
+  // CLASSNAME is hidden.
+  object = MakeArrayWithElements(65, 32, @[]);
+  XCTAssertEqual(65u, object.children.count);
+  [object setChildren:MakeElements(31, 63) forPage:1];
+  XCTAssertEqualObjects(@"$a[31]", object.children[32].fullName);
+
+  [object setChildren:MakeFirstPageWithClassName(32) forPage:0];
+  XCTAssertEqual(64u, object.children.count);
+  XCTAssertEqualObjects(@"$a[30]", object.children[30].fullName);
+  XCTAssertEqualObjects(@"$a[31]", object.children[31].fullName);
+  XCTAssertEqualObjects(@"$a[62]", object.children[62].fullName);
+  XCTAssertTrue(object.children[63].isPlaceholder);
+  XCTAssertEqual(31u, [object childrenOfPage:0].count);
+  XCTAssertEqualObjects(@"$a[31]", [object childrenOfPage:1].firstObject.fullName);
+}
+
+- (void)testFormattedValueIsCached {
+  VariableNode* array = MakeArray(3, 32);
+  NSString* value = array.value;
+  XCTAssertEqualObjects(@"(\n\t0\t=>\t0\n\t1\t=>\t1\n\t2\t=>\t2\n)", value);
+  XCTAssertEqual(value, array.value);
+}
+
+- (void)testFormattedValueInvalidatedByNestedPage {
+  VariableNode* inner = MakeArray(40, 32);
+  NSDictionary* attributes = @{
+    @"name" : @"$o",
+    @"fullname" : @"$o",
+    @"type" : @"object",
+    @"children" : @"1",
+    @"numchildren" : @"1",
+  };
+  VariableNode* outer = [[VariableNode alloc] initWithAttributes:attributes
+                                                     textContent:nil
+                                                        children:@[ inner ]];
+  XCTAssertEqual(outer, inner.parent);
+  XCTAssertEqualObjects(@"(\n\t$a\t=>\t…\n)", outer.value);
+
+  [self keyValueObservingExpectationForObject:outer keyPath:@"value" handler:nil];
+  [inner setChildren:MakeElements(32, 40) forPage:1];
+  [self waitForExpectationsWithTimeout:0 handler:nil];
+  XCTAssertTrue([outer.value hasSuffix:@"\t\t39\t=>\t39\n\t)\n)"]);
+}
+
+- (void)testFormattedValueIsTruncated {
+  VariableNode* array = MakeArray(20000, 20000);
+  NSString* value = array.value;
+  XCTAssertTrue([value hasPrefix:@"(\n\t0\t=>\t0\n"]);
+  XCTAssertTrue([value hasSuffix:@"\n…"]);
+  XCTAssertLessThanOrEqual(value.length, 64u * 1024 + 2);
+}
+
+- (void)testMergeReusesUnchangedLeaves {
+  NSArray<VariableNode*>* previous = MakeElements(0, 3);
+  NSMutableArray<VariableNode*>* nodes = [MakeElements(0, 4) mutableCopy];
+  NSDictionary* attributes = @{ @"name" : @"1", @"fullname" : @"$a[1]", @"type" : @"int" };
+  nodes[1] = [[VariableNode alloc] initWithAttributes:attributes textContent:@"42" children:@[]];
+
+  NSArray<VariableNode*>* merged = [VariableNode nodesByMergingNodes:nodes
+                                                        withPrevious:previous
+                                                            expanded:nil
+                                                           reloading:nil];
+  XCTAssertEqual(4u, merged.count);
+  XCTAssertEqual(previous[0], merged[0]);
+  XCTAssertFalse(merged[0].changed);
+  XCTAssertEqual(nodes[1], merged[1]);
+  XCTAssertTrue(merged[1].changed);
+  XCTAssertEqual(previous[2], merged[2]);
+  XCTAssertEqual(nodes[3], merged[3]);
+  XCTAssertTrue(merged[3].changed);
+
+  // Without previous nodes, nothing is flagged.
+  merged = [VariableNode nodesByMergingNodes:nodes
+                                withPrevious:nil
+                                    expanded:nil
+                                   reloading:nil];
+  XCTAssertEqual(nodes[0], merged[0]);
+  XCTAssertFalse(merged[0].changed);
+}
+
+- (void)testMergeMatchesAddress {
+  NSDictionary* attributes = @{ @"name" : @"$x", @"fullname" : @"$x", @"type" : @"int", @"address" : @"1" };
+  VariableNode* old = [[VariableNode alloc] initWithAttributes:attributes textContent:@"1" children:@[]];
+  attributes = @{ @"name" : @"$x", @"fullname" : @"$x", @"type" : @"int", @"address" : @"2" };
+  VariableNode* node = [[VariableNode alloc] initWithAttributes:attributes textContent:@"1" children:@[]];
+  NSArray<VariableNode*>* merged = [VariableNode nodesByMergingNodes:@[ node ]
+                                                        withPrevious:@[ old ]
+                                                            expanded:nil
+                                                           reloading:nil];
+  XCTAssertEqual(node, merged[0]);
+  XCTAssertTrue(node.changed);
+}
+
+- (void)testMergeReloadsLoadedPages {
+  VariableNode* old = MakeArray(100, 32);
+  [old setChildren:MakeElements(64, 96) forPage:2];
+
+  // The first page is sent again, with a different value for $a[5].
+  NSMutableArray<VariableNode*>* elements = [MakeElements(0, 32) mutableCopy];
+  NSDictionary* attributes = @{ @"name" : @"5", @"fullname" : @"$a[5]", @"type" : @"int" };
+  elements[5] = [[VariableNode alloc] initWithAttributes:attributes textContent:@"55" children:@[]];
+  VariableNode* array = MakeArrayWithElements(100, 32, elements);
+
+  __block NSUInteger reloads = 0;
+  NSArray<VariableNode*>* merged =
+      [VariableNode nodesByMergingNodes:@[ array ]
+                           withPrevious:@[ old ]
+                               expanded:[NSSet setWithObject:@"$a"]
+                              reloading:^(VariableNode* node, NSUInteger page, NSArray<VariableNode*>* previous) {
+    XCTAssertEqual(array, node);
+    XCTAssertEqual(2u, page);
+    XCTAssertEqualObjects(@"$a[64]", previous.firstObject.fullName);
+    ++reloads;
+  }];
+  XCTAssertEqual(array, merged[0]);
+  XCTAssertFalse(array.changed);
+  XCTAssertFalse(elements[4].changed);
+  XCTAssertTrue(elements[5].changed);
+  XCTAssertEqual(1u, reloads);
+}
+
+- (void)testMergeDoesNotReloadCollapsedPages {
+  VariableNode* old = MakeArray(100, 32);
+  [old setChildren:MakeElements(64, 96) forPage:2];
+  VariableNode* array = MakeArray(100, 32);
+
+  NSArray<VariableNode*>* merged =
+      [VariableNode nodesByMergingNodes:@[ array ]
+                           withPrevious:@[ old ]
+                               expanded:[NSSet set]
+                              reloading:^(VariableNode* node, NSUInteger page, NSArray<VariableNode*>* previous) {
+    XCTFail(@"Reloaded page %lu of a collapsed node", page);
+  }];
+  XCTAssertEqual(array, merged[0]);
+  XCTAssertTrue([array needsPage:2]);
+  XCTAssertTrue(array.children[64].isPlaceholder);
+}
+
+- (void)testInternedTypes {
+  ProtocolResponse* response =
+      [ProtocolResponse responseWithData:MakeObjectTreeContextGetResponse(2) error:NULL];
+  VariableNode* objects = response.properties[0];
+  VariableNode* first = objects.children[0];
+  VariableNode* second = objects.children[1];
+  XCTAssertEqualObjects(@"Item", first.className);
+  XCTAssertEqual(first.className, second.className);
+  XCTAssertEqual(first.type, second.type);
+  XCTAssertEqual(first.children[1].type, second.children[1].type);
+}
+
+- (void)testSharedFullName {
+  ProtocolResponse* response =
+      [ProtocolResponse responseWithData:MakeObjectTreeContextGetResponse(2) error:NULL];
+  VariableNode* objects = response.properties[0];
+  XCTAssertEqualObjects(@"$objects", objects.fullName);
+  XCTAssertEqualObjects(@"$objects[1]", objects.children[1].fullName);
+  XCTAssertEqualObjects(@"$objects[1]->name", objects.children[1].children[1].fullName);
+
+  // A child whose full name does not extend its parent's keeps all of it.
+  NSDictionary* attributes = @{ @"name" : @"x", @"fullname" : @"$b", @"type" : @"int" };
+  VariableNode* other = [[VariableNode alloc] initWithAttributes:attributes
+                                                     textContent:@"1"
+                                                        children:@[]];
+  VariableNode* array = MakeArray(2, 1);
+  [array setChildren:@[ other ] forPage:1];
+  XCTAssertEqualObjects(@"$a[0]", array.children[0].fullName);
+  XCTAssertEqualObjects(@"$b", array.children[1].fullName);
+}
+
+- (void)testLazyValue {
+  ProtocolResponse* response =
+      [ProtocolResponse responseWithData:MakeObjectTreeContextGetResponse(3) error:NULL];
+  VariableNode* item = response.properties[0].children[2];
+  XCTAssertEqualObjects(@"2", item.children[0].value);
+  XCTAssertEqualObjects(@"Item 2", item.children[1].value);
+  XCTAssertEqualObjects(@"Item 2", item.children[1].value);
+}
+
+- (void)testPerformanceDecodeObjectTree {
+  // 3 * 16667 + 1 = 50002 nodes.
+  NSData* data = MakeObjectTreeContextGetResponse(16667);
+  void (^decode)(void) = ^{
+    ProtocolResponse* response = [ProtocolResponse responseWithData:data error:NULL];
+    XCTAssertEqual(16667u, response.properties[0].childCount);
+  };
+  if (@available(macOS 10.15, *)) {
+    [self measureWithMetrics:@[ [[XCTMemoryMetric alloc] init], [[XCTClockMetric alloc] init] ]
+                       block:decode];
+  } else {
+    [self measureBlock:decode];
+  }
+}
+
+// Like the above, but also decodes every value, as was done before values
+// were kept encoded. The difference in memory is the cost of the values that a
+// collapsed tree never shows.
+- (void)testPerformanceDecodeObjectTreeValues {
+  NSData* data = MakeObjectTreeContextGetResponse(16667);
+  void (^decode)(void) = ^{
+    ProtocolResponse* response = [ProtocolResponse responseWithData:data error:NULL];
+    for (VariableNode* item in response.properties[0].children) {
+      for (VariableNode* property in item.children)
+        XCTAssertNotNil(property.value);
+    }
+  };
+  if (@available(macOS 10.15, *)) {
+    [self measureWithMetrics:@[ [[XCTMemoryMetric alloc] init], [[XCTClockMetric alloc] init] ]
+                       block:decode];
+  } else {
+    [self measureBlock:decode];
+  }
+}
+
+- (void)testPerformanceFormattedValue {
+  [self measureMetrics:[[self class] defaultPerformanceMetrics]
+      automaticallyStartMeasuring:NO
+                         forBlock:^{
+    // Use fresh nodes, so that each value is rendered rather than read from the
+    // cache.
+    NSMutableArray<VariableNode*>* arrays = [NSMutableArray array];
+    for (int i = 0; i < 20; ++i)
+      [arrays addObject:MakeArray(2000, 2000)];
+
+    [self startMeasuring];
+    for (VariableNode* array in arrays)
+      XCTAssertNotNil(array.value);
+    [self stopMeasuring];
+  }];
+}
+
+- (void)testPerformanceLoadLargeArrayPages {
+  const NSUInteger kCount = 100000;
+  const NSUInteger kPageSize = 32;
+  NSMutableArray<NSArray<VariableNode*>*>* pages = [NSMutableArray array];
+  for (NSUInteger start = kPageSize; start < kCount; start += kPageSize)
+    [pages addObject:MakeElements(start, MIN(start + kPageSize, kCount))];
+
+  [self measureBlock:^{
+    VariableNode* array = MakeArray(kCount, kPageSize);
+    XCTAssertEqual(kCount, array.children.count);
+    for (NSUInteger page = 1; page <= pages.count; ++page)
+      [array setChildren:pages[page - 1] forPage:page];
+    XCTAssertTrue([array childrenLoaded]);
+  }];
+}
+
+@end
@@ -16,6 +16,8 @@
 
 #import <Cocoa/Cocoa.h>
 
+@class EncodedValue;
+
 // A VariableNode represents a property in the variable list display. It
 // converts XML response nodes to this format and extracts all the necessary
 // information. The fields of this class are defined by the spec:
@@ -27,21 +29,91 @@
 @property(readonly, nonatomic) NSString* className;
 @property(readonly, nonatomic) NSString* type;
 @property(readonly, nonatomic) NSString* value;
-@property(readonly, nonatomic) NSArray* children;
 @property(readonly, nonatomic) unsigned long childCount;
 @property(readonly, nonatomic) NSString* address;
 
+// Whether this property is new or its value differs from the last time the
+// program stopped.
+@property(readonly, nonatomic) BOOL changed;
+
+// The child properties. The engine sends children in pages, and children that
+// have not been fetched are represented by placeholder nodes, so this always
+// has |childCount| elements. The array is only built when first accessed.
+@property(readonly, nonatomic) NSArray<VariableNode*>* children;
+
+// The number of children in each page.
+@property(readonly, nonatomic) NSUInteger pageSize;
+
+// The node whose children include this one.
+@property(readonly, weak, nonatomic) VariableNode* parent;
+
+// Whether this node stands in for a child that has not been fetched yet. For
+// placeholders, |parent| is the node that will receive the child, and
+// |indexInParent| is its position in the parent's children.
+@property(readonly, nonatomic) BOOL isPlaceholder;
+@property(readonly, nonatomic) NSUInteger indexInParent;
+
+// Creates and initializes a new VariableNode from the attributes and text
+// content of a <property> element, and the nodes for its child properties.
+- (instancetype)initWithAttributes:(NSDictionary<NSString*, NSString*>*)attributes
+                       textContent:(NSString*)text
+                          children:(NSArray<VariableNode*>*)children;
+
+// Like the above, but for a property whose base64 value is kept encoded until
+// it is first read. |value| is nil if the property has no value.
+- (instancetype)initWithAttributes:(NSDictionary<NSString*, NSString*>*)attributes
+                      encodedValue:(EncodedValue*)value
+                          children:(NSArray<VariableNode*>*)children;
+
 // Creates and initializes a new VariableNode from the XML response from the
 // debugger backend.
 - (instancetype)initWithXMLNode:(NSXMLElement*)node;
 
-// When properties are asynchrnously loaded, this method can be used to set
-// the children on a node from the list of children from the XML response.
-- (void)setChildrenFromXMLChildren:(NSArray*)children;
+// Called by |+nodesByMergingNodes:withPrevious:expanded:reloading:| for each
+// page of children that |previous| had loaded and |node| has not, with the
+// children of that page in |previous|.
+typedef void (^VariableNodeReloadBlock)(VariableNode* node,
+                                        NSUInteger page,
+                                        NSArray<VariableNode*>* previous);
+
+// Merges the |nodes| of a response with the |previous| nodes in their place,
+// from before the program last ran. Nodes are matched by their full name and
+// address. A leaf whose value has not changed is replaced by its previous
+// node, and any other node that is new or different is flagged as |changed|.
+// The children of containers are not sent again, so for each page of a
+// matched container that was loaded before, this either merges the page's
+// children, if |nodes| includes them, or calls |reload| to fetch them. Only
+// the containers whose full names are in |expanded| are reloaded; the pages
+// of collapsed ones are left to be fetched when they are next expanded.
++ (NSArray<VariableNode*>*)nodesByMergingNodes:(NSArray<VariableNode*>*)nodes
+                                  withPrevious:(NSArray<VariableNode*>*)previous
+                                      expanded:(NSSet<NSString*>*)expanded
+                                     reloading:(VariableNodeReloadBlock)reload;
 
 // Whether or not this is a leaf node (i.e. does not have child properties).
 - (BOOL)isLeaf;
 
+// Whether every page of children has been fetched.
+- (BOOL)childrenLoaded;
+
+// Returns the page that contains the child at |index|.
+- (NSUInteger)pageForChildAtIndex:(NSUInteger)index;
+
+// Returns YES if |page| has been neither fetched nor requested.
+- (BOOL)needsPage:(NSUInteger)page;
+
+// Records that |page| has been requested, or that the request failed.
+- (void)setPageRequested:(NSUInteger)page;
+- (void)cancelPageRequest:(NSUInteger)page;
+
+// Returns the children of |page| that have been received, without building
+// the placeholders for the rest.
+- (NSArray<VariableNode*>*)childrenOfPage:(NSUInteger)page;
+
+// When properties are asynchrnously loaded, this method can be used to set
+// the children of a single page, replacing their placeholders.
+- (void)setChildren:(NSArray<VariableNode*>*)children forPage:(NSUInteger)page;
+
 // Returns a formatted type and classname display.
 - (NSString*)displayType;
 
@@ -18,45 +18,295 @@
 
 #include "NSXMLElementAdditions.h"
 
+// The number of children in a page when the engine does not say. This is
+// Xdebug's default for the max_children feature.
+static const NSUInteger kDefaultPageSize = 32;
+
+// The formatted value of a node with children is cut off after this many
+// characters, and ends with kTruncationMarker instead.
+static const NSUInteger kMaxFormattedValueLength = 64 * 1024;
+static NSString* const kTruncationMarker = @"\n…";
+
+// Returns the indentation for |depth|, sharing the strings for common depths.
+static NSString* IndentString(NSUInteger depth) {
+  static const NSUInteger kSharedIndents = 16;
+  static NSArray<NSString*>* indents = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    NSMutableArray<NSString*>* array = [NSMutableArray arrayWithCapacity:kSharedIndents];
+    NSMutableString* indent = [NSMutableString string];
+    for (NSUInteger i = 0; i < kSharedIndents; ++i) {
+      [array addObject:[indent copy]];
+      [indent appendString:@"\t"];
+    }
+    indents = array;
+  });
+
+  if (depth < indents.count)
+    return indents[depth];
+  return [@"" stringByPaddingToLength:depth withString:@"\t" startingAtIndex:0];
+}
+
+// Returns whether |a| and |b| are both nil or are equal strings.
+static inline BOOL StringsEqual(NSString* a, NSString* b) {
+  return a == b || [a isEqualToString:b];
+}
+
+// Returns a shared instance of |string|. Types and class names repeat across
+// most of the nodes in a tree, so each distinct one is only stored once.
+static NSString* InternedString(NSString* string) {
+  if (!string)
+    return nil;
+
+  static NSMutableSet<NSString*>* table = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    table = [[NSMutableSet alloc] init];
+  });
+
+  @synchronized(table) {
+    NSString* interned = [table member:string];
+    if (!interned) {
+      interned = [string copy];
+      [table addObject:interned];
+    }
+    return interned;
+  }
+}
+
 @implementation VariableNode {
-  NSMutableArray* _children;
+  // The children, with placeholders for those not yet fetched. This is built
+  // when first accessed.
+  NSMutableArray<VariableNode*>* _children;
+
+  // Pages of children received before |_children| was built, keyed by page.
+  NSMutableDictionary<NSNumber*, NSArray<VariableNode*>*>* _pendingPages;
+
+  // The pages that have been received, and those that are in flight. These
+  // are created when first needed.
+  NSMutableIndexSet* _loadedPages;
+  NSMutableIndexSet* _requestedPages;
+
+  // The number of children that have been received.
+  NSUInteger _loadedChildCount;
+
+  // The number of children that were received but are not shown. These are
+  // assumed to be at the start of the first page.
+  NSUInteger _hiddenChildCount;
+
+  // The full name is the parent's full name, which is shared by all of its
+  // children, followed by |_fullNameSuffix|. Without a prefix, the suffix is
+  // the whole name.
+  NSString* _fullNamePrefix;
+  NSString* _fullNameSuffix;
+
+  // The value, unless it is base64-encoded, in which case |_encodedValue|
+  // decodes it on first access.
   NSString* _nodeValue;
+  EncodedValue* _encodedValue;
+
+  // The print_r()-style value of a node with children, built when first
+  // requested and cleared when the children change.
+  NSString* _formattedValue;
+}
+
+- (instancetype)initWithAttributes:(NSDictionary<NSString*, NSString*>*)attributes
+                       textContent:(NSString*)text
+                          children:(NSArray<VariableNode*>*)children {
+  // Most values are never displayed, so keep them encoded until they are.
+  if ([attributes[@"encoding"] isEqualToString:@"base64"]) {
+    return [self initWithAttributes:attributes
+                       encodedValue:[[EncodedValue alloc] initWithString:text]
+                           children:children];
+  }
+
+  if ((self = [self initWithAttributes:attributes encodedValue:nil children:children])) {
+    _nodeValue = [DecodedElementValue(text, attributes[@"encoding"], attributes[@"children"]) copy];
+  }
+  return self;
 }
 
-- (id)initWithXMLNode:(NSXMLElement*)node {
+- (instancetype)initWithAttributes:(NSDictionary<NSString*, NSString*>*)attributes
+                      encodedValue:(EncodedValue*)value
+                          children:(NSArray<VariableNode*>*)children {
   if (self = [super init]) {
-    _name       = [[[node attributeForName:@"name"] stringValue] copy];
-    _fullName   = [[[node attributeForName:@"fullname"] stringValue] copy];
-    _className  = [[[node attributeForName:@"classname"] stringValue] copy];
-    _type       = [[[node attributeForName:@"type"] stringValue] copy];
-    _nodeValue  = [[node base64DecodedValue] copy];
-    _children   = [[NSMutableArray alloc] init];
-    if ([node children]) {
-      [self setChildrenFromXMLChildren:[node children]];
-    }
-    _childCount = [[[node attributeForName:@"numchildren"] stringValue] integerValue];
-    _address    = [[[node attributeForName:@"address"] stringValue] copy];
+    _name       = [attributes[@"name"] copy];
+    _fullNameSuffix = [attributes[@"fullname"] copy];
+    _className  = InternedString(attributes[@"classname"]);
+    _type       = InternedString(attributes[@"type"]);
+    _childCount = attributes[@"numchildren"] ? [attributes[@"numchildren"] integerValue] : children.count;
+    _pageSize   = [attributes[@"pagesize"] integerValue] ?: kDefaultPageSize;
+    _address    = [attributes[@"address"] copy];
+
+    _encodedValue = value;
+
+    if (children.count)
+      [self setChildren:children forPage:[attributes[@"page"] integerValue]];
+  }
+  return self;
+}
+
+/**
+ * Creates a placeholder for the child of |parent| at |index|.
+ */
+- (instancetype)initPlaceholderForParent:(VariableNode*)parent index:(NSUInteger)index {
+  if ((self = [super init])) {
+    _name = @"…";
+    _isPlaceholder = YES;
+    _parent = parent;
+    _indexInParent = index;
   }
   return self;
 }
 
-- (void)setChildrenFromXMLChildren:(NSArray*)children {
-  [self willChangeValueForKey:@"children"];
++ (NSArray<VariableNode*>*)nodesByMergingNodes:(NSArray<VariableNode*>*)nodes
+                                  withPrevious:(NSArray<VariableNode*>*)previous
+                                      expanded:(NSSet<NSString*>*)expanded
+                                     reloading:(VariableNodeReloadBlock)reload {
+  if (!previous)
+    return nodes;
 
-  [_children removeAllObjects];
+  NSMutableDictionary<NSString*, VariableNode*>* previousByKey =
+      [NSMutableDictionary dictionaryWithCapacity:previous.count];
+  for (VariableNode* node in previous) {
+    if (!node.isPlaceholder)
+      previousByKey[[node mergeKey]] = node;
+  }
+
+  NSMutableArray<VariableNode*>* merged = [NSMutableArray arrayWithCapacity:nodes.count];
+  for (VariableNode* node in nodes) {
+    VariableNode* old = previousByKey[[node mergeKey]];
+    if (!old || ![node hasSameValueAs:old]) {
+      node->_changed = YES;
+      [merged addObject:node];
+    } else if (node.isLeaf) {
+      old->_changed = NO;
+      [merged addObject:old];
+    } else {
+      node->_changed = NO;
+      [merged addObject:node];
+
+      BOOL isExpanded = [expanded containsObject:node.fullName];
+      [old->_loadedPages enumerateIndexesUsingBlock:^(NSUInteger page, BOOL* stop) {
+        if ([node->_loadedPages containsIndex:page]) {
+          // The page was sent again, and only needs its changes flagged.
+          [self nodesByMergingNodes:[node childrenOfPage:page]
+                       withPrevious:[old childrenOfPage:page]
+                           expanded:expanded
+                          reloading:reload];
+        } else if (isExpanded) {
+          reload(node, page, [old childrenOfPage:page]);
+        }
+      }];
+    }
+  }
+  return merged;
+}
+
+- (instancetype)initWithXMLNode:(NSXMLElement*)node {
+  NSMutableDictionary<NSString*, NSString*>* attributes = [NSMutableDictionary dictionary];
+  for (NSXMLNode* attribute in [node attributes]) {
+    attributes[[attribute name]] = [attribute stringValue];
+  }
 
-  for (NSXMLNode* child in children) {
+  NSMutableArray<VariableNode*>* children = [NSMutableArray array];
+  for (NSXMLNode* child in [node children]) {
     // Other child nodes may be the string value.
-    if ([child isKindOfClass:[NSXMLElement class]]) {
-      VariableNode* node = [[VariableNode alloc] initWithXMLNode:(NSXMLElement*)child];
-      // Don't include the CLASSNAME property as that information is retrieved
-      // elsewhere.
-      if (![node.name isEqualToString:@"CLASSNAME"])
-        [_children addObject:node];
+    if ([child isKindOfClass:[NSXMLElement class]])
+      [children addObject:[[VariableNode alloc] initWithXMLNode:(NSXMLElement*)child]];
+  }
+
+  return [self initWithAttributes:attributes
+                      textContent:[node stringValue]
+                         children:children];
+}
+
+- (NSString*)fullName {
+  if (!_fullNamePrefix)
+    return _fullNameSuffix;
+  return [_fullNamePrefix stringByAppendingString:_fullNameSuffix];
+}
+
+- (NSArray<VariableNode*>*)children {
+  if (!_children)
+    [self buildChildren];
+  return _children;
+}
+
+- (BOOL)childrenLoaded {
+  return _loadedChildCount >= _childCount;
+}
+
+- (NSUInteger)pageForChildAtIndex:(NSUInteger)index {
+  return (index + _hiddenChildCount) / _pageSize;
+}
+
+- (BOOL)needsPage:(NSUInteger)page {
+  return ![_loadedPages containsIndex:page] && ![_requestedPages containsIndex:page];
+}
+
+- (void)setPageRequested:(NSUInteger)page {
+  if (!_requestedPages)
+    _requestedPages = [[NSMutableIndexSet alloc] init];
+  [_requestedPages addIndex:page];
+}
+
+- (void)cancelPageRequest:(NSUInteger)page {
+  [_requestedPages removeIndex:page];
+}
+
+- (NSArray<VariableNode*>*)childrenOfPage:(NSUInteger)page {
+  if (![_loadedPages containsIndex:page])
+    return @[];
+  if (!_children)
+    return _pendingPages[@(page)];
+  NSRange range = [self rangeOfPage:page count:_pageSize];
+  return [_children subarrayWithRange:range];
+}
+
+- (void)setChildren:(NSArray<VariableNode*>*)children forPage:(NSUInteger)page {
+  [_requestedPages removeIndex:page];
+  if ([_loadedPages containsIndex:page])
+    return;
+  if (!_loadedPages)
+    _loadedPages = [[NSMutableIndexSet alloc] init];
+  [_loadedPages addIndex:page];
+
+  NSString* fullName = self.fullName;
+  NSMutableArray<VariableNode*>* shown = [NSMutableArray arrayWithCapacity:children.count];
+  NSUInteger hidden = 0;
+  for (VariableNode* node in children) {
+    // Don't include the CLASSNAME property as that information is retrieved
+    // elsewhere.
+    if ([node.name isEqualToString:@"CLASSNAME"]) {
+      ++hidden;
+    } else {
+      [node shareFullNamePrefix:fullName];
+      node->_parent = self;
+      [shown addObject:node];
     }
   }
+  _loadedChildCount += shown.count;
+  if (hidden)
+    [self hideChildren:MIN(hidden, _childCount)];
 
-  [self didChangeValueForKey:@"children"];
+  // Until the children are first accessed, just hold on to the page. Nothing
+  // can have observed the children yet.
+  if (!_children) {
+    if (!_pendingPages)
+      _pendingPages = [[NSMutableDictionary alloc] init];
+    _pendingPages[@(page)] = shown;
+  } else {
+    NSRange range = [self rangeOfPage:page count:shown.count];
+    if (range.length) {
+      NSIndexSet* indexes = [NSIndexSet indexSetWithIndexesInRange:range];
+      [self willChange:NSKeyValueChangeReplacement valuesAtIndexes:indexes forKey:@"children"];
+      [_children replaceObjectsInRange:range withObjectsFromArray:shown range:NSMakeRange(0, range.length)];
+      [self didChange:NSKeyValueChangeReplacement valuesAtIndexes:indexes forKey:@"children"];
+    }
+  }
+
+  [self invalidateFormattedValue];
 }
 
 - (BOOL)isLeaf {
@@ -76,48 +326,181 @@
 
 - (NSString*)value {
   if (!self.isLeaf) {
-    if (self.childCount != self.children.count) {
+    if (!self.childrenLoaded) {
       return @"…";
     }
     // For non-leaf nodes, display the object structure by recursively printing
     // the base64-decoded values.
-    NSMutableString* mutableString = [[NSMutableString alloc] initWithString:@"(\n"];
-    for (VariableNode* child in self.children) {
-      [self recusivelyFormatNode:child appendTo:mutableString depth:1];
-    }
-    [mutableString appendString:@")"];
-
-    return mutableString;
+    if (!_formattedValue)
+      _formattedValue = [self formattedValue];
+    return _formattedValue;
   }
 
-  return _nodeValue;
+  return [self nodeValue];
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 #pragma mark Private
 
+/**
+ * Returns the value of this node itself, decoding it if needed.
+ */
+- (NSString*)nodeValue {
+  if (_encodedValue)
+    return _encodedValue.value;
+  return _nodeValue;
+}
+
+/**
+ * Returns the key by which a node is matched to its previous version.
+ */
+- (NSString*)mergeKey {
+  if (!_address)
+    return self.fullName;
+  return [NSString stringWithFormat:@"%@@%@", self.fullName, _address];
+}
+
+/**
+ * Returns whether this node has the same type and value as |other|, ignoring
+ * any children.
+ */
+- (BOOL)hasSameValueAs:(VariableNode*)other {
+  if (!StringsEqual(_type, other->_type) || !StringsEqual(_className, other->_className) ||
+      _childCount != other->_childCount) {
+    return NO;
+  }
+  if (_encodedValue && other->_encodedValue)
+    return [_encodedValue isEqualToEncodedValue:other->_encodedValue];
+  return StringsEqual([self nodeValue], [other nodeValue]);
+}
+
+/**
+ * Builds the print_r()-style value of this node, up to
+ * kMaxFormattedValueLength characters.
+ */
+- (NSString*)formattedValue {
+  NSMutableString* string = [[NSMutableString alloc] initWithString:@"(\n"];
+  for (VariableNode* child in self.children) {
+    if (![self recusivelyFormatNode:child appendTo:string depth:1]) {
+      NSRange last = [string rangeOfComposedCharacterSequenceAtIndex:kMaxFormattedValueLength];
+      [string deleteCharactersInRange:NSMakeRange(last.location, string.length - last.location)];
+      [string appendString:kTruncationMarker];
+      return string;
+    }
+  }
+  [string appendString:@")"];
+  return string;
+}
+
+/**
+ * Clears the formatted value of this node and of its ancestors, which include
+ * it, and notifies observers of |value|.
+ */
+- (void)invalidateFormattedValue {
+  for (VariableNode* node = self; node; node = node.parent) {
+    [node willChangeValueForKey:@"value"];
+    node->_formattedValue = nil;
+    [node didChangeValueForKey:@"value"];
+  }
+}
+
+/**
+ * If this node's full name starts with |prefix|, which is its parent's full
+ * name, stores only the rest of it and shares the parent's string.
+ */
+- (void)shareFullNamePrefix:(NSString*)prefix {
+  if (_fullNamePrefix || prefix.length == 0 || ![_fullNameSuffix hasPrefix:prefix])
+    return;
+  _fullNameSuffix = [_fullNameSuffix substringFromIndex:prefix.length];
+  _fullNamePrefix = prefix;
+}
+
+/**
+ * Builds the children array, with a placeholder for every child, and then
+ * fills in the pages that have been received. Each child is placed once, so
+ * this is linear in the number of children.
+ */
+- (void)buildChildren {
+  _children = [[NSMutableArray alloc] initWithCapacity:_childCount];
+  for (NSUInteger i = 0; i < _childCount; ++i)
+    [_children addObject:[[VariableNode alloc] initPlaceholderForParent:self index:i]];
+
+  [_pendingPages enumerateKeysAndObjectsUsingBlock:^(NSNumber* page, NSArray<VariableNode*>* nodes, BOOL* stop) {
+    NSRange range = [self rangeOfPage:[page unsignedIntegerValue] count:nodes.count];
+    [self->_children replaceObjectsInRange:range
+                      withObjectsFromArray:nodes
+                                     range:NSMakeRange(0, range.length)];
+  }];
+  _pendingPages = nil;
+}
+
+/**
+ * Returns the range of children that up to |count| nodes of |page| occupy. The
+ * hidden children take up the start of the first page, so every page boundary
+ * is shifted back by their number.
+ */
+- (NSRange)rangeOfPage:(NSUInteger)page count:(NSUInteger)count {
+  NSUInteger start = page * _pageSize;
+  NSUInteger end = start + _pageSize;
+  start = MIN(start - MIN(start, _hiddenChildCount), _childCount);
+  end = MIN(end - MIN(end, _hiddenChildCount), _childCount);
+  return NSMakeRange(start, MIN(count, end - start));
+}
+
+/**
+ * Removes |count| children that will not be shown from the child count, along
+ * with their placeholders. The hidden children are in the first page, so the
+ * placeholders are removed from the end of its range, which shifts any later
+ * page that has already been placed back into position.
+ */
+- (void)hideChildren:(NSUInteger)count {
+  [self willChangeValueForKey:@"childCount"];
+  _childCount -= count;
+  _hiddenChildCount += count;
+  [self didChangeValueForKey:@"childCount"];
+
+  if (!_children || _children.count <= _childCount)
+    return;
+  NSUInteger start = MIN(_pageSize - MIN(_pageSize, _hiddenChildCount), _childCount);
+  NSIndexSet* indexes =
+      [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(start, _children.count - _childCount)];
+  [self willChange:NSKeyValueChangeRemoval valuesAtIndexes:indexes forKey:@"children"];
+  [_children removeObjectsAtIndexes:indexes];
+  [self didChange:NSKeyValueChangeRemoval valuesAtIndexes:indexes forKey:@"children"];
+}
+
 /**
  * Recursively builds a print_r()-style output by attaching the data to
- * |stringBuilder| with indent level specified by |depth|.
+ * |stringBuilder| with indent level specified by |depth|. Returns NO once the
+ * output is longer than kMaxFormattedValueLength.
  */
-- (void)recusivelyFormatNode:(VariableNode*)node
+- (BOOL)recusivelyFormatNode:(VariableNode*)node
                     appendTo:(NSMutableString*)stringBuilder
                        depth:(NSUInteger)depth
 {
-  // Create the indention string for this level.
-  NSString* indent = [@"" stringByPaddingToLength:depth withString:@"\t" startingAtIndex:0];
+  NSString* indent = IndentString(depth);
+  [stringBuilder appendString:indent];
+  [stringBuilder appendString:node.name];
+  [stringBuilder appendString:@"\t=>\t"];
 
   if (node.isLeaf) {
     // If this is a leaf node, simply append the key=>value pair.
-    [stringBuilder appendFormat:@"%@%@\t=>\t%@\n", indent, node.name, node->_nodeValue];
+    [stringBuilder appendString:[node nodeValue] ?: @"(null)"];
+    [stringBuilder appendString:@"\n"];
+  } else if (!node.childrenLoaded) {
+    // Only show that there are children that have not been fetched.
+    [stringBuilder appendString:@"…\n"];
   } else {
     // If this node has children, increase the depth and recurse.
-    [stringBuilder appendFormat:@"%@%@\t=>\t(\n", indent, node.name];
+    [stringBuilder appendString:@"(\n"];
     for (VariableNode* child in node.children) {
-      [self recusivelyFormatNode:child appendTo:stringBuilder depth:depth + 1];
+      if (![self recusivelyFormatNode:child appendTo:stringBuilder depth:depth + 1])
+        return NO;
     }
-    [stringBuilder appendFormat:@"%@)\n", indent];
+    [stringBuilder appendString:indent];
+    [stringBuilder appendString:@")\n"];
   }
+  return stringBuilder.length <= kMaxFormattedValueLength;
 }
 
 @end